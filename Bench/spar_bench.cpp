@@ -0,0 +1,492 @@
+/// @file spar_bench.cpp
+/// @brief Benchmark of the S-parameter engine on synthetic circuits
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "../SPAR/SParameterCalculator.h"
+#include "../SPAR/SweepWriter.h"
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+using Clock = chrono::steady_clock;
+
+static const char *USAGE =
+    "Usage: spar_bench [options]\n"
+    "Times the stages of the S-parameter engine on synthetic circuits and\n"
+    "prints the results as JSON.\n"
+    "\n"
+    "  --workloads W1,W2  ladder, tlin, mlin, clin, wilkinson, spar\n"
+    "                     (default: all)\n"
+    "  --sizes N1,N2      Circuit sizes (default 8,32,128,512). For wilkinson,\n"
+    "                     the number of outputs (rounded to a power of two)\n"
+    "  --points P1,P2     Sweep lengths (default 101,1001)\n"
+    "  --repeat N         Repetitions. The fastest is reported (default 3)\n"
+    "  --threads N        Threads of the full sweep (default: one per core)\n"
+    "  -o FILE            Writes the JSON to FILE instead of stdout\n"
+    "  --check            Compares the dense and batched solvers with the\n"
+    "                     sparse solver on circuits with 0 Ohm elements and\n"
+    "                     exits with status 1 if they disagree\n"
+    "  -h, --help         Shows this help\n";
+
+static const char *WORKLOADS[] = {"ladder", "tlin",      "mlin",
+                                  "clin",   "wilkinson", "spar"};
+
+// Substrate of the microstrip workloads: er h sigma t tand
+static const char *SUBSTRATE = "3.55 0.508mm 5.8e7 35um 0.0027";
+
+// Largest difference between the S-parameters of the solvers in --check
+static const double CHECK_TOLERANCE = 1e-9;
+
+/// @struct BenchTimes
+/// @brief Time of each stage of a workload (ms)
+struct BenchTimes {
+  double parse = 0;   ///< Netlist parsing
+  double compile = 0; ///< Circuit plan
+  double prepare = 0; ///< Models tabulated over the sweep
+  double stamp = 0;   ///< Nodal matrix at every frequency
+  double solve = 0;   ///< LU factorization and port excitations
+  double extract = 0; ///< S-matrices from the port voltages
+  double format = 0;  ///< Touchstone output
+  double sweep = 0;   ///< calculateSParameterSweep(), all the fast paths on
+
+  void keepFastest(const BenchTimes &t) {
+    parse = min(parse, t.parse);
+    compile = min(compile, t.compile);
+    prepare = min(prepare, t.prepare);
+    stamp = min(stamp, t.stamp);
+    solve = min(solve, t.solve);
+    extract = min(extract, t.extract);
+    format = min(format, t.format);
+    sweep = min(sweep, t.sweep);
+  }
+};
+
+/// @struct BenchResult
+/// @brief Measurement of a workload
+struct BenchResult {
+  string workload;
+  int size = 0;
+  int points = 0;
+  int nodes = 0;
+  int ports = 0;
+  string path; ///< Solver used by the full sweep
+  BenchTimes times;
+};
+
+static double elapsed(Clock::time_point start) {
+  return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+/// @brief Times a workload
+/// @details The stages are measured by the engine (see
+///          SParameterCalculator::setStageTiming()) on a sweep solved one
+///          frequency at a time, in a single thread and with the batched and
+///          pole-residue paths off. The full sweep is timed separately with
+///          all the fast paths on.
+static BenchResult runWorkload(const string &workload, int size,
+                               const string &netlist,
+                               const vector<double> &freqs, int threads) {
+  BenchResult result;
+  result.workload = workload;
+  result.size = size;
+  result.points = freqs.size();
+  BenchTimes &t = result.times;
+
+  SParameterCalculator engine;
+  engine.setNumThreads(1);
+  engine.setBatchedSweep(false);
+  engine.setPoleResidueSweep(false);
+  engine.setIncrementalSweep(false);
+  engine.setStageTiming(true);
+  engine.setNetlist(QString::fromStdString(netlist));
+  engine.setFrequencyList(freqs);
+  engine.calculateSParameterSweep();
+  const StageTimes &stages = engine.getStageTimes();
+  t.parse = stages.parse;
+  t.compile = stages.compile;
+  t.prepare = stages.prepare;
+  t.stamp = stages.stamp;
+  t.solve = stages.solve;
+  t.extract = stages.extract;
+
+  const SweepResult &results = engine.getSweepResult();
+  Clock::time_point start = Clock::now();
+  FILE *out = tmpfile();
+  if (out) {
+    SweepWriter writer(out, SweepWriter::FileType::TOUCHSTONE);
+    writer.beginSweep(results.getNumPorts(), results.getZ0(), results.size());
+    for (size_t i = 0; i < results.size(); i++) {
+      writer.addPoint(freqs[i], results.matrix(i));
+    }
+    writer.flush();
+    fclose(out);
+  }
+  t.format = elapsed(start);
+
+  // Full sweep on a new engine, so no model is cached
+  SParameterCalculator sweepEngine;
+  sweepEngine.setNumThreads(threads);
+  sweepEngine.setIncrementalSweep(false);
+  sweepEngine.setNetlist(QString::fromStdString(netlist));
+  sweepEngine.setFrequencyList(freqs);
+  start = Clock::now();
+  sweepEngine.calculateSParameterSweep();
+  t.sweep = elapsed(start);
+
+  result.path = sweepEngine.getSweepSolver();
+  result.nodes = engine.getNumNodes();
+  result.ports = engine.getNumPorts();
+  return result;
+}
+
+/// @brief Compares the dense and batched solvers with the sparse solver
+/// @details The circuits carry the 1e12 S stamp of a 0 Ω element, whose large
+///          entries must cancel exactly in the elimination. At some other
+///          frequencies the stamp limits the accuracy of every solver to about
+///          1e-3, so they are not compared over a full sweep.
+/// @returns False if any S-parameter differs by more than CHECK_TOLERANCE
+static bool runSolverCheck() {
+  struct CheckCircuit {
+    const char *name;
+    string netlist;
+    vector<double> freqs;
+  };
+  const CheckCircuit circuits[] = {
+      // 0 Ω resistor inside a bridged T network
+      {"zero-ohm",
+       "P1 1 50\nL1 1 2 10nH\nR1 2 3 0\nC1 3 0 3pF\nL2 3 4 10nH\n"
+       "R2 1 4 300\nP2 4 50\n",
+       {10e6, 200e6, 1e9}},
+      // Microstrip step between two lines
+      {"mstep",
+       string("P1 1 50\n") + "MLIN1 1 2 1.1mm 10mm " + SUBSTRATE +
+           "\nMSTEP1 2 3 1.1mm 2.5mm " + SUBSTRATE +
+           "\nMLIN2 3 4 2.5mm 8mm " + SUBSTRATE + "\nP2 4 50\n",
+       {100e6, 200e6, 500e6, 1e9, 2e9}}};
+
+  bool ok = true;
+  for (const CheckCircuit &circuit : circuits) {
+    SweepResult reference;
+    for (int config = 0; config < 3; config++) {
+      SParameterCalculator engine;
+      engine.setSparseSolverThreshold(config == 0 ? 0 : INT_MAX);
+      engine.setBatchedSweep(config == 2);
+      engine.setPoleResidueSweep(false);
+      engine.setIncrementalSweep(false);
+      engine.setNetlist(QString::fromStdString(circuit.netlist));
+      engine.setFrequencyList(circuit.freqs);
+      engine.calculateSParameterSweep();
+      const SweepResult &results = engine.getSweepResult();
+      if (config == 0) {
+        reference = results;
+        continue;
+      }
+
+      double worst = 0;
+      for (size_t k = 0; k < results.size(); k++) {
+        for (int i = 0; i < results.getNumPorts(); i++) {
+          for (int j = 0; j < results.getNumPorts(); j++) {
+            Complex diff = results.at(k, i, j) - reference.at(k, i, j);
+            worst = max(worst, abs(diff));
+          }
+        }
+      }
+      bool pass =
+          results.size() == circuit.freqs.size() && worst <= CHECK_TOLERANCE;
+      ok = ok && pass;
+      cerr << circuit.name << " " << engine.getSweepSolver()
+           << " vs sparse: " << worst << (pass ? " OK" : " FAILED") << endl;
+    }
+  }
+  return ok;
+}
+
+// Lumped LC low-pass ladder with n sections
+static string ladderNetlist(int n) {
+  ostringstream net;
+  net << "P1 1 50\n";
+  for (int i = 1; i <= n; i++) {
+    net << "L" << i << " " << i << " " << i + 1 << " 8nH\n";
+    net << "C" << i << " " << i + 1 << " 0 3.2pF\n";
+  }
+  net << "P2 " << n + 1 << " 50\n";
+  return net.str();
+}
+
+// Stepped-impedance chain of n ideal lines with open stubs
+static string tlinNetlist(int n) {
+  ostringstream net;
+  net << "P1 1 50\n";
+  for (int i = 1; i <= n; i++) {
+    net << "TLIN" << i << " " << i << " " << i + 1 << " "
+        << (i % 2 ? 90 : 30) << " 6mm\n";
+    net << "OSTUB" << i << " " << i + 1 << " 0 60 3mm\n";
+  }
+  net << "P2 " << n + 1 << " 50\n";
+  return net.str();
+}
+
+// Stepped-impedance chain of n microstrip lines
+static string mlinNetlist(int n) {
+  ostringstream net;
+  net << "P1 1 50\n";
+  for (int i = 1; i <= n; i++) {
+    net << "MLIN" << i << " " << i << " " << i + 1 << " "
+        << (i % 2 ? "2.5mm" : "0.4mm") << " 5mm " << SUBSTRATE << "\n";
+  }
+  net << "P2 " << n + 1 << " 50\n";
+  return net.str();
+}
+
+// Parallel-coupled line filter with n sections and open ends
+static string clinNetlist(int n) {
+  ostringstream net;
+  int open = n + 2; // Nodes of the open ends
+  net << "P1 1 50\n";
+  for (int i = 1; i <= n; i++) {
+    net << "CLIN" << i << " " << i << " " << open << " " << open + 1 << " "
+        << i + 1 << " " << (i % 2 ? 70 : 60) << " 38 18.75mm\n";
+    open += 2;
+  }
+  net << "P2 " << n + 1 << " 50\n";
+  return net.str();
+}
+
+// Binary tree of Wilkinson dividers with n outputs (a power of two)
+static string wilkinsonNetlist(int n) {
+  ostringstream net;
+  vector<int> level = {1};
+  int nextNode = 2, lines = 0, resistors = 0;
+  while ((int)level.size() < n) {
+    vector<int> outputs;
+    for (int node : level) {
+      int a = nextNode++, b = nextNode++;
+      net << "TLIN" << ++lines << " " << node << " " << a << " 70.7 37.5mm\n";
+      net << "TLIN" << ++lines << " " << node << " " << b << " 70.7 37.5mm\n";
+      net << "R" << ++resistors << " " << a << " " << b << " 100\n";
+      outputs.push_back(a);
+      outputs.push_back(b);
+    }
+    level.swap(outputs);
+  }
+  net << "P1 1 50\n";
+  for (int node : level) {
+    net << "P" << node << " " << node << " 50\n";
+  }
+  return net.str();
+}
+
+// Chain of n frequency-dependent S-parameter blocks with shunt capacitors.
+// The blocks read the Touchstone file of a lossy line
+static string sparNetlist(int n, const string &touchstone) {
+  ostringstream net;
+  net << "P1 1 50\n";
+  for (int i = 1; i <= n; i++) {
+    net << "SPAR" << i << " " << i << " " << i + 1 << " " << touchstone
+        << "\n";
+    net << "C" << i << " " << i + 1 << " 0 0.1pF\n";
+  }
+  net << "P2 " << n + 1 << " 50\n";
+  return net.str();
+}
+
+// Writes the 2-port Touchstone file used by the spar workload
+static bool writeLineTouchstone(const string &path) {
+  FILE *out = fopen(path.c_str(), "wb");
+  if (!out) {
+    return false;
+  }
+  {
+    SweepWriter writer(out, SweepWriter::FileType::TOUCHSTONE);
+    writer.beginSweep(2, 50, 401);
+    for (int k = 0; k <= 400; k++) {
+      double freq = 1e6 + k * 25e6;
+      double loss = exp(-0.02 * sqrt(freq / 1e9));
+      Complex s21 = polar(loss, -2 * M_PI * freq * 50e-12);
+      Complex s11 = polar(0.01 * sqrt(freq / 1e9), M_PI / 4);
+      const Complex S[] = {s11, s21, s21, s11};
+      writer.addPoint(freq, S);
+    }
+  }
+  return fclose(out) == 0;
+}
+
+static bool parseIntList(const string &text, vector<int> &list) {
+  list.clear();
+  stringstream in(text);
+  string item;
+  while (getline(in, item, ',')) {
+    int value = atoi(item.c_str());
+    if (value <= 0) {
+      return false;
+    }
+    list.push_back(value);
+  }
+  return !list.empty();
+}
+
+static void writeJson(ostream &out, const vector<BenchResult> &results,
+                      int threads, int repeat) {
+  out << "{\n";
+  out << "  \"threads\": " << threads << ",\n";
+  out << "  \"repeat\": " << repeat << ",\n";
+  out << "  \"unit\": \"ms\",\n";
+  out << "  \"results\": [";
+  out << fixed << setprecision(4);
+  for (size_t r = 0; r < results.size(); r++) {
+    const BenchResult &res = results[r];
+    const BenchTimes &t = res.times;
+    out << (r ? ",\n" : "\n");
+    out << "    {\"workload\": \"" << res.workload << "\", \"size\": "
+        << res.size << ", \"points\": " << res.points
+        << ", \"nodes\": " << res.nodes << ", \"ports\": " << res.ports
+        << ", \"path\": \"" << res.path << "\",\n";
+    out << "     \"parse\": " << t.parse << ", \"compile\": " << t.compile
+        << ", \"prepare\": " << t.prepare << ", \"stamp\": " << t.stamp
+        << ", \"solve\": " << t.solve << ", \"extract\": " << t.extract
+        << ", \"format\": " << t.format << ", \"sweep\": " << t.sweep
+        << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+int main(int argc, char **argv) {
+  vector<string> workloads(begin(WORKLOADS), end(WORKLOADS));
+  vector<int> sizes = {8, 32, 128, 512};
+  vector<int> points = {101, 1001};
+  int repeat = 3;
+  int threads = 0;
+  string outputFile;
+
+  for (int a = 1; a < argc; a++) {
+    string arg = argv[a];
+    if (arg == "-h" || arg == "--help") {
+      cout << USAGE;
+      return 0;
+    }
+    if (arg == "--check") {
+      ostringstream engineLog;
+      streambuf *coutBuffer = cout.rdbuf(engineLog.rdbuf());
+      bool ok = runSolverCheck();
+      cout.rdbuf(coutBuffer);
+      return ok ? 0 : 1;
+    }
+    if (a + 1 >= argc) {
+      cerr << "Error: Unknown option or missing value: " << arg << endl
+           << USAGE;
+      return 2;
+    }
+    string value = argv[++a];
+    bool ok = true;
+    if (arg == "--workloads") {
+      workloads.clear();
+      stringstream in(value);
+      string item;
+      while (getline(in, item, ',')) {
+        ok = ok && find(begin(WORKLOADS), end(WORKLOADS), item) !=
+                       end(WORKLOADS);
+        workloads.push_back(item);
+      }
+    } else if (arg == "--sizes") {
+      ok = parseIntList(value, sizes);
+    } else if (arg == "--points") {
+      ok = parseIntList(value, points);
+    } else if (arg == "--repeat") {
+      repeat = atoi(value.c_str());
+      ok = repeat > 0;
+    } else if (arg == "--threads") {
+      threads = max(atoi(value.c_str()), 0);
+    } else if (arg == "-o") {
+      outputFile = value;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      cerr << "Error: Invalid option " << arg << " " << value << endl
+           << USAGE;
+      return 2;
+    }
+  }
+
+  // Data of the spar workload
+  fs::path touchstone = fs::temp_directory_path() / "spar_bench_line.s2p";
+  if (find(workloads.begin(), workloads.end(), "spar") != workloads.end() &&
+      !writeLineTouchstone(touchstone.string())) {
+    cerr << "Error: Cannot create " << touchstone.string() << endl;
+    return 1;
+  }
+
+  // The engine progress messages would dominate the parse time
+  ostringstream engineLog;
+  streambuf *coutBuffer = cout.rdbuf(engineLog.rdbuf());
+
+  vector<BenchResult> results;
+  for (const string &workload : workloads) {
+    for (int size : sizes) {
+      string netlist;
+      if (workload == "ladder") {
+        netlist = ladderNetlist(size);
+      } else if (workload == "tlin") {
+        netlist = tlinNetlist(size);
+      } else if (workload == "mlin") {
+        netlist = mlinNetlist(size);
+      } else if (workload == "clin") {
+        netlist = clinNetlist(size);
+      } else if (workload == "wilkinson") {
+        int outputs = 2;
+        while (outputs < size) {
+          outputs *= 2;
+        }
+        netlist = wilkinsonNetlist(outputs);
+      } else {
+        netlist = sparNetlist(size, touchstone.string());
+      }
+
+      for (int n : points) {
+        vector<double> freqs(n);
+        for (int k = 0; k < n; k++) {
+          freqs[k] = 10e6 + k * (n == 1 ? 0 : (10e9 - 10e6) / (n - 1));
+        }
+        BenchResult best;
+        for (int r = 0; r < repeat; r++) {
+          BenchResult result =
+              runWorkload(workload, size, netlist, freqs, threads);
+          if (r == 0) {
+            best = result;
+          } else {
+            best.times.keepFastest(result.times);
+          }
+          engineLog.str("");
+        }
+        results.push_back(best);
+        cerr << workload << " size " << size << " points " << n << ": "
+             << best.times.sweep << " ms" << endl;
+      }
+    }
+  }
+
+  cout.rdbuf(coutBuffer);
+  fs::remove(touchstone);
+
+  SParameterCalculator engine;
+  int numThreads = threads > 0 ? threads : engine.getNumThreads();
+  if (outputFile.empty()) {
+    writeJson(cout, results, numThreads, repeat);
+  } else {
+    ofstream out(outputFile);
+    writeJson(out, results, numThreads, repeat);
+    if (!out) {
+      cerr << "Error: Cannot write " << outputFile << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
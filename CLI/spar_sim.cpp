@@ -0,0 +1,600 @@
+/// @file spar_sim.cpp
+/// @brief Command-line batch simulator built on SParameterCalculator
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "../SPAR/SParameterCalculator.h"
+#include "../SPAR/SweepWriter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace fs = std::filesystem;
+
+static const char *USAGE =
+    "Usage: rfd-spar-sim [options] netlist...\n"
+    "Simulates the S-parameters of the netlists. '-' reads a netlist from "
+    "stdin.\n"
+    "\n"
+    "Sweep (frequencies accept the k, M, G and T prefixes, e.g. 2.4G):\n"
+    "  --start F          Start frequency (default 1M)\n"
+    "  --stop F           Stop frequency (default 1G)\n"
+    "  --points N         Number of points (default 201)\n"
+    "  --log              Logarithmic spacing\n"
+    "  --list F1,F2,...   Frequency list\n"
+    "  --list-file FILE   Frequency list, one or more values per line\n"
+    "  --adaptive TOL     Solves only the frequencies needed to interpolate\n"
+    "                     the S-parameters within TOL (e.g. 1e-4)\n"
+    "\n"
+    "Monte Carlo (writes the envelopes as CSV and the yield on stderr):\n"
+    "  --monte-carlo N    Number of trials\n"
+    "  --tol KEY=T        Tolerance of a component (by name) or of all the\n"
+    "                     R, L, C, W, S, er or h, e.g. C=5%, L1=2%:gauss,\n"
+    "                     R=1%:e96. Uniform by default. :eN snaps the\n"
+    "                     nominal value to the E-series first\n"
+    "  --limit SPEC       Sij,F1,F2,V1,V2,max|min: |Sij| in dB must stay\n"
+    "                     below (max) or above (min) the line from (F1, V1)\n"
+    "                     to (F2, V2), e.g. S21,1G,2G,-1,-1,min\n"
+    "  --percentiles P,.. Percentiles of the envelopes (default 5,50,95)\n"
+    "  --seed N           Seed of the trials (default 1)\n"
+    "\n"
+    "Output:\n"
+    "  --format FMT       touchstone (default), csv or binary\n"
+    "  --data FMT         ri (default), ma or db\n"
+    "  -o FILE            Output file of a single netlist ('-' for stdout)\n"
+    "  -d DIR             Output directory. By default, the results are\n"
+    "                     written next to each netlist (stdin goes to stdout)\n"
+    "\n"
+    "Batch:\n"
+    "  --netlists FILE    Reads the netlist paths from FILE, one per line\n"
+    "                     ('-' for stdin)\n"
+    "  --jobs N           Netlists simulated at once (default: one per core)\n"
+    "  --threads N        Sweep threads per netlist (default: 1 if several\n"
+    "                     netlists run at once, otherwise one per core)\n"
+    "  -v, --verbose      Prints the engine messages on stderr\n"
+    "  -h, --help         Shows this help\n";
+
+/// @struct SimOptions
+/// @brief Command line settings shared by all the netlists
+struct SimOptions {
+  double start = 1e6;
+  double stop = 1e9;
+  int points = 201;
+  bool logarithmic = false;
+  vector<double> list; ///< Frequency list. Overrides start/stop/points
+  double adaptive = 0; ///< Tolerance of the adaptive sampling (0: disabled)
+  bool monteCarloRun = false;    ///< Runs the Monte Carlo analysis
+  MonteCarloSettings monteCarlo; ///< Trials, tolerances and limits
+  SweepWriter::FileType type = SweepWriter::FileType::TOUCHSTONE;
+  SweepWriter::DataFormat format = SweepWriter::DataFormat::RI;
+  string outputFile;
+  string outputDir;
+  int jobs = 0;
+  int threads = -1;
+  bool verbose = false;
+};
+
+// Parses a frequency such as 1e9, 2.4G, 100MHz. Returns false on error
+static bool parseFrequency(const string &text, double &freq) {
+  const char *begin = text.c_str();
+  char *end = nullptr;
+  freq = strtod(begin, &end);
+  if (end == begin) {
+    return false;
+  }
+  string unit(end);
+  if (unit.size() >= 2 && (unit.compare(unit.size() - 2, 2, "Hz") == 0 ||
+                           unit.compare(unit.size() - 2, 2, "hz") == 0)) {
+    unit.resize(unit.size() - 2);
+  }
+  if (unit.empty()) {
+    return true;
+  }
+  if (unit.size() > 1) {
+    return false;
+  }
+  switch (unit[0]) {
+  case 'k':
+  case 'K':
+    freq *= 1e3;
+    return true;
+  case 'M':
+    freq *= 1e6;
+    return true;
+  case 'G':
+  case 'g':
+    freq *= 1e9;
+    return true;
+  case 'T':
+  case 't':
+    freq *= 1e12;
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Appends the frequencies of a comma, space or newline separated list
+static bool parseFrequencyList(const string &text, vector<double> &list) {
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t end = text.find_first_of(", \t\r\n", pos);
+    if (end == string::npos) {
+      end = text.size();
+    }
+    if (end > pos) {
+      double freq;
+      if (!parseFrequency(text.substr(pos, end - pos), freq)) {
+        cerr << "Error: Invalid frequency '" << text.substr(pos, end - pos)
+             << "'" << endl;
+        return false;
+      }
+      list.push_back(freq);
+    }
+    pos = end + 1;
+  }
+  return true;
+}
+
+// Parses a tolerance such as C=5%, L1=0.02:gauss or R=1%:e96
+static bool parseTolerance(const string &text, MonteCarloSettings &settings) {
+  size_t equal = text.find('=');
+  if (equal == string::npos || equal == 0) {
+    return false;
+  }
+  ComponentTolerance tolerance;
+  stringstream fields(text.substr(equal + 1));
+  string field;
+  for (int n = 0; getline(fields, field, ':'); n++) {
+    const char *begin = field.c_str();
+    char *end = nullptr;
+    if (n == 0) {
+      tolerance.tolerance = strtod(begin, &end);
+      if (end == begin || (*end && strcmp(end, "%") != 0)) {
+        return false;
+      }
+      if (*end) {
+        tolerance.tolerance /= 100;
+      }
+    } else if (field == "gauss") {
+      tolerance.distribution = ComponentTolerance::Distribution::GAUSSIAN;
+    } else if (field == "uniform") {
+      tolerance.distribution = ComponentTolerance::Distribution::UNIFORM;
+    } else if ((field[0] == 'e' || field[0] == 'E') && field.size() > 1) {
+      tolerance.series = strtol(begin + 1, &end, 10);
+      if (*end) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+  settings.tolerances[text.substr(0, equal)] = tolerance;
+  return true;
+}
+
+// Parses a limit such as S21,1G,2G,-1,-1,min
+static bool parseLimit(const string &text, MonteCarloSettings &settings) {
+  vector<string> fields;
+  stringstream stream(text);
+  string field;
+  while (getline(stream, field, ',')) {
+    fields.push_back(field);
+  }
+  if (fields.size() != 6 || fields[0].size() != 3 ||
+      (fields[0][0] != 'S' && fields[0][0] != 's') ||
+      !isdigit((unsigned char)fields[0][1]) ||
+      !isdigit((unsigned char)fields[0][2])) {
+    return false;
+  }
+  MonteCarloLimit limit;
+  limit.row = fields[0][1] - '0';
+  limit.col = fields[0][2] - '0';
+  if (!parseFrequency(fields[1], limit.fstart) ||
+      !parseFrequency(fields[2], limit.fstop)) {
+    return false;
+  }
+  char *end = nullptr;
+  limit.start = strtod(fields[3].c_str(), &end);
+  if (end == fields[3].c_str() || *end) {
+    return false;
+  }
+  limit.stop = strtod(fields[4].c_str(), &end);
+  if (end == fields[4].c_str() || *end) {
+    return false;
+  }
+  if (fields[5] != "max" && fields[5] != "min") {
+    return false;
+  }
+  limit.upper = fields[5] == "max";
+  settings.limits.push_back(limit);
+  return true;
+}
+
+/// @class NullBuffer
+/// @brief Stream buffer that discards the text
+class NullBuffer : public streambuf {
+protected:
+  int overflow(int c) override { return c; }
+};
+
+static bool readText(istream &in, string &text) {
+  stringstream buffer;
+  buffer << in.rdbuf();
+  text = buffer.str();
+  return !in.bad();
+}
+
+// Returns the output path of a netlist ("-" is stdout)
+static string outputPath(const SimOptions &options, const string &netlist,
+                         int numPorts) {
+  if (!options.outputFile.empty()) {
+    return options.outputFile;
+  }
+  string extension = options.monteCarloRun
+                         ? ".mc.csv"
+                         : SweepWriter::extension(options.type, numPorts);
+  if (netlist == "-") {
+    return options.outputDir.empty()
+               ? "-"
+               : (fs::path(options.outputDir) / ("stdin" + extension))
+                     .string();
+  }
+  fs::path path(netlist);
+  path.replace_extension(extension);
+  if (!options.outputDir.empty()) {
+    path = fs::path(options.outputDir) / path.filename();
+  }
+  return path.string();
+}
+
+// Runs the Monte Carlo analysis of a netlist and prints the yield. Returns
+// false on error
+static bool monteCarlo(const SimOptions &options, const string &netlist,
+                       SParameterCalculator &engine, MonteCarloResult &result) {
+  if (!engine.runMonteCarlo(options.monteCarlo, result)) {
+    cerr << netlist << ": The Monte Carlo analysis failed" << endl;
+    return false;
+  }
+
+  cerr << netlist << ": Yield " << fixed << setprecision(1)
+       << 100 * result.yield() << "% (" << result.passed << " of "
+       << result.trials << " trials)" << defaultfloat << endl;
+  for (size_t l = 0; l < result.violations.size(); l++) {
+    const MonteCarloLimit &limit = options.monteCarlo.limits[l];
+    cerr << "  Limit " << l + 1 << " (S" << limit.row << limit.col
+         << "): " << result.violations[l] << " failures" << endl;
+  }
+  if (result.unsolved > 0) {
+    cerr << "  " << result.unsolved << " trials failed to solve" << endl;
+  }
+  return true;
+}
+
+// Writes the Monte Carlo envelopes as CSV. Returns false on error
+static bool writeEnvelopes(const MonteCarloResult &result, FILE *out) {
+
+  // Frequency, then each trace at each percentile
+  fprintf(out, "freq");
+  for (const auto &[row, col] : result.traces) {
+    for (double p : result.percentiles) {
+      fprintf(out, ",S%d%d_p%g", row, col, p);
+    }
+  }
+  fprintf(out, "\n");
+  int n_points = result.frequency.size();
+  for (int k = 0; k < n_points; k++) {
+    fprintf(out, "%.12g", result.frequency[k]);
+    for (const vector<double> &envelope : result.envelopes) {
+      for (size_t p = 0; p < result.percentiles.size(); p++) {
+        fprintf(out, ",%.6g", envelope[p * n_points + k]);
+      }
+    }
+    fprintf(out, "\n");
+  }
+  return !ferror(out);
+}
+
+// Simulates a netlist and writes the results. Returns false on error
+static bool simulate(const SimOptions &options, const string &netlist,
+                     const string &text, int threads) {
+  SParameterCalculator engine;
+  engine.setNumThreads(threads);
+  if (!engine.setNetlist(QString::fromStdString(text))) {
+    cerr << netlist << ": Error parsing the netlist" << endl;
+    return false;
+  }
+  if (engine.getNumPorts() == 0) {
+    cerr << netlist << ": The netlist has no ports" << endl;
+    return false;
+  }
+
+  if (options.list.empty()) {
+    engine.setFrequencySweep(options.start, options.stop, options.points,
+                             options.logarithmic);
+  } else {
+    engine.setFrequencyList(options.list);
+  }
+  if (options.adaptive > 0) {
+    engine.setAdaptiveSweep(true, options.adaptive);
+  }
+
+  MonteCarloResult result;
+  if (options.monteCarloRun &&
+      !monteCarlo(options, netlist, engine, result)) {
+    return false;
+  }
+
+  string path = outputPath(options, netlist, engine.getNumPorts());
+  FILE *out = (path == "-") ? stdout : fopen(path.c_str(), "wb");
+  if (!out) {
+    cerr << netlist << ": Cannot create output file " << path << endl;
+    return false;
+  }
+
+  bool ok;
+  if (options.monteCarloRun) {
+    ok = writeEnvelopes(result, out);
+  } else {
+    // The points are written as they are solved
+    SweepWriter writer(out, options.type, options.format);
+    engine.calculateSParameterSweep(writer);
+    ok = writer.flush();
+  }
+  ok = (out == stdout ? fflush(out) : fclose(out)) == 0 && ok;
+  if (!ok) {
+    cerr << netlist << ": Error writing " << path << endl;
+  }
+  return ok;
+}
+
+// Reads the value of an option, e.g. --points 101
+static bool optionValue(int argc, char **argv, int &a, string &value) {
+  if (a + 1 >= argc) {
+    cerr << "Error: Missing value of " << argv[a] << endl;
+    return false;
+  }
+  value = argv[++a];
+  return true;
+}
+
+// Parses the command line. Returns the exit code if the program must stop
+static int parseArguments(int argc, char **argv, SimOptions &options,
+                          vector<string> &netlists) {
+  for (int a = 1; a < argc; ++a) {
+    string arg = argv[a];
+    string value;
+    if (arg == "-h" || arg == "--help") {
+      cout << USAGE;
+      return 0;
+    } else if (arg == "-v" || arg == "--verbose") {
+      options.verbose = true;
+    } else if (arg == "--log") {
+      options.logarithmic = true;
+    } else if (arg == "-" || arg[0] != '-') {
+      netlists.push_back(arg);
+    } else if (!optionValue(argc, argv, a, value)) {
+      return 2;
+    } else if (arg == "--start" || arg == "--stop") {
+      double &freq = (arg == "--start") ? options.start : options.stop;
+      if (!parseFrequency(value, freq)) {
+        cerr << "Error: Invalid frequency '" << value << "'" << endl;
+        return 2;
+      }
+    } else if (arg == "--points") {
+      options.points = atoi(value.c_str());
+    } else if (arg == "--adaptive") {
+      options.adaptive = atof(value.c_str());
+      if (!(options.adaptive > 0)) {
+        cerr << "Error: The adaptive tolerance must be positive" << endl;
+        return 2;
+      }
+    } else if (arg == "--monte-carlo") {
+      options.monteCarloRun = true;
+      options.monteCarlo.trials = atoi(value.c_str());
+      if (options.monteCarlo.trials <= 0) {
+        cerr << "Error: The number of trials must be positive" << endl;
+        return 2;
+      }
+    } else if (arg == "--tol") {
+      if (!parseTolerance(value, options.monteCarlo)) {
+        cerr << "Error: Invalid tolerance '" << value << "'" << endl;
+        return 2;
+      }
+    } else if (arg == "--limit") {
+      if (!parseLimit(value, options.monteCarlo)) {
+        cerr << "Error: Invalid limit '" << value << "'" << endl;
+        return 2;
+      }
+    } else if (arg == "--percentiles") {
+      options.monteCarlo.percentiles.clear();
+      stringstream stream(value);
+      string field;
+      while (getline(stream, field, ',')) {
+        double p = atof(field.c_str());
+        if (p < 0 || p > 100) {
+          cerr << "Error: Invalid percentile '" << field << "'" << endl;
+          return 2;
+        }
+        options.monteCarlo.percentiles.push_back(p);
+      }
+    } else if (arg == "--seed") {
+      options.monteCarlo.seed = strtoul(value.c_str(), nullptr, 10);
+    } else if (arg == "--list") {
+      if (!parseFrequencyList(value, options.list)) {
+        return 2;
+      }
+    } else if (arg == "--list-file") {
+      ifstream file(value);
+      string text;
+      if (!file || !readText(file, text)) {
+        cerr << "Error: Cannot read " << value << endl;
+        return 2;
+      }
+      if (!parseFrequencyList(text, options.list)) {
+        return 2;
+      }
+    } else if (arg == "--format") {
+      if (value == "touchstone") {
+        options.type = SweepWriter::FileType::TOUCHSTONE;
+      } else if (value == "csv") {
+        options.type = SweepWriter::FileType::CSV;
+      } else if (value == "binary") {
+        options.type = SweepWriter::FileType::BINARY;
+      } else {
+        cerr << "Error: Unknown format '" << value << "'" << endl;
+        return 2;
+      }
+    } else if (arg == "--data") {
+      if (value == "ri") {
+        options.format = SweepWriter::DataFormat::RI;
+      } else if (value == "ma") {
+        options.format = SweepWriter::DataFormat::MA;
+      } else if (value == "db") {
+        options.format = SweepWriter::DataFormat::DB;
+      } else {
+        cerr << "Error: Unknown format '" << value << "'" << endl;
+        return 2;
+      }
+    } else if (arg == "-o") {
+      options.outputFile = value;
+    } else if (arg == "-d") {
+      options.outputDir = value;
+    } else if (arg == "--netlists") {
+      ifstream file;
+      if (value != "-") {
+        file.open(value);
+      }
+      istream &in = (value == "-") ? cin : file;
+      if (!in) {
+        cerr << "Error: Cannot read " << value << endl;
+        return 2;
+      }
+      string line;
+      while (getline(in, line)) {
+        while (!line.empty() && isspace((unsigned char)line.back())) {
+          line.pop_back();
+        }
+        if (!line.empty()) {
+          netlists.push_back(line);
+        }
+      }
+    } else if (arg == "--jobs") {
+      options.jobs = atoi(value.c_str());
+    } else if (arg == "--threads") {
+      options.threads = atoi(value.c_str());
+    } else {
+      cerr << "Error: Unknown option " << arg << endl << USAGE;
+      return 2;
+    }
+  }
+
+  if (netlists.empty()) {
+    cerr << USAGE;
+    return 2;
+  }
+  if (options.list.empty() && options.points <= 0) {
+    cerr << "Error: The number of points must be positive" << endl;
+    return 2;
+  }
+  if (options.list.empty() && options.logarithmic &&
+      (options.start <= 0 || options.stop <= 0)) {
+    cerr << "Error: A logarithmic sweep needs positive frequencies" << endl;
+    return 2;
+  }
+  if (!options.outputFile.empty() && netlists.size() > 1) {
+    cerr << "Error: -o takes a single netlist. Use -d with several" << endl;
+    return 2;
+  }
+  if (count(netlists.begin(), netlists.end(), "-") > 1) {
+    cerr << "Error: stdin can only be read once" << endl;
+    return 2;
+  }
+  return -1;
+}
+
+int main(int argc, char **argv) {
+  SimOptions options;
+  vector<string> netlists;
+  int code = parseArguments(argc, argv, options, netlists);
+  if (code >= 0) {
+    return code;
+  }
+
+  if (!options.outputDir.empty()) {
+    error_code error;
+    fs::create_directories(options.outputDir, error);
+    if (error) {
+      cerr << "Error: Cannot create " << options.outputDir << ": "
+           << error.message() << endl;
+      return 1;
+    }
+  }
+
+  // The engine reports its progress on cout. stdout is reserved for the
+  // results, so the messages go to stderr or nowhere
+  NullBuffer null;
+  streambuf *coutBuffer =
+      cout.rdbuf(options.verbose ? cerr.rdbuf() : &null);
+
+  // Netlists are simulated concurrently, each with its own engine. When
+  // several run at once, each sweep is single-threaded by default
+  int numNetlists = netlists.size();
+  int jobs = options.jobs > 0 ? options.jobs
+                              : (int)max(1u, thread::hardware_concurrency());
+  jobs = min(jobs, numNetlists);
+  int threads = options.threads >= 0 ? options.threads : (jobs > 1 ? 1 : 0);
+
+  atomic<int> next(0);
+  atomic<int> failures(0);
+  mutex stdinMutex;
+  auto worker = [&]() {
+    for (int k = next++; k < numNetlists; k = next++) {
+      const string &netlist = netlists[k];
+      string text;
+      bool read;
+      if (netlist == "-") {
+        lock_guard<mutex> lock(stdinMutex);
+        read = readText(cin, text);
+      } else {
+        ifstream file(netlist, ios::binary);
+        read = file && readText(file, text);
+      }
+      if (!read) {
+        cerr << "Error: Cannot read " << netlist << endl;
+        failures++;
+        continue;
+      }
+      try {
+        if (!simulate(options, netlist, text, threads)) {
+          failures++;
+        }
+      } catch (const std::exception &e) {
+        cerr << netlist << ": " << e.what() << endl;
+        failures++;
+      }
+    }
+  };
+
+  vector<thread> workers;
+  for (int t = 1; t < jobs; ++t) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &w : workers) {
+    w.join();
+  }
+
+  cout.rdbuf(coutBuffer);
+  if (failures > 0) {
+    cerr << failures << " of " << numNetlists << " netlists failed" << endl;
+    return 1;
+  }
+  return 0;
+}
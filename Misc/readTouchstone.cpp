@@ -99,7 +99,11 @@ QMap<QString, QList<double>> readTouchstoneFile(const QString &filePath) {
 
     for (int i = 1; i <= number_of_ports; i++) {
       for (int j = 1; j <= number_of_ports; j++) {
-        s1 = QStringLiteral("S") + QString::number(j) + QString::number(i) +
+        // 2-port files list the matrix by columns (S11 S21 S12 S22), the rest
+        // by rows
+        int row = (number_of_ports == 2) ? j : i;
+        int col = (number_of_ports == 2) ? i : j;
+        s1 = QStringLiteral("S") + QString::number(row) + QString::number(col) +
              QStringLiteral("_dB");
         s2 = s1.mid(0, s1.length() - 2).append("ang");
         s3 = s1.mid(0, s1.length() - 2).append("re");
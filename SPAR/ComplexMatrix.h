@@ -0,0 +1,79 @@
+/// @file ComplexMatrix.h
+/// @brief Dense complex matrix with contiguous row-major storage
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#ifndef COMPLEXMATRIX_H
+#define COMPLEXMATRIX_H
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+using namespace std;
+using Complex = complex<double>;
+
+/// @class ComplexMatrix
+/// @brief Dense complex matrix stored in a single row-major buffer
+/// @details The buffer keeps its capacity when the matrix is resized or
+///          assigned from a matrix of the same (or smaller) size, so a matrix
+///          that is reused across frequencies stops allocating after the first
+///          point.
+class ComplexMatrix {
+public:
+  ComplexMatrix() : nRows(0), nCols(0) {}
+
+  /// @brief Creates a zero matrix
+  ComplexMatrix(int rows, int cols)
+      : nRows(rows), nCols(cols), buffer(rows * cols, Complex(0, 0)) {}
+
+  /// @brief Creates a matrix from the nested representation
+  explicit ComplexMatrix(const vector<vector<Complex>> &m)
+      : nRows(m.size()), nCols(m.empty() ? 0 : m[0].size()) {
+    buffer.resize(nRows * nCols);
+    for (int i = 0; i < nRows; i++) {
+      copy(m[i].begin(), m[i].begin() + nCols, row(i));
+    }
+  }
+
+  int rows() const { return nRows; }
+  int cols() const { return nCols; }
+
+  /// @brief Changes the dimensions and sets all the entries to zero
+  void resize(int rows, int cols) {
+    nRows = rows;
+    nCols = cols;
+    buffer.assign(rows * cols, Complex(0, 0));
+  }
+
+  /// @brief Sets all the entries to zero
+  void setZero() { fill(buffer.begin(), buffer.end(), Complex(0, 0)); }
+
+  Complex &operator()(int r, int c) { return buffer[r * nCols + c]; }
+  const Complex &operator()(int r, int c) const { return buffer[r * nCols + c]; }
+
+  /// @brief Returns a pointer to the first entry of a row
+  Complex *row(int r) { return buffer.data() + r * nCols; }
+  const Complex *row(int r) const { return buffer.data() + r * nCols; }
+
+  /// @brief Swaps two rows
+  void swapRows(int a, int b) { swap_ranges(row(a), row(a) + nCols, row(b)); }
+
+  /// @brief Returns the matrix in the nested representation
+  vector<vector<Complex>> toNested() const {
+    vector<vector<Complex>> m(nRows);
+    for (int i = 0; i < nRows; i++) {
+      m[i].assign(row(i), row(i) + nCols);
+    }
+    return m;
+  }
+
+private:
+  int nRows;              ///< Number of rows
+  int nCols;              ///< Number of columns
+  vector<Complex> buffer; ///< Entries in row-major order
+};
+
+#endif // COMPLEXMATRIX_H
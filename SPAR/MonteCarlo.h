@@ -0,0 +1,90 @@
+/// @file MonteCarlo.h
+/// @brief Settings and results of the Monte Carlo tolerance analysis
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/// @struct ComponentTolerance
+/// @brief Spread of a component parameter between production units
+struct ComponentTolerance {
+  /// @enum Distribution
+  /// @brief Distribution of the deviation from the nominal value
+  enum class Distribution {
+    UNIFORM, ///< Uniform within ±tolerance
+    GAUSSIAN ///< Normal with ±tolerance at 3σ, truncated at ±tolerance
+  };
+
+  double tolerance = 0; ///< Largest relative deviation (0.05 for ±5%)
+  Distribution distribution = Distribution::UNIFORM;
+
+  /// @brief E-series of the parts (6, 12, 24, 48, 96 or 192). The nominal
+  /// value is first snapped to the nearest value of the series, as the part
+  /// fitted on the board. 0 keeps the nominal value
+  int series = 0;
+};
+
+/// @struct MonteCarloLimit
+/// @brief Specification line checked on every trial
+/// @details Same as a limit line of the viewer: a straight line in dB from
+///          (fstart, start) to (fstop, stop). The trace and the side of the
+///          line that passes are given explicitly.
+struct MonteCarloLimit {
+  int row = 1;        ///< S-parameter row (1-based)
+  int col = 1;        ///< S-parameter column (1-based)
+  double fstart = 0;  ///< Start frequency (Hz)
+  double fstop = 0;   ///< Stop frequency (Hz)
+  double start = 0;   ///< Limit at fstart (dB)
+  double stop = 0;    ///< Limit at fstop (dB)
+  bool upper = true;  ///< |S| must stay below the line (false: above)
+};
+
+/// @struct MonteCarloSettings
+/// @brief Tolerances, specification and statistics of a Monte Carlo run
+/// @details The tolerances are looked up by component name first (the main
+///          parameter of the component: R, L, C or the width of microstrip
+///          elements) and then by parameter: "R", "L", "C", "W" (microstrip
+///          widths), "S" (coupled line gaps), "er" and "h". The substrate
+///          parameters er and h take the same deviation in all the microstrip
+///          elements of a trial.
+struct MonteCarloSettings {
+  int trials = 1000;  ///< Number of trials
+  unsigned seed = 1;  ///< Seed. The trials do not depend on the threads
+  map<string, ComponentTolerance> tolerances; ///< By component or parameter
+  vector<MonteCarloLimit> limits;             ///< Specification
+  vector<double> percentiles = {5, 50, 95};   ///< Envelopes (%)
+
+  /// @brief S-parameters with envelopes, as (row, col), 1-based. Empty: all
+  vector<pair<int, int>> traces;
+};
+
+/// @struct MonteCarloResult
+/// @brief Yield and envelopes of a Monte Carlo run
+struct MonteCarloResult {
+  int trials = 0;          ///< Trials completed
+  int passed = 0;          ///< Trials that meet all the limits
+  int unsolved = 0;        ///< Trials with frequencies that failed to solve
+  vector<int> violations;  ///< Trials that fail each limit
+  vector<double> frequency; ///< Frequencies of the envelopes (Hz)
+  vector<double> percentiles; ///< Percentiles of the envelopes (%)
+  vector<pair<int, int>> traces; ///< S-parameters of the envelopes (1-based)
+
+  /// @brief |S| (dB) of trace t at percentile p and point k, at
+  /// envelopes[t][p * frequency.size() + k]
+  vector<vector<double>> envelopes;
+
+  /// @brief Fraction of the trials that meet all the limits
+  double yield() const { return trials > 0 ? (double)passed / trials : 0; }
+};
+
+#endif // MONTECARLO_H
@@ -0,0 +1,206 @@
+/// @file NodalMatrix.h
+/// @brief Dense and sparse storage of the nodal admittance matrix
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#ifndef NODALMATRIX_H
+#define NODALMATRIX_H
+
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ComplexMatrix.h"
+
+using namespace std;
+using Complex = complex<double>;
+
+/// @class NodalMatrix
+/// @brief Stamping interface of the nodal admittance matrix
+/// @details The component models write their contributions as Y[row][col],
+///          no matter whether the matrix is stored densely or in sparse form.
+class NodalMatrix {
+public:
+  /// @brief Row proxy, so that Y[row][col] can be used as in a dense matrix
+  class Row {
+  public:
+    Row(NodalMatrix &m, int r) : matrix(m), row(r) {}
+    Complex &operator[](int col) { return matrix.at(row, col); }
+
+  private:
+    NodalMatrix &matrix;
+    int row;
+  };
+
+  virtual ~NodalMatrix() = default;
+
+  /// @brief Returns the number of rows (and columns) of the matrix
+  virtual int size() const = 0;
+
+  /// @brief Returns a reference to the entry (row, col)
+  virtual Complex &at(int row, int col) = 0;
+
+  /// @brief Returns a proxy to access the entries of a row
+  Row operator[](int row) { return Row(*this, row); }
+};
+
+/// @class DenseNodalMatrix
+/// @brief NodalMatrix view of a dense matrix
+class DenseNodalMatrix : public NodalMatrix {
+public:
+  explicit DenseNodalMatrix(ComplexMatrix &m) : matrix(m) {}
+
+  int size() const override { return matrix.rows(); }
+  Complex &at(int row, int col) override { return matrix(row, col); }
+
+private:
+  ComplexMatrix &matrix;
+};
+
+/// @class LocalNodalMatrix
+/// @brief NodalMatrix view restricted to a subset of the nodes
+/// @details Used to evaluate the stamps of a few components into a small
+///          dense matrix. Row/column k of the matrix holds the node index
+///          indices[k]. Accessing a node outside the subset is an error.
+class LocalNodalMatrix : public NodalMatrix {
+public:
+  LocalNodalMatrix(const vector<int> &indices, ComplexMatrix &m)
+      : index(indices), matrix(m) {}
+
+  int size() const override { return index.size(); }
+
+  /// @throws logic_error if row or col is not in the subset
+  Complex &at(int row, int col) override {
+    return matrix(local(row), local(col));
+  }
+
+private:
+  const vector<int> &index;
+  ComplexMatrix &matrix;
+
+  int local(int i) const {
+    for (size_t k = 0; k < index.size(); k++) {
+      if (index[k] == i) {
+        return k;
+      }
+    }
+    throw logic_error("Node index " + to_string(i) +
+                      " is not in the local matrix");
+  }
+};
+
+/// @class SparseNodalMatrix
+/// @brief Nodal matrix stored in compressed sparse column (CSC) format
+/// @details The sparsity pattern is fixed by setPattern(). It only depends on
+///          the circuit topology, so it is the same at every frequency of a
+///          sweep and only the values need to be refilled.
+class SparseNodalMatrix : public NodalMatrix {
+public:
+  SparseNodalMatrix() : n(0) {}
+
+  /// @brief Sets the sparsity pattern
+  /// @param size Number of rows (and columns)
+  /// @param entries List of (row, col) positions. Duplicates are allowed
+  void setPattern(int size, vector<pair<int, int>> entries);
+
+  /// @brief Sets all the stored values to zero
+  void setZero();
+
+  /// @brief Overwrites the stored values (in CSC order)
+  void setValues(const vector<Complex> &values) {
+    copy(values.begin(), values.end(), val.begin());
+  }
+
+  int size() const override { return n; }
+
+  /// @throws logic_error if (row, col) is not part of the sparsity pattern
+  Complex &at(int row, int col) override;
+
+  /// @brief Returns the number of stored entries
+  int nonZeros() const { return rowIndex.size(); }
+
+  const vector<int> &columnPointers() const { return colPtr; }
+  const vector<int> &rowIndices() const { return rowIndex; }
+  const vector<Complex> &values() const { return val; }
+
+private:
+  int n;                ///< Matrix dimension
+  vector<int> colPtr;   ///< Start of each column in rowIndex/val (size n+1)
+  vector<int> rowIndex; ///< Row of each entry, sorted within each column
+  vector<Complex> val;  ///< Entry values
+};
+
+/// @class SparseLU
+/// @brief Sparse LU factorization with partial pivoting (P*A*Q = L*U)
+/// @details The solver is split in three stages:
+///          - analyze(): computes a fill-reducing column ordering (minimum
+///            degree on the pattern of A+A^T). It only depends on the pattern.
+///          - factorize(): numeric factorization. The first call performs a
+///            left-looking LU (Gilbert-Peierls) with threshold partial
+///            pivoting. Next calls reuse the pivot sequence and the patterns of
+///            L and U, and only recompute the values. If a reused pivot
+///            turns out to be numerically unacceptable, the matrix is factorized
+///            again with pivoting. If a pivot cancels against much larger
+///            entries of its column (e.g. the 1e12 S of a 0 Ω element), the
+///            fill-reducing ordering is dropped for the natural order.
+///          - solve(): forward/backward substitution for multiple RHS.
+class SparseLU {
+public:
+  SparseLU() : n(0), factorized(false), naturalOrder(false) {}
+
+  /// @brief Computes the fill-reducing ordering of the matrix
+  void analyze(const SparseNodalMatrix &A);
+
+  /// @brief Returns true if analyze() has been called
+  bool isAnalyzed() const { return !colOrder.empty() || n == 0; }
+
+  /// @brief Numeric factorization of A. It must have the analyzed pattern
+  /// @throws runtime_error if the matrix is singular
+  void factorize(const SparseNodalMatrix &A);
+
+  /// @brief Solves A*X = B
+  /// @param rhs Right-hand side matrix (n x nrhs). Overwritten with the solution
+  void solve(ComplexMatrix &rhs) const;
+
+  /// @brief Returns the number of entries in the L and U factors
+  int factorNonZeros() const { return Li.size() + Ui.size(); }
+
+private:
+  int n;                 ///< Matrix dimension
+  bool factorized;       ///< True if L/U hold a valid factorization pattern
+  bool naturalOrder;     ///< The fill-reducing ordering was dropped
+  vector<int> colOrder;  ///< Column ordering (Q)
+  vector<int> pivotOf;   ///< Pivot position of each original row (P)
+
+  vector<int> Lp, Li;    ///< L factor (CSC, unit diagonal stored first)
+  vector<Complex> Lx;
+  vector<int> Up, Ui;    ///< U factor (CSC, diagonal stored last)
+  vector<Complex> Ux;
+
+  // Workspace
+  vector<Complex> x;
+  vector<int> reach, stack, pstack, marks;
+  mutable vector<Complex> work;
+
+  /// @brief Full factorization with threshold partial pivoting (strict
+  /// partial pivoting in the natural order)
+  /// @return false if a pivot lost its digits by cancellation in the
+  /// fill-reducing order
+  bool factorizeWithPivoting(const SparseNodalMatrix &A);
+
+  /// @brief Factorization reusing the previous pivot sequence
+  /// @return false if a pivot became too small relative to its column or
+  /// lost its digits by cancellation
+  bool refactorize(const SparseNodalMatrix &A);
+
+  /// @brief Computes the nonzero pattern of L\\A(:,col) in topological order
+  /// @return Position of the first entry of the pattern in `reach`
+  int computeReach(const SparseNodalMatrix &A, int col, int mark);
+};
+
+#endif // NODALMATRIX_H
@@ -12,20 +12,20 @@ Complex SParameterCalculator::getImpedance(const Component_SPAR &comp,
   double omega = 2 * M_PI * freq;
   switch (comp.type) {
   case ComponentType_SPAR::RESISTOR:
-    return Complex(comp.value["R"], 0);
+    return Complex(comp.params.lumped.value, 0);
 
   case ComponentType_SPAR::COMPLEX_IMPEDANCE:
-    return comp.Zvalue["Z"];
+    return Complex(comp.params.impedance.re, comp.params.impedance.im);
 
   case ComponentType_SPAR::CAPACITOR:
-    return Complex(0, -1.0 / (omega * comp.value["C"]));
+    return Complex(0, -1.0 / (omega * comp.params.lumped.value));
 
   case ComponentType_SPAR::INDUCTOR:
-    return Complex(0, omega * comp.value["L"]);
+    return Complex(0, omega * comp.params.lumped.value);
 
   case ComponentType_SPAR::OPEN_STUB: {
-    double Z0 = comp.value["Z0"];
-    double len = comp.value["Length"];
+    double Z0 = comp.params.line.Z0;
+    double len = comp.params.line.length;
     const double c = 299792458.0;
     double beta = omega / c;
     double cot_beta_l = 1.0 / tan(beta * len);
@@ -33,8 +33,8 @@ Complex SParameterCalculator::getImpedance(const Component_SPAR &comp,
   }
 
   case ComponentType_SPAR::SHORT_STUB: {
-    double Z0 = comp.value["Z0"];
-    double len = comp.value["Length"];
+    double Z0 = comp.params.line.Z0;
+    double len = comp.params.line.length;
     const double c = 299792458.0;
     double beta = omega / c;
     double tan_beta_l = tan(beta * len);
@@ -46,78 +46,108 @@ Complex SParameterCalculator::getImpedance(const Component_SPAR &comp,
   }
 }
 
-vector<vector<Complex>> SParameterCalculator::buildAdmittanceMatrix() {
-  vector<vector<Complex>> Y = createMatrix(numNodes, numNodes);
+void SParameterCalculator::stampComponent(NodalMatrix &Y,
+                                          const Component_SPAR &comp,
+                                          double freq) {
+  switch (comp.type) {
+  case ComponentType_SPAR::TRANSMISSION_LINE:
+    addTransmissionLineToAdmittance(Y, comp, freq);
+    return;
 
-  // First handle ALL lumped elements (R, L, C)
-  for (const auto &comp : components) {
+  case ComponentType_SPAR::MICROSTRIP_LINE:
+    addMicrostripLineToAdmittance(Y, comp, freq);
+    return;
 
-    // TRANSMISSION LINES (TLIN)
-    if (comp.type == ComponentType_SPAR::TRANSMISSION_LINE) {
-      addTransmissionLineToAdmittance(Y, comp);
-      continue;
-    }
+  case ComponentType_SPAR::MICROSTRIP_COUPLED_LINES:
+    addMicrostripCoupledLinesToAdmittance(Y, comp, freq);
+    return;
 
-    // Microstrip line model
-    if (comp.type == ComponentType_SPAR::MICROSTRIP_LINE) {
-      addMicrostripLineToAdmittance(Y, comp);
-      continue;
-    }
+  case ComponentType_SPAR::MICROSTRIP_VIA:
+    addMicrostripViaToAdmittance(Y, comp, freq);
+    return;
 
-    // Microstrip coupled line model
-    if (comp.type == ComponentType_SPAR::MICROSTRIP_COUPLED_LINES) {
-      addMicrostripCoupledLinesToAdmittance(Y, comp);
-      continue;
-    }
+  case ComponentType_SPAR::COUPLED_LINE:
+    addCoupledLineToAdmittance(Y, comp, freq);
+    return;
 
-    // Microstrip via model
-    if (comp.type == ComponentType_SPAR::MICROSTRIP_VIA) {
-      addMicrostripViaToAdmittance(Y, comp);
-      continue;
-    }
+  case ComponentType_SPAR::IDEAL_COUPLER:
+    addIdealCouplerToAdmittance(Y, comp, freq);
+    return;
 
-    // COUPLED LINES (CLIN)
-    if (comp.type == ComponentType_SPAR::COUPLED_LINE) {
-      addCoupledLineToAdmittance(Y, comp);
-      continue;
-    }
+  case ComponentType_SPAR::SPAR_BLOCK:
+    addSParamBlockToAdmittance(Y, comp, freq);
+    return;
 
-    if (comp.type == ComponentType_SPAR::IDEAL_COUPLER) {
-      addIdealCouplerToAdmittance(Y, comp);
-      continue;
-    }
+  case ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK:
+    addFrequencyDependentSParamBlockToAdmittance(Y, comp, freq);
+    return;
 
-    if (comp.type == ComponentType_SPAR::SPAR_BLOCK) {
-      addSParamBlockToAdmittance(Y, comp);
-      continue;
-    }
+  case ComponentType_SPAR::SUBCIRCUIT:
+    stampSubcircuit(Y, comp, freq);
+    return;
 
-    if (comp.type == ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK) {
-      addFrequencyDependentSParamBlockToAdmittance(Y, comp);
-      continue;
-    }
+  default:
+    break;
+  }
 
-    Complex impedance = getImpedance(comp, frequency);
-    if (abs(impedance) < 1e-12) {
-      impedance = Complex(1e-12, 0); // Avoid division by zero!
+  // Two-terminal elements (R, L, C, Z, stubs)
+  Complex admittance = getAdmittance(comp, freq);
+  if (comp.nodes.size() == 2) {
+    int node1 = comp.nodes[0];
+    int node2 = comp.nodes[1];
+
+    if (node1 > 0) {
+      Y[node1 - 1][node1 - 1] += admittance;
+    }
+    if (node2 > 0) {
+      Y[node2 - 1][node2 - 1] += admittance;
     }
+    if (node1 > 0 && node2 > 0) {
+      Y[node1 - 1][node2 - 1] -= admittance;
+      Y[node2 - 1][node1 - 1] -= admittance;
+    }
+  }
+}
 
-    Complex admittance = Complex(1, 0) / impedance;
-    if (comp.nodes.size() == 2) {
-      int node1 = comp.nodes[0];
-      int node2 = comp.nodes[1];
+Complex SParameterCalculator::getAdmittance(const Component_SPAR &comp,
+                                           double freq) {
+  Complex impedance = getImpedance(comp, freq);
+  if (abs(impedance) < 1e-12) {
+    impedance = Complex(1e-12, 0); // Avoid division by zero!
+  }
+  return Complex(1, 0) / impedance;
+}
 
-      if (node1 > 0) {
-        Y[node1 - 1][node1 - 1] += admittance;
-      }
-      if (node2 > 0) {
-        Y[node2 - 1][node2 - 1] += admittance;
-      }
-      if (node1 > 0 && node2 > 0) {
-        Y[node1 - 1][node2 - 1] -= admittance;
-        Y[node2 - 1][node1 - 1] -= admittance;
-      }
-    }
+bool SParameterCalculator::isFrequencyDependent(ComponentType_SPAR type) {
+  switch (type) {
+  case ComponentType_SPAR::RESISTOR:
+  case ComponentType_SPAR::COMPLEX_IMPEDANCE:
+  case ComponentType_SPAR::IDEAL_COUPLER:
+  case ComponentType_SPAR::SPAR_BLOCK:
+    return false;
+
+  case ComponentType_SPAR::CAPACITOR:
+  case ComponentType_SPAR::INDUCTOR:
+  case ComponentType_SPAR::TRANSMISSION_LINE:
+  case ComponentType_SPAR::OPEN_STUB:
+  case ComponentType_SPAR::SHORT_STUB:
+  case ComponentType_SPAR::COUPLED_LINE:
+  case ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK:
+  case ComponentType_SPAR::MICROSTRIP_LINE:
+  case ComponentType_SPAR::MICROSTRIP_COUPLED_LINES:
+  case ComponentType_SPAR::MICROSTRIP_VIA:
+  case ComponentType_SPAR::SUBCIRCUIT:
+    return true;
+
+  default:
+    // Types without a model are stamped as a constant (see getImpedance)
+    return false;
+  }
+}
+
+void SParameterCalculator::buildAdmittanceMatrix(NodalMatrix &Y, double freq) {
+  for (const auto &comp : components) {
+    stampComponent(Y, comp, freq);
   }
 
   // Add small conductance to ground to prevent singular matrix (for all nodes)
@@ -125,8 +155,142 @@ vector<vector<Complex>> SParameterCalculator::buildAdmittanceMatrix() {
   for (int i = 0; i < numNodes; ++i) {
     Y[i][i] += Complex(gmin, 0);
   }
+}
 
-  return Y;
+void SParameterCalculator::compileCircuit() {
+  chrono::steady_clock::time_point start = startStage();
+  plan = CircuitPlan();
+  checkPorts();
+  plan.useSparse = prepareSparseSolver();
+  bindMicrostripModels();
+
+  // Split the components in static and frequency-dependent stamps
+  for (int i = 0; i < (int)components.size(); i++) {
+    if (isFrequencyDependent(components[i].type)) {
+      plan.dynamicStamps.push_back(i);
+    } else {
+      plan.staticStamps.push_back(i);
+    }
+  }
+
+  stampStaticPlan();
+  analyzeLadder();
+  analyzeBatch();
+  analyzePoleResidue();
+  plan.valid = true;
+  lapStage(stageTimes.compile, start);
+}
+
+void SParameterCalculator::stampStaticPlan() {
+  // Accumulate the static part of the augmented matrix: static components,
+  // gmin and port equations. The frequency passed to the stamps is irrelevant
+  auto stampStatic = [&](NodalMatrix &A) {
+    for (int i : plan.staticStamps) {
+      stampComponent(A, components[i], frequency);
+    }
+    double gmin = 1e-12;
+    for (int i = 0; i < numNodes; ++i) {
+      A[i][i] += Complex(gmin, 0);
+    }
+    addPortEquations(A);
+  };
+
+  if (plan.useSparse) {
+    SparseNodalMatrix &A = solverContext.sparseSystem;
+    A.setZero();
+    stampStatic(A);
+    plan.staticValues = A.values();
+  } else {
+    int systemSize = numNodes + ports.size();
+    plan.staticDense.resize(systemSize, systemSize);
+    DenseNodalMatrix A(plan.staticDense);
+    stampStatic(A);
+  }
+}
+
+void SParameterCalculator::updateCircuitValues() {
+  for (Component_SPAR &comp : components) {
+    bindMicrostripModel(comp);
+  }
+  stampStaticPlan();
+  analyzeBatch();
+
+  // The pole-residue form is computed again for the new values
+  PoleResiduePlan &model = plan.poles;
+  bool eligible = model.eligible;
+  int size = model.size;
+  model = PoleResiduePlan();
+  model.eligible = eligible;
+  model.size = size;
+}
+
+void SParameterCalculator::addPortEquations(NodalMatrix &A) {
+  for (int p = 0; p < (int)ports.size(); p++) {
+    int portNode = ports[p].node - 1;
+    int portEqn = numNodes + p;
+
+    A[portEqn][portNode] = Complex(1, 0);
+    A[portEqn][portEqn] = Complex(-1, 0);
+
+    Complex Gp = Complex(1.0 / ports[p].impedance, 0);
+    A[portNode][portEqn] = Gp;
+  }
+}
+
+vector<pair<int, int>> SParameterCalculator::getNodalPattern() const {
+  vector<pair<int, int>> pattern;
+
+  for (int i = 0; i < numNodes; i++) {
+    pattern.emplace_back(i, i);
+  }
+
+  // Each component may couple all of its nodes
+  for (const auto &comp : components) {
+    for (int node_i : comp.nodes) {
+      for (int node_j : comp.nodes) {
+        if (node_i > 0 && node_j > 0) {
+          pattern.emplace_back(node_i - 1, node_j - 1);
+        }
+      }
+    }
+  }
+
+  for (int p = 0; p < (int)ports.size(); p++) {
+    int portNode = ports[p].node - 1;
+    int portEqn = numNodes + p;
+    pattern.emplace_back(portEqn, portNode);
+    pattern.emplace_back(portEqn, portEqn);
+    pattern.emplace_back(portNode, portEqn);
+  }
+
+  sort(pattern.begin(), pattern.end());
+  pattern.erase(unique(pattern.begin(), pattern.end()), pattern.end());
+  return pattern;
+}
+
+void SParameterCalculator::checkPorts() const {
+  for (const auto &port : ports) {
+    if (port.node <= 0 || port.node > numNodes) {
+      throw runtime_error("Port node " + to_string(port.node) +
+                          " is out of bounds (1-" + to_string(numNodes) + ")");
+    }
+  }
+}
+
+bool SParameterCalculator::prepareSparseSolver() {
+  int systemSize = numNodes + ports.size();
+  if (systemSize < sparseThreshold) {
+    return false;
+  }
+
+  vector<pair<int, int>> pattern = getNodalPattern();
+  SparseNodalMatrix &A = solverContext.sparseSystem;
+  if (pattern != sparsePattern || A.size() != systemSize) {
+    A.setPattern(systemSize, pattern);
+    solverContext.sparseSolver.analyze(A);
+    sparsePattern = pattern;
+  }
+  return true;
 }
 
 void SParameterCalculator::addComponent(ComponentType_SPAR type,
@@ -134,6 +298,7 @@ void SParameterCalculator::addComponent(ComponentType_SPAR type,
                                         const vector<int> &nodes,
                                         QMap<QString, Complex> Zvalue) {
   components.emplace_back(type, name, nodes, Zvalue);
+  plan.valid = false;
 
   // Update number of nodes
   for (int node : nodes) {
@@ -147,6 +312,7 @@ void SParameterCalculator::addComponent(
     ComponentType_SPAR type, const string &name, const vector<int> &nodes,
     QMap<QString, QList<double>> freqDepData) {
   components.emplace_back(type, name, nodes, freqDepData);
+  plan.valid = false;
 
   // Update number of nodes
   for (int node : nodes) {
@@ -161,6 +327,7 @@ void SParameterCalculator::addComponent(ComponentType_SPAR type,
                                         const vector<int> &nodes,
                                         QMap<QString, double> value) {
   components.emplace_back(type, name, nodes, value);
+  plan.valid = false;
 
   // Update number of nodes
   for (int node : nodes) {
@@ -172,6 +339,7 @@ void SParameterCalculator::addComponent(ComponentType_SPAR type,
 
 void SParameterCalculator::addPort(int node, double impedance) {
   ports.emplace_back(node, impedance);
+  plan.valid = false;
 }
 
 vector<vector<Complex>> SParameterCalculator::calculateSParameters() {
@@ -179,137 +347,376 @@ vector<vector<Complex>> SParameterCalculator::calculateSParameters() {
     throw runtime_error("No ports defined for S-parameter calculation");
   }
 
+  if (!plan.valid) {
+    compileCircuit();
+  }
+  try {
+    vector<vector<Complex>> S = createMatrix(ports.size(), ports.size());
+    solveSParameters(frequency, solverContext, S);
+    return S;
+  } catch (const exception &e) {
+    cerr << "Error solving the nodal equations: " << e.what() << endl;
+    throw;
+  }
+}
+
+void SParameterCalculator::solveSParameters(double freq, SolverContext &ctx,
+                                            vector<vector<Complex>> &S) {
   int numPorts = ports.size();
-  vector<vector<Complex>> S = createMatrix(numPorts, numPorts);
-  vector<vector<Complex>> Y = buildAdmittanceMatrix();
 
   // Check all port nodes are within bounds
-  for (const auto &port : ports) {
-    if (port.node <= 0 || port.node > numNodes) {
-      throw runtime_error("Port node " + to_string(port.node) +
-                          " is out of bounds (1-" + to_string(numNodes) + ")");
-    }
+  checkPorts();
+  if (!plan.valid) {
+    throw runtime_error("The circuit has not been compiled");
+  }
+
+  // 2-port ladders are solved by cascading ABCD matrices. If a section is
+  // degenerate at this frequency, the nodal equations are solved instead
+  chrono::steady_clock::time_point start = startStage();
+  if (plan.ladder.valid && solveLadder(freq, S)) {
+    lapStage(ctx.times.solve, start);
+    return;
+  }
+
+  // Column j of the right-hand side holds the excitation of port j
+  int systemSize = numNodes + numPorts;
+  ComplexMatrix &excitation = ctx.solution;
+  excitation.resize(systemSize, numPorts);
+  for (int p = 0; p < numPorts; p++) {
+    excitation(ports[p].node - 1, p) = Complex(2.0 / ports[p].impedance, 0);
   }
 
-  for (int j = 0; j < numPorts; j++) {
-    int systemSize = numNodes + numPorts;
-    vector<vector<Complex>> augmentedY = createMatrix(systemSize, systemSize);
-    vector<Complex> excitation(systemSize, Complex(0, 0));
+  // The augmented nodal matrix is the static part of the circuit plus the
+  // frequency-dependent stamps. It does not depend on the excited port, so it
+  // is factorized only once per frequency
+  if (plan.useSparse) {
+    SparseNodalMatrix &A = ctx.sparseSystem;
+    A.setValues(plan.staticValues);
+    for (int i : plan.dynamicStamps) {
+      stampDynamic(A, i, freq, ctx.point);
+    }
+    lapStage(ctx.times.stamp, start);
+    ctx.sparseSolver.factorize(A);
+    ctx.sparseSolver.solve(excitation);
+  } else {
+    ComplexMatrix &augmentedY = ctx.denseSystem;
+    augmentedY = plan.staticDense;
+    DenseNodalMatrix A(augmentedY);
+    for (int i : plan.dynamicStamps) {
+      stampDynamic(A, i, freq, ctx.point);
+    }
+    lapStage(ctx.times.stamp, start);
 
-    // Copy the internal nodal admittance matrix
-    for (int i = 0; i < numNodes; i++) {
-      for (int k = 0; k < numNodes; k++) {
-        augmentedY[i][k] = Y[i][k];
+    luFactorize(augmentedY, ctx.pivots);
+    luSolve(augmentedY, ctx.pivots, excitation);
+  }
+  lapStage(ctx.times.solve, start);
+
+  for (int i = 0; i < numPorts; i++) {
+    for (int j = 0; j < numPorts; j++) {
+      Complex portVoltage = excitation(numNodes + i, j);
+      if (i == j) {
+        S[i][j] = portVoltage - Complex(1, 0);
+      } else {
+        S[i][j] = portVoltage;
       }
     }
+  }
+  lapStage(ctx.times.extract, start);
+}
+
+void SParameterCalculator::setFrequencySweep(double start, double stop,
+                                             int points, bool logarithmic) {
+  if (logarithmic && (start <= 0 || stop <= 0)) {
+    cerr << "Error: A logarithmic sweep needs positive frequencies" << endl;
+    throw runtime_error("Invalid logarithmic sweep");
+  }
+  sweepFrequencies.assign(max(points, 0), start);
+  if (points <= 1) {
+    return;
+  }
+  if (logarithmic) {
+    double decades = log10(stop / start) / (points - 1);
+    for (int i = 0; i < points; ++i) {
+      sweepFrequencies[i] = start * pow(10.0, i * decades);
+    }
+    sweepFrequencies[points - 1] = stop; // Exact stop frequency
+    return;
+  }
+  double step = (stop - start) / (points - 1);
+  for (int i = 0; i < points; ++i) {
+    sweepFrequencies[i] = start + i * step;
+  }
+}
 
-    // Add port equations
-    for (int p = 0; p < numPorts; p++) {
-      int portNode = ports[p].node - 1;
-      int portEqn = numNodes + p;
+int SParameterCalculator::getNumThreads() const {
+  if (numThreads > 0) {
+    return numThreads;
+  }
+  return max(1u, thread::hardware_concurrency());
+}
+
+void SParameterCalculator::runSweepWorkers(
+    int n, const function<void(int, int, SolverContext &)> &job) {
+  // Split the grid in contiguous blocks, one per worker. The assignment only
+  // depends on the number of threads, so the results are reproducible
+  int threads = min(getNumThreads(), n);
+  if (threads <= 1) {
+    job(0, n, solverContext);
+    addStageTimes(solverContext);
+    return;
+  }
+  addStageTimes(solverContext); // The copies start from zero
+  vector<SolverContext> contexts(threads, solverContext);
+  vector<thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    int first = (long long)n * t / threads;
+    int last = (long long)n * (t + 1) / threads;
+    workers.emplace_back(job, first, last, ref(contexts[t]));
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  for (SolverContext &ctx : contexts) {
+    addStageTimes(ctx);
+  }
+}
 
-      augmentedY[portEqn][portNode] = Complex(1, 0);
-      augmentedY[portEqn][portEqn] = Complex(-1, 0);
+void SParameterCalculator::addStageTimes(SolverContext &ctx) {
+  stageTimes.stamp += ctx.times.stamp;
+  stageTimes.solve += ctx.times.solve;
+  stageTimes.extract += ctx.times.extract;
+  ctx.times = StageTimes();
+}
 
-      Complex Gp = Complex(1.0 / ports[p].impedance, 0);
-      augmentedY[portNode][portEqn] = Gp;
+const char *SParameterCalculator::getSweepSolver() const {
+  if (plan.poles.built) {
+    return "pole-residue";
+  }
+  if (plan.ladder.valid) {
+    return "ladder";
+  }
+  if (plan.batch.valid) {
+    return "batched";
+  }
+  return plan.useSparse ? "sparse" : "dense";
+}
 
-      if (p == j) {
-        excitation[portNode] = Complex(2.0 / ports[p].impedance, 0);
-      }
-    }
+bool SParameterCalculator::solveSweep(const vector<double> &freqs,
+                                      SweepResult &result,
+                                      vector<string> &errors,
+                                      bool useIncremental) {
+  int n_points = freqs.size();
+  int n_ports = ports.size();
 
+  // The circuit plan and the symbolic analysis of the sparse solver are built
+  // once and shared by all the workers. If the ports are wrong, every point
+  // reports the error
+  if (!plan.valid) {
     try {
-      vector<vector<Complex>> augmentedYinv = invertMatrix(augmentedY);
-      vector<Complex> solution(systemSize, Complex(0, 0));
+      compileCircuit();
+    } catch (const std::exception &) {
+    }
+  }
 
-      for (int i = 0; i < systemSize; i++) {
-        for (int k = 0; k < systemSize; k++) {
-          solution[i] += augmentedYinv[i][k] * excitation[k];
-        }
+  // The solvers write into a matrix of the worker, which is then copied into
+  // the result
+  auto store = [&](int i, const vector<vector<Complex>> &S) {
+    Complex *out = result.matrix(i);
+    for (int row = 0; row < n_ports; ++row) {
+      copy(S[row].begin(), S[row].end(), out + row * n_ports);
+    }
+    result.setSolved(i, true);
+  };
+
+  // Scalar solve of one point. Errors are kept and reported in order by the
+  // caller
+  auto solvePoint = [&](int i, SolverContext &ctx,
+                        vector<vector<Complex>> &S) {
+    ctx.point = i;
+    try {
+      solveSParameters(freqs[i], ctx, S);
+      store(i, S);
+    } catch (const std::exception &e) {
+      errors[i] = e.what();
+    }
+    ctx.point = -1;
+  };
+
+  // Small dense circuits are solved SWEEP_BATCH frequencies at a time. The
+  // points that the batched solver leaves unsolved go to the scalar solver
+  bool batched = plan.valid && plan.batch.valid;
+  auto solveRange = [&](int first, int last, SolverContext &ctx) {
+    vector<vector<Complex>> S[SWEEP_BATCH];
+    for (auto &matrix : S) {
+      matrix = createMatrix(n_ports, n_ports);
+    }
+    bool useBatch = batched;
+    for (int i = first; i < last && !cancelRequested(); i += SWEEP_BATCH) {
+      int count = min(SWEEP_BATCH, last - i);
+      bool done[SWEEP_BATCH] = {};
+      if (useBatch) {
+        solveSParameterBlock(&freqs[i], count, ctx, S, done);
+        // If no frequency of the block could be solved (e.g. a floating
+        // node), the circuit needs pivoting: use the scalar solver only
+        useBatch = any_of(done, done + count, [](bool d) { return d; });
       }
-
-      for (int i = 0; i < numPorts; i++) {
-        Complex portVoltage = solution[numNodes + i];
-        if (i == j) {
-          S[i][j] = portVoltage - Complex(1, 0);
+      for (int l = 0; l < count; ++l) {
+        if (done[l]) {
+          store(i + l, S[l]);
         } else {
-          S[i][j] = portVoltage;
+          solvePoint(i + l, ctx, S[l]);
         }
       }
-
-    } catch (const exception &e) {
-      cerr << "Error solving for port " << j + 1 << ": " << e.what() << endl;
-      throw;
     }
+  };
+
+  // Lumped circuits are evaluated from their poles and residues. A frequency
+  // on a pole of the model is solved by the scalar solver
+  if (usePoleResidue(freqs)) {
+    runSweepWorkers(n_points, [&](int first, int last, SolverContext &ctx) {
+      vector<vector<Complex>> S;
+      for (int i = first; i < last && !cancelRequested(); ++i) {
+        if (evaluatePoleResidue(freqs[i], result.matrix(i))) {
+          result.setSolved(i, true);
+          continue;
+        }
+        if (S.empty()) {
+          S = createMatrix(n_ports, n_ports);
+        }
+        solvePoint(i, ctx, S);
+      }
+    });
+    return !cancelRequested();
   }
 
-  return S;
-}
+  // The microstrip dispersion and losses and the port admittance matrices of
+  // the subcircuits are evaluated for the whole sweep before the workers start
+  chrono::steady_clock::time_point start = startStage();
+  prepareMicrostripSweep(freqs);
+  prepareSubcircuitSweep(freqs);
+  lapStage(stageTimes.prepare, start);
+
+  // Value-only edits of the previous circuit are solved by updating the
+  // stored nodal impedance matrices (see incremental.cpp)
+  IncrementalMode mode =
+      useIncremental ? prepareIncrementalSweep() : IncrementalMode::NONE;
+  if (mode == IncrementalMode::UPDATE) {
+    runSweepWorkers(n_points, [&](int first, int last, SolverContext &ctx) {
+      vector<vector<Complex>> S = createMatrix(n_ports, n_ports);
+      for (int i = first; i < last && !cancelRequested(); ++i) {
+        try {
+          updateSParameters(i, freqs[i], ctx, S);
+          store(i, S);
+        } catch (const std::exception &) {
+          solvePoint(i, ctx, S);
+        }
+      }
+    });
+  } else if (mode == IncrementalMode::CAPTURE) {
+    runSweepWorkers(n_points, [&](int first, int last, SolverContext &ctx) {
+      vector<vector<Complex>> S = createMatrix(n_ports, n_ports);
+      for (int i = first; i < last && !cancelRequested(); ++i) {
+        try {
+          captureNodalImpedance(i, freqs[i], ctx, S);
+          store(i, S);
+        } catch (const std::exception &) {
+          solvePoint(i, ctx, S);
+        }
+      }
+    });
+  } else {
+    runSweepWorkers(n_points, solveRange);
+  }
 
-void SParameterCalculator::setFrequencySweep(double start, double stop,
-                                             int points) {
-  f_start = start;
-  f_stop = stop;
-  n_points = points;
+  microstripSweep.clear();
+
+  // The matrices captured by a stopped sweep are incomplete
+  if (cancelRequested()) {
+    if (useIncremental) {
+      finishIncrementalSweep(mode == IncrementalMode::CAPTURE
+                                 ? IncrementalMode::NONE
+                                 : mode);
+    }
+    return false;
+  }
+  if (useIncremental) {
+    finishIncrementalSweep(mode);
+  }
+  return true;
 }
 
-void SParameterCalculator::calculateSParameterSweep() {
+void SParameterCalculator::calculateSParameterSweep(SweepSink &sink) {
+  sweepResult.clear();
+  cancelled = false;
+  solvedPoints = 0;
   if (ports.empty()) {
     return;
   }
 
-  sweepResults.clear();
-  data.clear();
-
   int n_ports = ports.size();
   double Z0 = ports.at(0).impedance;
-  data["n_ports"].append(n_ports);
-  data["Z0"].append(Z0);
+  const vector<double> &freqs = sweepFrequencies;
+  sink.beginSweep(n_ports, Z0, freqs.size());
+
+  // The sweep is solved in blocks of SWEEP_CHUNK points. Only one block is
+  // held in memory. The stored nodal impedance matrices of the incremental
+  // mode would take the memory saved, so it is not used
+  vector<string> errors;
+  for (size_t first = 0; first < freqs.size(); first += SWEEP_CHUNK) {
+    size_t last = min(freqs.size(), first + SWEEP_CHUNK);
+    vector<double> block(freqs.begin() + first, freqs.begin() + last);
+    SweepResult result(n_ports, Z0, block);
+    errors.assign(block.size(), string());
+
+    bool completed = adaptiveSweep ? solveAdaptiveSweep(block, result, errors)
+                                   : solveSweep(block, result, errors, false);
+    if (!completed) {
+      cancelled = true;
+      return;
+    }
 
-  double step = (n_points == 1) ? 0 : (f_stop - f_start) / (n_points - 1);
+    for (size_t i = 0; i < block.size(); ++i) {
+      if (!result.isSolved(i)) {
+        std::cerr << "Error at frequency " << block[i] << " Hz: " << errors[i]
+                  << std::endl;
+      }
+      sink.addPoint(block[i], result.matrix(i));
+    }
+  }
+  sink.endSweep();
+}
+
+void SParameterCalculator::calculateSParameterSweep() {
+  sweepResult.clear();
+  cancelled = false;
+  solvedPoints = 0;
+  if (ports.empty()) {
+    return;
+  }
 
-  for (int i = 0; i < n_points; ++i) {
-    double freq = f_start + i * step;
-    frequency = freq;
-    data["frequency"].append(freq);
+  // Points that fail keep a zero matrix
+  const vector<double> freqs = sweepFrequencies;
+  sweepResult = SweepResult(ports.size(), ports.at(0).impedance, freqs);
+  if (freqs.empty()) {
+    return;
+  }
+  vector<string> errors(freqs.size());
+
+  // A stopped sweep is discarded
+  bool completed = adaptiveSweep
+                       ? solveAdaptiveSweep(freqs, sweepResult, errors)
+                       : solveSweep(freqs, sweepResult, errors, true);
+  if (!completed) {
+    cancelled = true;
+    sweepResult.clear();
+    return;
+  }
 
-    try {
-      auto S = calculateSParameters();
-      sweepResults.push_back(S);
-
-      for (int row = 1; row <= n_ports; ++row) {
-        for (int col = 1; col <= n_ports; ++col) {
-          // Get the S-parameter value (note: S matrix uses 0-based indexing)
-          Complex sParam = S[row - 1][col - 1];
-
-          // Extract real and imaginary parts
-          double re = sParam.real();
-          double im = sParam.imag();
-
-          // Calculate magnitude and convert to dB
-          double magnitude = sqrt(re * re + im * im);
-          double dB = 20.0 * log10(magnitude);
-
-          // Calculate phase angle in degrees
-          double ang = atan2(im, re) * 180.0 / M_PI;
-
-          QString keyDb = QString("S%1%2_dB").arg(row).arg(col);
-          QString keyAng = QString("S%1%2_ang").arg(row).arg(col);
-          QString keyRe = QString("S%1%2_re").arg(row).arg(col);
-          QString keyIm = QString("S%1%2_im").arg(row).arg(col);
-
-          data[keyDb].append(dB);
-          data[keyAng].append(ang);
-          data[keyRe].append(re);
-          data[keyIm].append(im);
-        }
-      }
-    } catch (const std::exception &e) {
-      std::cerr << "Error at frequency " << freq << " Hz: " << e.what()
+  for (size_t i = 0; i < freqs.size(); ++i) {
+    if (!sweepResult.isSolved(i)) {
+      std::cerr << "Error at frequency " << freqs[i] << " Hz: " << errors[i]
                 << std::endl;
-      sweepResults.push_back(std::vector<std::vector<Complex>>(
-          ports.size(), std::vector<Complex>(ports.size(), Complex(0, 0))));
     }
   }
 }
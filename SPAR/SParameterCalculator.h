@@ -16,18 +16,29 @@
 #include <QStringList>
 #include <QTextStream>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <complex>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 #include <utility> // std::as_const()
 
 #include "../Misc/general.h"
+#include "MonteCarlo.h"
+#include "NodalMatrix.h"
+#include "SweepResult.h"
+#include "SweepWriter.h"
 
 using namespace std;
 using Complex = complex<double>;
@@ -52,12 +63,121 @@ enum class ComponentType_SPAR {
   MICROSTRIP_STEP,
   MICROSTRIP_OPEN,
   MICROSTRIP_VIA,
-  MICROSTRIP_COUPLED_LINES
+  MICROSTRIP_COUPLED_LINES,
+  SUBCIRCUIT
 };
 
+/// @struct LumpedParams
+/// @brief Parameters of R, L and C components
+struct LumpedParams {
+  double value; ///< Resistance (Ω), capacitance (F) or inductance (H)
+};
+
+/// @struct ImpedanceParams
+/// @brief Parameters of a complex impedance
+struct ImpedanceParams {
+  double re; ///< Real part (Ω)
+  double im; ///< Imaginary part (Ω)
+};
+
+/// @struct LineParams
+/// @brief Parameters of ideal transmission lines and stubs
+struct LineParams {
+  double Z0;     ///< Characteristic impedance (Ω)
+  double length; ///< Physical length (m)
+};
+
+/// @struct CoupledLineParams
+/// @brief Parameters of ideal coupled lines
+struct CoupledLineParams {
+  double Z0e;    ///< Even-mode characteristic impedance (Ω)
+  double Z0o;    ///< Odd-mode characteristic impedance (Ω)
+  double length; ///< Physical length (m)
+};
+
+/// @struct IdealCouplerParams
+/// @brief Parameters of the ideal directional coupler
+struct IdealCouplerParams {
+  double k;         ///< Linear coupling coefficient
+  double phase_deg; ///< Phase shift (degrees)
+  double Z0;        ///< Reference impedance (Ω)
+};
+
+/// @struct MicrostripParams
+/// @brief Geometry and substrate of the microstrip components
+/// @details Not all the fields are used by every component type.
+struct MicrostripParams {
+  double W;    ///< Strip width (m). Width of the first section in steps
+  double W2;   ///< Width of the second section of a step (m)
+  double L;    ///< Length (m)
+  double S;    ///< Spacing between coupled lines (m)
+  double D;    ///< Via diameter (m)
+  int N;       ///< Number of vias in parallel
+  double h;    ///< Substrate height (m)
+  double er;   ///< Relative permittivity
+  double t;    ///< Conductor thickness (m)
+  double tand; ///< Loss tangent
+  double rho;  ///< Conductor resistivity (Ohm*m)
+};
+
+/// @struct MicrostripStaticModel
+/// @brief Frequency-independent part of the microstrip models
+/// @details It only depends on the geometry and the substrate, so it is
+///          computed once and shared by all the components with the same
+///          geometry (see SParameterCalculator::bindMicrostripModels()).
+struct MicrostripStaticModel {
+  // Single line (Hammerstad quasi-static analysis)
+  double ZlEff = 0; ///< Characteristic impedance (Ω)
+  double ErEff = 0; ///< Effective permittivity
+  double WEff = 0;  ///< Effective width (m)
+
+  // Coupled lines (Kirschning quasi-static analysis)
+  double Zle = 0;    ///< Even-mode impedance (Ω)
+  double Zlo = 0;    ///< Odd-mode impedance (Ω)
+  double ErEffe = 0; ///< Even-mode effective permittivity
+  double ErEffo = 0; ///< Odd-mode effective permittivity
+
+  // Via
+  double R = 0;  ///< DC resistance (Ω)
+  double fs = 0; ///< Skin effect factor, R(f) = R * sqrt(1 + f * fs) (1/Hz)
+  double L = 0;  ///< Inductance (H)
+};
+
+/// @struct SParameterTable
+/// @brief Tabulated S-parameters of a frequency-dependent block
+/// @details Built from the Touchstone data when the component is created, so
+///          the stamps do not look up the data by name at every frequency.
+struct SParameterTable {
+  int size = 0;             ///< Matrix size
+  vector<double> frequency; ///< Sample frequencies (Hz), ascending
+  vector<Complex> S; ///< S-matrix of sample k, entry (i, j) at (k*size+i)*size+j
+  vector<Complex> Y; ///< Y-matrices of 2-port blocks at the samples, same
+                     ///< layout as S (empty if not available)
+};
+
+/// @union ComponentParams
+/// @brief Parameters of a component, resolved from the named parameter maps
+/// @details The active member is given by the component type. The stamps read
+///          these fields instead of looking up the parameters by name at every
+///          frequency.
+union ComponentParams {
+  LumpedParams lumped;        ///< RESISTOR, CAPACITOR, INDUCTOR
+  ImpedanceParams impedance;  ///< COMPLEX_IMPEDANCE
+  LineParams line;            ///< TRANSMISSION_LINE, OPEN_STUB, SHORT_STUB
+  CoupledLineParams coupled;  ///< COUPLED_LINE
+  IdealCouplerParams coupler; ///< IDEAL_COUPLER
+  MicrostripParams microstrip; ///< MICROSTRIP_*
+};
+
+struct Subcircuit;
+
 /// @struct Component_SPAR
 /// @brief Circuit component structure
-/// @details It includes all the parameters and connectivity information
+/// @details It includes all the parameters and connectivity information.
+///          The named parameters (value, Zvalue) are the interface with the
+///          netlist; they are resolved into params when the component is
+///          created. If they are modified later, resolveParameters() must be
+///          called.
 struct Component_SPAR {
   ComponentType_SPAR type;          ///< Component type identifier
   string name;                       ///< Component name/label
@@ -67,42 +187,101 @@ struct Component_SPAR {
   QMap<QString, Complex> Zvalue;     ///< Complex impedance values
   vector<vector<Complex>> Smatrix;   ///< S-parameter matrix for network blocks
   QMap<QString, QList<double>> freqDepData; ///< Frequency-dependent data tables
-  int numRFPorts;                    ///< Number of RF ports for network blocks
-  double referenceImpedance;         ///< Reference impedance (typically 50Ω)
+  int numRFPorts = 0;                ///< Number of RF ports for network blocks
+  double referenceImpedance = 50.0;  ///< Reference impedance (typically 50Ω)
+  ComponentParams params;            ///< Parameters used by the stamps
+
+  /// @brief Static models of the microstrip components, set when the circuit
+  /// is compiled. The second one is the W2 section of a step
+  shared_ptr<const MicrostripStaticModel> msModel[2];
+
+  /// @brief S-parameter data of FREQUENCY_DEPENDENT_SPAR_BLOCK components
+  shared_ptr<const SParameterTable> sTable;
+
+  /// @brief Definition of SUBCIRCUIT instances
+  shared_ptr<const Subcircuit> subcircuit;
 
   /// @brief Constructor for S-parameter network block with matrix
   Component_SPAR(ComponentType_SPAR t, const string& n, const vector<int>& nds,
                  const vector<vector<Complex>>& S, int rfPorts,
                  double Z0 = 50.0)
       : type(t), name(n), nodes(nds), frequency(0.0),
-        Smatrix(S), numRFPorts(rfPorts), referenceImpedance(Z0) {}
+        Smatrix(S), numRFPorts(rfPorts), referenceImpedance(Z0), params() {}
 
   /// @brief Constructor for frequency-dependent S-parameter block
   Component_SPAR(ComponentType_SPAR t, const string& n, const vector<int>& nds,
                  QMap<QString, QList<double>> freqData, int rfPorts,
                  double Z0 = 50.0)
       : type(t), name(n), nodes(nds), frequency(0.0),
-        freqDepData(freqData), numRFPorts(rfPorts), referenceImpedance(Z0) {}
+        freqDepData(freqData), numRFPorts(rfPorts), referenceImpedance(Z0),
+        params() {
+    resolveParameters();
+  }
+
+  /// @brief Constructor for frequency-dependent S-parameter block whose table
+  /// is already built (shared with other components)
+  Component_SPAR(ComponentType_SPAR t, const string& n, const vector<int>& nds,
+                 QMap<QString, QList<double>> freqData,
+                 shared_ptr<const SParameterTable> table, int rfPorts,
+                 double Z0 = 50.0)
+      : type(t), name(n), nodes(nds), frequency(0.0), freqDepData(freqData),
+        numRFPorts(rfPorts), referenceImpedance(Z0), params(), sTable(table) {}
 
   /// @brief Constructor for lumped components with real parameters
   Component_SPAR(ComponentType_SPAR t, const string& n, const vector<int>& nds,
                  QMap<QString, double> val)
-      : type(t), name(n), nodes(nds), frequency(0.0), value(val) {}
+      : type(t), name(n), nodes(nds), frequency(0.0), value(val), params() {
+    resolveParameters();
+  }
 
   /// @brief Constructor for complex impedance components
   Component_SPAR(ComponentType_SPAR t, const string& n, const vector<int>& nds,
                  QMap<QString, Complex> zval)
-      : type(t), name(n), nodes(nds), frequency(0.0), Zvalue(zval) {}
+      : type(t), name(n), nodes(nds), frequency(0.0), Zvalue(zval), params() {
+    resolveParameters();
+  }
 
   /// @brief Constructor for S-parameter device without port count
   Component_SPAR(ComponentType_SPAR t, const string& n, const vector<int>& nds,
                  const vector<vector<Complex>>& S)
-      : type(t), name(n), nodes(nds), frequency(0.0), Smatrix(S) {}
+      : type(t), name(n), nodes(nds), frequency(0.0), Smatrix(S),
+        numRFPorts(S.size()), params() {}
 
   /// @brief Constructor for frequency-dependent impedance
   Component_SPAR(ComponentType_SPAR t, const string& n, const vector<int>& nds,
                  QMap<QString, QList<double>> freqData)
-      : type(t), name(n), nodes(nds), frequency(0.0), freqDepData(freqData) {}
+      : type(t), name(n), nodes(nds), frequency(0.0), freqDepData(freqData),
+        params() {}
+
+  /// @brief Constructor for subcircuit instances
+  Component_SPAR(ComponentType_SPAR t, const string& n, const vector<int>& nds,
+                 shared_ptr<const Subcircuit> sub)
+      : type(t), name(n), nodes(nds), frequency(0.0), params(),
+        subcircuit(sub) {}
+
+  /// @brief Fills params from the named parameters (value and Zvalue) and
+  /// sTable from freqDepData
+  void resolveParameters();
+};
+
+/// @struct Subcircuit
+/// @brief Subcircuit definition (.SUBCKT) and its port admittance matrices
+/// @details The local nodes are numbered with the internal nodes first
+///          (1...numNodes - ports.size()) followed by the ports, in order. The
+///          instances stamp the port admittance matrix, obtained by
+///          eliminating the internal nodes (Schur complement). The matrices of
+///          the sweep frequencies are computed once per definition and kept
+///          while the definition does not change.
+struct Subcircuit {
+  string name;                       ///< Subcircuit name
+  string key;                        ///< Definition text (cache key)
+  int numNodes = 0;                  ///< Number of local nodes
+  int numPorts = 0;                  ///< Number of ports
+  vector<Component_SPAR> components; ///< Components (local nodes)
+  vector<double> frequency;          ///< Frequencies of the cached matrices
+  vector<Complex> Y; ///< Port admittance matrix of frequency k, entry (i, j)
+                     ///< at (k*numPorts+i)*numPorts+j
+  vector<char> reduced; ///< The matrix of frequency k is available
 };
 
 /// @struct Port
@@ -117,6 +296,20 @@ struct Port {
   Port(int n, double z = 50.0) : node(n), impedance(z) {}
 };
 
+/// @struct StageTimes
+/// @brief Time spent in each stage of the engine (ms)
+/// @details Measured while SParameterCalculator::setStageTiming() is on. The
+///          stamp, solve and extract times are summed over the sweep workers,
+///          and the 2-port ladders are counted as solve time.
+struct StageTimes {
+  double parse = 0;   ///< Netlist parsing
+  double compile = 0; ///< Circuit plan
+  double prepare = 0; ///< Models tabulated over the sweep
+  double stamp = 0;   ///< Nodal matrices and port excitations
+  double solve = 0;   ///< LU factorizations and forward/back substitutions
+  double extract = 0; ///< S-matrices from the port voltages
+};
+
 /// @class SParameterCalculator
 /// @brief Calculates S-parameters using nodal analysis
 ///
@@ -148,24 +341,470 @@ private:
   /// @param matrix Input square matrix to be inverted
   /// @return Inverse matrix (matrix^-1)
   /// @details Uses LU decomposition with row pivoting for numerical stability.
-  ///          Required for solving the augmented nodal equations in S-parameter extraction.
+  ///          Used by the S-to-Y conversions of the S-parameter based components.
   vector<vector<Complex>> invertMatrix(const vector<vector<Complex>>& matrix);
 
+  /// @brief Factorizes a square matrix in place as P*A = L*U
+  /// @param matrix Matrix to factorize. On return it holds the unit lower
+  ///        triangular factor L (below the diagonal) and U (on and above it)
+  /// @param pivots On return, pivots[k] is the row swapped with row k at step k
+  /// @details Gaussian elimination with partial (row) pivoting. The factors can
+  ///          be reused by luSolve() for any number of right-hand sides.
+  /// @throws runtime_error if a pivot is smaller than 1e-12 (singular matrix)
+  static void luFactorize(ComplexMatrix& matrix, vector<int>& pivots);
+
+  /// @brief Solves A*X = B using the factors computed by luFactorize()
+  /// @param lu Factorized matrix returned by luFactorize()
+  /// @param pivots Row interchanges returned by luFactorize()
+  /// @param rhs Right-hand side matrix (n x nrhs). Overwritten with the solution
+  static void luSolve(const ComplexMatrix& lu, const vector<int>& pivots,
+               ComplexMatrix& rhs);
+
+  /// @brief Computes the complex Schur form A = Q * T * Q^H
+  /// @param A Square matrix. On return, the upper triangular factor T, whose
+  ///        diagonal holds the eigenvalues
+  /// @param Q On return, the unitary factor
+  /// @return false if the QR iteration did not converge
+  /// @details Householder reduction to Hessenberg form followed by the
+  ///          shifted QR iteration.
+  static bool schurDecompose(ComplexMatrix& A, ComplexMatrix& Q);
+
+  /// @brief Swaps the diagonal entries k and k + 1 of a Schur form, updating
+  /// Q so that Q * T * Q^H does not change
+  static void swapSchurDiagonal(ComplexMatrix& T, ComplexMatrix& Q, int k);
+
   /// @brief Calculates frequency-dependent impedance for a component
   /// @param comp Component_SPAR object, which indicates the component type and contains its parameters
   /// @param freq Frequency at which the impedance must be calculated
   /// @return Complex value with the impedance
   Complex getImpedance(const Component_SPAR& comp, double freq);
 
-  /// @brief Constructs nodal admittance matrix for the circuit
-  /// @return Admittance matrix of the network
-  vector<vector<Complex>> buildAdmittanceMatrix();
+  /// @brief Calculates the admittance of a two-terminal component
+  /// @details Impedances below 1e-12 Ω are clamped to avoid the division by
+  ///          zero.
+  Complex getAdmittance(const Component_SPAR& comp, double freq);
+
+  /// @brief Adds the contribution of a component to the nodal admittance matrix
+  /// @param Y Nodal matrix
+  /// @param comp Component to stamp
+  /// @param freq Analysis frequency (Hz)
+  void stampComponent(NodalMatrix& Y, const Component_SPAR& comp, double freq);
+
+  /// @brief Returns true if the stamp of a component type changes with
+  /// frequency
+  static bool isFrequencyDependent(ComponentType_SPAR type);
+
+  /// @brief Stamps the circuit components into the nodal admittance matrix
+  /// @param Y Nodal matrix. The first numNodes rows/columns hold the circuit
+  ///        nodes (node n maps to index n-1). It must be zero on entry
+  /// @param freq Analysis frequency (Hz)
+  void buildAdmittanceMatrix(NodalMatrix& Y, double freq);
+
+  /// @brief Adds the port equations to the augmented nodal matrix
+  /// @param A Augmented matrix. Row/column numNodes+p holds the port p equation
+  void addPortEquations(NodalMatrix& A);
+
+  /// @struct SolverContext
+  /// @brief State needed to solve the nodal equations at one frequency
+  /// @details Each sweep worker owns a copy, so several frequencies can be
+  ///          solved concurrently. The copies inherit the symbolic analysis of
+  ///          the sparse solver from the main context. The buffers are sized at
+  ///          the first frequency and then reused, so the rest of the sweep
+  ///          does not allocate memory.
+  struct SolverContext {
+    SparseNodalMatrix sparseSystem; ///< Augmented nodal matrix (CSC)
+    SparseLU sparseSolver;          ///< LU factorization of sparseSystem
+    ComplexMatrix denseSystem;      ///< Augmented nodal matrix (dense)
+    vector<int> pivots;             ///< Row interchanges of denseSystem
+    ComplexMatrix solution;         ///< Port excitations, then node voltages
+
+    // Batched solver workspace (see solveSParameterBlock())
+    vector<double> blockRe, blockIm; ///< Augmented matrices, one per lane
+    vector<double> rhsRe, rhsIm;     ///< Excitations, one set per lane
+    vector<double> blockDiagonal;    ///< |A(k,k)|^2 before the elimination
+
+    // Incremental update workspace (see updateSParameters())
+    ComplexMatrix deltaY;     ///< Admittance change on the modified nodes
+    ComplexMatrix deltaYOld;  ///< Stamps of the original components
+    ComplexMatrix capacitance; ///< I + deltaY * Z (small system)
+    ComplexMatrix coupling;   ///< deltaY * Z(modified nodes, ports)
+
+    int point = -1; ///< Sweep point being solved (-1: not a sweep point)
+    StageTimes times; ///< Stage times of the worker (see setStageTiming())
+  };
+
+  /// Number of frequencies solved together by the batched dense solver
+  static const int SWEEP_BATCH = 8;
+
+  /// Number of frequencies held in memory by a streamed sweep
+  static const int SWEEP_CHUNK = 4096;
+
+  /// @struct BatchStamp
+  /// @brief Frequency-dependent stamp evaluated by the batched solver
+  struct BatchStamp {
+    ComponentType_SPAR type; ///< CAPACITOR, INDUCTOR, stubs or TRANSMISSION_LINE
+    int n1, n2;              ///< Matrix indices of the terminals (-1: ground)
+    double p0, p1;           ///< Value (C, L) or Z0 and length (lines)
+  };
+
+  /// @struct BatchPlan
+  /// @brief Frequency-dependent stamps of a circuit solved in batches
+  struct BatchPlan {
+    bool valid = false;        ///< True if the batched solver can be used
+    vector<BatchStamp> stamps; ///< Dynamic stamps
+  };
+
+  /// @struct LadderSection
+  /// @brief Branch of a 2-port ladder network
+  struct LadderSection {
+    enum Kind {
+      SHUNT,  ///< Elements from a node to ground (plus gmin)
+      SERIES, ///< Two-terminal elements in parallel between two nodes
+      LINE    ///< Transmission line between two nodes
+    };
+    Kind kind;
+    int first; ///< First element in LadderPlan::elements
+    int last;  ///< One past the last element
+  };
+
+  /// @struct LadderPlan
+  /// @brief Series/shunt decomposition of a 2-port ladder circuit
+  struct LadderPlan {
+    bool valid = false;             ///< True if the circuit is a ladder
+    vector<LadderSection> sections; ///< Sections, from port 1 to port 2
+    vector<int> elements;           ///< Component indices of the sections
+  };
+
+  /// @struct PoleResiduePlan
+  /// @brief Pole-residue form of a circuit made of R, L and C only
+  /// @details With the inductor currents as unknowns, the nodal equations of
+  ///          a lumped circuit are (G + sC) x = b. The S-parameters are then
+  ///          S(s) = sum_q E_q (s0 - s)^q + sum_k R_k / (s - p_k) - I, where
+  ///          the polynomial comes from the poles at infinity (in practice,
+  ///          only E_0 is not negligible). Each frequency costs
+  ///          O(poles * ports^2) and needs no factorization.
+  struct PoleResiduePlan {
+    bool eligible = false;   ///< Only R, L and C (set by compileCircuit())
+    bool built = false;      ///< The form is computed
+    bool failed = false;     ///< The form could not be computed accurately
+    int size = 0;            ///< Unknowns: nodes plus inductor currents
+    double shift = 0;        ///< Expansion point s0 (rad/s)
+    vector<Complex> poles;   ///< Poles p_k (rad/s)
+    vector<Complex> residues; ///< Residue k, (i, j) at (k*P+i)*P+j
+    vector<Complex> polynomial; ///< Term E_q, (i, j) at (q*P+i)*P+j
+  };
+
+  /// @struct CircuitPlan
+  /// @brief Circuit lowered into static and frequency-dependent stamps
+  /// @details The frequency-independent components (R, Z, ideal couplers,
+  ///          constant S-parameter blocks), gmin and the port equations are
+  ///          accumulated once into the static part of the augmented matrix. At
+  ///          each frequency, only the dynamic stamps are added onto a copy of
+  ///          it.
+  struct CircuitPlan {
+    bool valid = false;     ///< False when the circuit changed since compiled
+    bool useSparse = false; ///< Solve with the sparse solver
+    ComplexMatrix staticDense;           ///< Static augmented matrix (dense)
+    vector<Complex> staticValues;        ///< Static augmented matrix (CSC)
+    vector<int> staticStamps;  ///< Indices of the frequency-independent components
+    vector<int> dynamicStamps; ///< Indices of the frequency-dependent components
+    LadderPlan ladder;         ///< Cascade used when the circuit is a ladder
+    BatchPlan batch;           ///< Stamps for the batched dense solver
+    PoleResiduePlan poles;     ///< Pole-residue form of lumped circuits
+  };
+
+  /// @enum IncrementalMode
+  /// @brief How a sweep uses the stored nodal impedance matrices
+  enum class IncrementalMode {
+    NONE,    ///< Regular sweep
+    CAPTURE, ///< Regular sweep that stores the nodal impedance matrices
+    UPDATE   ///< Low-rank update of the stored matrices
+  };
+
+  /// @struct IncrementalBase
+  /// @brief Previous sweep, used to re-simulate value-only edits
+  /// @details Z holds, at each frequency, the inverse of the nodal matrix
+  ///          with the port admittances on the port nodes. When only some
+  ///          component values change, the new S-parameters follow from Z with
+  ///          a Sherman-Morrison-Woodbury correction whose rank is the number
+  ///          of nodes of the modified components.
+  struct IncrementalBase {
+    vector<Component_SPAR> components; ///< Circuit of the previous sweep
+    vector<Port> ports;                ///< Ports of the previous sweep
+    int numNodes = 0;
+    vector<double> frequencies;        ///< Frequency grid
+    vector<ComplexMatrix> Z;           ///< Nodal impedance matrices (optional)
+    vector<int> changed;    ///< Modified components (set for an update)
+    vector<int> localNodes; ///< Node indices of the modified components
+  };
+
+  CircuitPlan plan;                     ///< Compiled circuit
+  SolverContext solverContext;          ///< Context of the calling thread
+  vector<pair<int, int>> sparsePattern; ///< Pattern used in the last analysis
+  int sparseThreshold = 32; ///< Minimum system size to use the sparse solver
+  int numThreads = 0;       ///< Sweep worker threads (0: one per core)
+  bool batchedSweep = true; ///< Solve several frequencies at once if possible
+  bool poleResidueSweep = true; ///< Sweep lumped circuits from their poles
+  bool incrementalSweep = true; ///< Re-simulate value-only edits incrementally
+  IncrementalBase incremental;  ///< Previous sweep
+  bool adaptiveSweep = false;   ///< Solve only the points the models need
+  double adaptiveTolerance = 1e-4; ///< Largest error of the models in S
+  size_t solvedPoints = 0;      ///< Frequencies solved by the last sweep
+  bool stageTiming = false;     ///< Measure the stage times
+  StageTimes stageTimes;        ///< Stage times since setStageTiming()
+
+  /// @brief Key of the microstrip model cache: MicrostripModelKind followed by
+  /// the geometry and substrate parameters the model depends on
+  using MicrostripModelKey = array<double, 6>;
+
+  /// @enum MicrostripModelKind
+  /// @brief Static model families stored in the cache
+  enum MicrostripModelKind { MS_LINE_MODEL, MS_COUPLED_MODEL, MS_VIA_MODEL };
+
+  /// @brief Static microstrip models by geometry. Kept between sweeps and
+  /// netlists, so tuning a design does not recompute them
+  map<MicrostripModelKey, shared_ptr<const MicrostripStaticModel>>
+      microstripModels;
+
+  /// @struct MicrostripSweep
+  /// @brief Propagation constants of a microstrip component over the sweep
+  /// @details Index 0 holds the line (or the even mode), index 1 the odd mode
+  struct MicrostripSweep {
+    vector<double> alpha[2]; ///< Attenuation constant (Np/m)
+    vector<double> beta[2];  ///< Phase constant (rad/m)
+    vector<double> zl[2];    ///< Characteristic impedance (Ω)
+  };
+
+  /// @brief Microstrip propagation tables of the sweep in progress, indexed by
+  /// component. Empty outside calculateSParameterSweep()
+  vector<MicrostripSweep> microstripSweep;
+
+  /// @brief Subcircuits of the netlist, in definition order
+  vector<shared_ptr<Subcircuit>> subcircuits;
+
+  /// @brief Subcircuit definitions by text. Kept between netlists, so the
+  /// port admittance matrices of unchanged definitions are reused
+  map<string, shared_ptr<Subcircuit>> subcircuitCache;
+  const atomic<bool> *cancelFlag = nullptr; ///< Set to stop the sweep
+  bool cancelled = false; ///< The last sweep was stopped by cancelFlag
+
+  /// @brief Returns true if the sweep in progress must be stopped
+  bool cancelRequested() const {
+    return cancelFlag && cancelFlag->load(memory_order_relaxed);
+  }
+
+  /// @brief Returns the (row, col) positions of the augmented nodal matrix
+  /// that can be nonzero
+  /// @details Each component may couple all its nodes, plus the diagonal
+  ///          entries and the port equations.
+  vector<pair<int, int>> getNodalPattern() const;
+
+  /// @brief Checks that all the ports are connected to existing nodes
+  /// @throws runtime_error if a port node is out of bounds
+  void checkPorts() const;
+
+  /// @brief Selects the sparse solver if the system is large enough
+  /// @details The symbolic analysis is stored in solverContext and it is only
+  ///          repeated when the sparsity pattern changes, so it is performed
+  ///          once per netlist.
+  /// @return true if the sparse solver must be used
+  bool prepareSparseSolver();
+
+  /// @brief Lowers the components into the circuit plan
+  /// @details Called after parsing the netlist, and lazily whenever the circuit
+  ///          was modified since the last compilation.
+  /// @throws runtime_error if a port node is out of bounds
+  void compileCircuit();
+
+  /// @brief Stamps the frequency-independent components, gmin and the port
+  /// equations into the static part of the plan
+  void stampStaticPlan();
+
+  /// @brief Updates the plan after the component parameters (params) change
+  /// in place, keeping the topology
+  /// @details The static matrix, the batched stamps and the microstrip models
+  ///          are rebuilt, and the pole-residue form is discarded. The
+  ///          symbolic analysis of the sparse solver and the ladder
+  ///          decomposition only depend on the topology, so they are kept.
+  void updateCircuitValues();
+
+  /// @brief Detects whether the circuit is a 2-port ladder
+  /// @details A ladder is a chain of series branches from the port 1 node to
+  ///          the port 2 node, with shunt branches from the chain nodes to
+  ///          ground. Only R, L, C, Z, stubs and ideal transmission lines are
+  ///          accepted. The result is stored in plan.ladder.
+  void analyzeLadder();
+
+  /// @brief Calculates the S-parameters of a ladder by cascading the ABCD
+  /// matrices of its sections. The cost is linear in the number of sections
+  /// @param freq Analysis frequency (Hz)
+  /// @param S Output 2x2 S-parameter matrix
+  /// @return false if a section is degenerate at this frequency (open series
+  ///         branch, resonant line). S is not modified in that case
+  bool solveLadder(double freq, vector<vector<Complex>>& S);
+
+  /// @brief Checks whether the circuit can be solved by the batched dense
+  /// solver and lowers its dynamic stamps. The result is stored in plan.batch
+  /// @details Only dense systems whose frequency-dependent components are
+  ///          capacitors, inductors, stubs and ideal transmission lines are
+  ///          batched.
+  void analyzeBatch();
+
+  /// @brief Solves the nodal equations at up to SWEEP_BATCH
+  /// frequencies at once
+  /// @param freq Analysis frequencies (Hz)
+  /// @param count Number of frequencies (1 to SWEEP_BATCH)
+  /// @param ctx Solver context of the calling thread
+  /// @param S Output S-parameter matrices, one per frequency
+  /// @param done On return, done[l] is true if frequency l was solved
+  /// @details The matrices are stored in structure-of-arrays form with the
+  ///          frequencies as the innermost (vectorizable) dimension. The
+  ///          elimination does not pivot across rows. A frequency whose
+  ///          pivot is too small relative to its column is left unsolved, and
+  ///          the caller solves it with solveSParameters().
+  void solveSParameterBlock(const double* freq, int count, SolverContext& ctx,
+                            vector<vector<Complex>>* S, bool* done);
+
+  /// @brief Checks whether the circuit is made of R, L and C only. The result
+  /// is stored in plan.poles.eligible
+  void analyzePoleResidue();
+
+  /// @brief Computes the pole-residue form of a lumped circuit
+  /// @param freqs Frequencies of the sweep (Hz). They set the expansion
+  /// point and the frequencies where the form is checked
+  /// @details The pencil is shifted to a real point s0 in the band, where
+  ///          K = G + s0*C is never singular for a passive circuit. The
+  ///          nonzero eigenvalues lambda_k of K^-1 * C give the poles
+  ///          p_k = s0 - 1/lambda_k. The null eigenvalues (poles at infinity)
+  ///          are usually defective, so they are split from the rest in the
+  ///          Schur form before computing the eigenvectors. The form is
+  ///          compared with the nodal solution at three frequencies. If it is
+  ///          not accurate, plan.poles.failed is set and the regular solvers
+  ///          are used.
+  void buildPoleResidue(const vector<double>& freqs);
+
+  /// @brief Evaluates the pole-residue form
+  /// @param freq Analysis frequency (Hz)
+  /// @param S Output S-matrix, stored by rows
+  /// @return false if the frequency falls on a pole
+  bool evaluatePoleResidue(double freq, Complex* S) const;
+
+  /// @brief Returns true if a sweep of these frequencies is solved with the
+  /// pole-residue form, building it if needed
+  bool usePoleResidue(const vector<double>& freqs);
+
+  /// @brief Solves the S-parameters at a list of frequencies
+  /// @param freqs Frequencies (Hz)
+  /// @param result S-matrices of the frequencies (sized by the caller). The
+  /// points solved are marked in it
+  /// @param errors Error message of the frequencies not solved
+  /// @param useIncremental Allows the incremental update of a previous sweep
+  /// @return false if the sweep was cancelled
+  bool solveSweep(const vector<double>& freqs, SweepResult& result,
+                  vector<string>& errors, bool useIncremental);
+
+  /// @brief Solves a sweep by adaptive sampling
+  /// @details A few evenly spaced points are solved first. Then, two points
+  ///          of every interval between solved points are solved and compared
+  ///          with the prediction of local rational models (Stoer-Bulirsch,
+  ///          ADAPTIVE_MODEL_POINTS solved points around it). Intervals where
+  ///          they disagree by more than adaptiveTolerance, where the models
+  ///          around neighbouring groups of points disagree, or whose
+  ///          predictions change as more points are solved, are split in three
+  ///          and refined again. Once half of the grid is solved, the points
+  ///          left in open intervals are solved directly. The rest of the grid
+  ///          is evaluated from the models. Grids that are short or not in
+  ///          ascending order are solved point by point.
+  /// @param freqs Frequencies (Hz)
+  /// @param result S-matrices of the frequencies (sized by the caller)
+  /// @param errors Error message of the frequencies not solved
+  /// @return false if the sweep was cancelled
+  bool solveAdaptiveSweep(const vector<double>& freqs, SweepResult& result,
+                          vector<string>& errors);
+
+  /// @brief Runs a sweep job split in contiguous blocks of points, one per
+  /// worker thread
+  /// @param n Number of points
+  /// @param job Function solving the points [first, last) with a context
+  void runSweepWorkers(int n,
+                       const function<void(int, int, SolverContext&)>& job);
+
+  /// @brief Moves the stage times of a worker context into stageTimes
+  void addStageTimes(SolverContext& ctx);
+
+  /// @brief Returns the start time of a stage. The clock is only read if
+  /// setStageTiming(true)
+  chrono::steady_clock::time_point startStage() const {
+    return stageTiming ? chrono::steady_clock::now()
+                       : chrono::steady_clock::time_point();
+  }
+
+  /// @brief Adds the time elapsed since start to a stage and restarts the
+  /// clock. Does nothing unless setStageTiming(true)
+  void lapStage(double& stage, chrono::steady_clock::time_point& start) const {
+    if (stageTiming) {
+      chrono::steady_clock::time_point now = chrono::steady_clock::now();
+      stage += chrono::duration<double, milli>(now - start).count();
+      start = now;
+    }
+  }
+
+  /// @brief Compares the circuit with the previous sweep and selects how the
+  /// new sweep is computed
+  /// @details If the topology, ports and frequency grid are unchanged and the
+  ///          nodal impedance matrices are stored, the sweep is an update.
+  ///          When a small value-only edit of the previous sweep is
+  ///          detected, the sweep stores the matrices so that the next edits
+  ///          are updates. A repeated sweep or an edit of most of the nodes
+  ///          does not store them.
+  IncrementalMode prepareIncrementalSweep();
+
+  /// @brief Records the swept circuit for the next call to
+  /// prepareIncrementalSweep()
+  void finishIncrementalSweep(IncrementalMode mode);
+
+  /// @brief Returns true if the components have the same types and nodes as
+  /// the previous sweep
+  bool sameTopology(const IncrementalBase& base) const;
+
+  /// @brief Returns true if two components have the same parameters
+  static bool sameValues(const Component_SPAR& a, const Component_SPAR& b);
+
+  /// @brief Solves one point of the sweep and stores its nodal impedance
+  /// matrix
+  /// @param index Point index
+  /// @param freq Analysis frequency (Hz)
+  /// @param ctx Solver context of the calling thread
+  /// @param S Output S-parameter matrix
+  void captureNodalImpedance(int index, double freq, SolverContext& ctx,
+                             vector<vector<Complex>>& S);
+
+  /// @brief Updates the S-parameters of one point from its stored nodal
+  /// impedance matrix
+  /// @param index Point index
+  /// @param freq Analysis frequency (Hz)
+  /// @param ctx Solver context of the calling thread
+  /// @param S Output S-parameter matrix
+  /// @throws runtime_error if the matrix of this point is not stored or the
+  ///         update is singular, too large or ill-conditioned (the point is
+  ///         then solved directly)
+  void updateSParameters(int index, double freq, SolverContext& ctx,
+                         vector<vector<Complex>>& S);
+
+  /// @brief Solves the augmented nodal equations at one frequency
+  /// @param freq Analysis frequency (Hz)
+  /// @param ctx Solver context of the calling thread
+  /// @param S Output S-parameter matrix. It must be numPorts x numPorts
+  /// @note The circuit must have been compiled (see compileCircuit())
+  void solveSParameters(double freq, SolverContext& ctx,
+                        vector<vector<Complex>>& S);
 
   /// @brief Adds coupled transmission line to admittance matrix
   /// @param Y Reference to circuit admittance matrix
   /// @param comp Component containing coupled line parameters (Z0e, Z0o, length)
-  void addCoupledLineToAdmittance(vector<vector<Complex>>& Y,
-                                  const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addCoupledLineToAdmittance(NodalMatrix& Y,
+                                  const Component_SPAR& comp, double freq);
 
   /// @brief Calculates Y-matrix for coupled transmission lines
   /// @param Z0e Even-mode characteristic impedance (Ω)
@@ -173,15 +812,17 @@ private:
   /// @param length Physical length of coupled section (m)
   /// @param freq Operating frequency (Hz)
   /// @return 4×4 complex Y-parameter matrix for coupled line
-  vector<vector<Complex>> calculateCoupledLineYMatrix(double Z0e, double Z0o,
-                                                      double length,
-                                                      double freq);
+  array<array<Complex, 4>, 4> calculateCoupledLineYMatrix(double Z0e,
+                                                          double Z0o,
+                                                          double length,
+                                                          double freq);
 
   /// @brief Adds ideal directional coupler to admittance matrix
   /// @param Y Reference to circuit admittance matrix
   /// @param comp Component containing coupler parameters (k, phase, Z0)
-  void addIdealCouplerToAdmittance(vector<vector<Complex>>& Y,
-                                   const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addIdealCouplerToAdmittance(NodalMatrix& Y,
+                                   const Component_SPAR& comp, double freq);
 
   /// @brief Calculates Y-matrix for ideal coupler with coupling coefficient and phase
   /// @param k Linear coupling coefficient (0 to 1, where k²=coupled power fraction)
@@ -195,8 +836,9 @@ private:
   /// @brief Adds ideal transmission line to admittance matrix
   /// @param Y Reference to circuit admittance matrix
   /// @param comp Component containing line parameters (Z0, length)
-  void addTransmissionLineToAdmittance(vector<vector<Complex>>& Y,
-                                       const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addTransmissionLineToAdmittance(NodalMatrix& Y,
+                                       const Component_SPAR& comp, double freq);
 
   /// @brief Interpolates S-matrix from frequency-dependent data
   /// @param comp Component containing S-parameter data
@@ -206,6 +848,20 @@ private:
   vector<vector<Complex>>
   interpolateFrequencyDependentSMatrix(const Component_SPAR& comp, double freq);
 
+  /// @brief Interpolates the S-matrix of a table at a given frequency
+  /// @param table S-parameter table
+  /// @param freq Target frequency (Hz)
+  /// @param[out] S Interpolated matrix, table.size * table.size entries
+  /// @param admittance Interpolate the Y-matrices instead (table.Y must not be
+  ///        empty)
+  /// @return Index of the sample used if freq falls on a sample or outside the
+  ///         data range, -1 if it was interpolated
+  /// @details The sample interval is found by binary search. Outside the data
+  ///          range the nearest sample is used (no extrapolation).
+  static int interpolateSParameterTable(const SParameterTable& table,
+                                        double freq, Complex* S,
+                                        bool admittance = false);
+
   /// @brief Extracts S-matrix at specific frequency index
   /// @param comp Component containing frequency-dependent S-parameter data
   /// @param freqIndex Index into frequency array
@@ -218,50 +874,188 @@ private:
   /// @brief Adds frequency-dependent S-parameter block to admittance matrix
   /// @param Y Reference to circuit admittance matrix
   /// @param comp Component with S-parameter data (multiple frequency points)
-  /// @details Interpolates S-parameters at current analysis frequency from
+  /// @param freq Analysis frequency (Hz)
+  /// @details Interpolates S-parameters at the analysis frequency from
   /// S-parameter data,
-  void addFrequencyDependentSParamBlockToAdmittance(vector<vector<Complex>>& Y,
-                                                    const Component_SPAR& comp);
+  void addFrequencyDependentSParamBlockToAdmittance(NodalMatrix& Y,
+                                                    const Component_SPAR& comp,
+                                                    double freq);
 
   /// @brief Parses inline S-matrix from netlist string format
-  /// @param matrixStr String containing S-parameters in format: (re,im) (re,im); ...
+  /// @param matrix String containing S-parameters in format: (re,im) (re,im); ...
   /// @param numPorts Number of ports
   /// @return S-parameter matrix extracted from string
-  vector<vector<Complex>> parseInlineSMatrix(const QString& matrixStr,
-                                             int numPorts);
+  vector<vector<Complex>> parseInlineSMatrix(string_view matrix, int numPorts);
 
   /// @brief Adds one-port S-parameter device to admittance matrix
   /// @param Y Reference to circuit admittance matrix
   /// @param comp Component containing single S11 parameter
-  void addOnePortSParamToAdmittance(vector<vector<Complex>>& Y,
-                                    const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addOnePortSParamToAdmittance(NodalMatrix& Y,
+                                    const Component_SPAR& comp, double freq);
 
   /// @brief Adds two-port S-parameter device to admittance matrix
   /// @param Y Reference to circuit admittance matrix
   /// @param comp Component containing 2×2 S-parameter matrix
-  void addTwoPortSParamToAdmittance(vector<vector<Complex>>& Y,
-                                    const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addTwoPortSParamToAdmittance(NodalMatrix& Y,
+                                    const Component_SPAR& comp, double freq);
+
+  /// @brief Y-parameters of a 2-port from its S-parameters (closed form)
+  /// @param S11, S12, S21, S22 S-parameters
+  /// @param Z0 Reference impedance (Ω)
+  /// @param[out] Y Y11, Y12, Y21, Y22
+  /// @return False if I+S is singular
+  static bool twoPortSToY(Complex S11, Complex S12, Complex S21, Complex S22,
+                          double Z0, Complex* Y);
+
+  /// @brief Stamps the Y-parameters of a 2-port (both ports grounded)
+  /// @param Y Reference to circuit admittance matrix
+  /// @param node1, node2 Port 1 and port 2 nodes
+  /// @param Yp Y11, Y12, Y21, Y22
+  void stampTwoPortY(NodalMatrix& Y, int node1, int node2, const Complex* Yp);
+
+  /// @brief Y-parameters of an N-port from its S-parameters
+  /// @param S S-matrix, row-major (N x N)
+  /// @param N Number of ports
+  /// @param Z0 Reference impedance (Ω)
+  /// @param[out] Y Y-matrix, row-major (N x N)
+  /// @return False if I+S is singular
+  /// @details Y = G0 * inv(I + S) * (I - S), solved with luFactorize(). 2-ports
+  ///          use the closed form of twoPortSToY()
+  static bool nPortSToY(const Complex* S, int N, double Z0, Complex* Y);
+
+  /// @brief Stamps the Y-parameters of an N-port whose ports are referred to
+  /// ground
+  /// @param Y Reference to circuit admittance matrix
+  /// @param nodes Port nodes. Ports on node 0 are shorted
+  /// @param Yp Y-matrix, row-major
+  void stampNPortY(NodalMatrix& Y, const vector<int>& nodes, const Complex* Yp);
+
+  /// @brief Stamps an N-port S-parameter device (N > 2), ports referred to
+  /// ground
+  /// @param Y Reference to circuit admittance matrix
+  /// @param nodes Port nodes
+  /// @param S S-matrix, row-major
+  /// @param Z0 Reference impedance (Ω)
+  /// @throws runtime_error if I+S is singular
+  void stampNPortSParameters(NodalMatrix& Y, const vector<int>& nodes,
+                             const Complex* S, double Z0);
+
+  /// @brief Stamps a one-port S-parameter device given its reflection
+  /// coefficient
+  /// @param Y Reference to circuit admittance matrix
+  /// @param node1, node2 Terminals of the device
+  /// @param S11 Reflection coefficient
+  /// @param Z0 Reference impedance (Ω)
+  void stampOnePortSParameters(NodalMatrix& Y, int node1, int node2,
+                               Complex S11, double Z0);
+
+  /// @brief Stamps a two-port S-parameter device given its S-matrix
+  /// @param Y Reference to circuit admittance matrix
+  /// @param node1, node2 Port 1 and port 2 nodes (both ports are grounded)
+  /// @param S11, S12, S21, S22 S-parameters
+  /// @param Z0 Reference impedance (Ω)
+  /// @details The S-to-Y conversion uses the closed-form 2x2 inverse, so no
+  ///          temporary matrices are created.
+  /// @throws runtime_error if I+S is singular
+  void stampTwoPortSParameters(NodalMatrix& Y, int node1, int node2,
+                               Complex S11, Complex S12, Complex S21,
+                               Complex S22, double Z0);
 
   /// @brief Adds S-parameter device component to circuit
   /// @param name Component identifier string
   /// @param nodes Vector of node numbers for connections
   /// @param Smatrix S-parameter matrix (frequency-independent)
-  /// @param numRFPorts Number of RF ports (1, 2, 3, or 4)
+  /// @param numRFPorts Number of RF ports
   /// @param Z0 Reference impedance for S-parameters (typically 50Ω)
   void addSParameterDevice(const string& name, const vector<int>& nodes,
                            const vector<vector<Complex>>& Smatrix,
                            int numRFPorts, double Z0);
 
+  ///////////////////////////////////////////////////////////////////////////////////////////////////////
+  // Microstrip static models
+
+  /// @brief Sets the static models of the microstrip components
+  /// @details Called by compileCircuit(). Components with the same geometry
+  ///          share the same model.
+  void bindMicrostripModels();
+
+  /// @brief Sets the static models of a microstrip component
+  void bindMicrostripModel(Component_SPAR& comp);
+
+  /// @brief Returns the static model of a geometry from the cache, computing
+  /// it if needed
+  shared_ptr<const MicrostripStaticModel>
+  getMicrostripModel(const MicrostripModelKey& key);
+
+  /// @brief Quasi-static analysis of a microstrip line (Hammerstad)
+  MicrostripStaticModel analyseMicrostripLine(double W, double h, double er,
+                                              double t);
+
+  /// @brief Quasi-static analysis of microstrip coupled lines (Kirschning)
+  MicrostripStaticModel analyseMicrostripCoupled(double W, double S, double h,
+                                                 double er, double t);
+
+  /// @brief DC resistance and inductance of a microstrip via
+  MicrostripStaticModel analyseMicrostripVia(double D, double h, double t,
+                                             double rho);
+
+  /// @brief Evaluates the dispersion and losses of the microstrip lines over
+  /// the whole sweep (see microstripSweep)
+  /// @param freqs Sweep frequencies (Hz)
+  void prepareMicrostripSweep(const vector<double>& freqs);
+
+  /// @brief Stamps a frequency-dependent component, taking the microstrip
+  /// propagation constants from the sweep tables when available
+  /// @param Y Nodal matrix
+  /// @param index Component index
+  /// @param freq Analysis frequency (Hz)
+  /// @param point Sweep point of freq, or -1
+  void stampDynamic(NodalMatrix& Y, int index, double freq, int point);
+  ///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////////
+  // Subcircuits
+
+  /// @brief Port admittance matrix of a subcircuit
+  /// @param sub Subcircuit definition
+  /// @param freq Analysis frequency (Hz)
+  /// @param[out] Yp Port admittance matrix, row-major
+  /// @throws runtime_error if the internal nodes cannot be eliminated
+  void reduceSubcircuit(const Subcircuit& sub, double freq, Complex* Yp);
+
+  /// @brief Stamps a subcircuit instance. The port admittance matrix is taken
+  /// from the definition if it was computed for freq
+  void stampSubcircuit(NodalMatrix& Y, const Component_SPAR& comp, double freq);
+
+  /// @brief Computes the port admittance matrices of the subcircuits over the
+  /// sweep. Definitions already reduced at these frequencies are skipped
+  /// @param freqs Sweep frequencies (Hz)
+  void prepareSubcircuitSweep(const vector<double>& freqs);
+  ///////////////////////////////////////////////////////////////////////////////////////////////////////
+
   ///////////////////////////////////////////////////////////////////////////////////////////////////////
   // Microstrip line analysis methods
 
   /// @brief Adds microstrip transmission line to admittance matrix
   /// @param Y Reference to circuit admittance matrix (modified in place)
   /// @param comp Component with microstrip parameters (W, L, substrate properties)
-  void addMicrostripLineToAdmittance(vector<vector<Complex>>& Y,
-                                     const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addMicrostripLineToAdmittance(NodalMatrix& Y,
+                                     const Component_SPAR& comp, double freq);
+
+  /// @brief Stamps a microstrip line given its propagation constants
+  /// @param Y Reference to circuit admittance matrix (modified in place)
+  /// @param comp Microstrip line
+  /// @param alpha Attenuation constant (Np/m)
+  /// @param beta Phase constant (rad/m)
+  /// @param zl Characteristic impedance (Ω)
+  void stampMicrostripLine(NodalMatrix& Y, const Component_SPAR& comp,
+                           double alpha, double beta, double zl);
 
   /// @brief Calculates propagation parameters for microstrip line
+  /// @param model Static model of the line (see analyseMicrostripLine())
   /// @param W Line width (m)
   /// @param h Substrate height (m)
   /// @param er Relative permittivity (dielectric constant)
@@ -273,11 +1067,22 @@ private:
   /// @param[out] beta Phase constant (rad/m) - determines wavelength
   /// @param[out] zl Characteristic impedance (Ω) at frequency
   /// @param[out] ereff Effective relative permittivity at frequency
-  void calcMicrostripPropagation(double W, double h, double er,
-                                 double t, double tand, double rho,
+  void calcMicrostripPropagation(const MicrostripStaticModel& model, double W,
+                                 double h, double er, double t, double tand,
+                                 double rho,
                                  double frequency, double& alpha, double& beta,
                                  double& zl, double& ereff);
 
+  /// @brief Array version of calcMicrostripPropagation()
+  /// @param frequency Frequencies (Hz), n values
+  /// @param n Number of frequencies
+  /// @param[out] alpha, beta, zl, ereff Outputs, n values each
+  void calcMicrostripPropagation(const MicrostripStaticModel& model, double W,
+                                 double h, double er, double t, double tand,
+                                 double rho, const double* frequency, int n,
+                                 double* alpha, double* beta, double* zl,
+                                 double* ereff);
+
   /// @brief Analyzes quasi-static microstrip parameters
   /// @param W Line width (m)
   /// @param h Substrate height (m)
@@ -305,6 +1110,14 @@ private:
                          double ErEff, double frequency, const string& Model,
                          double& ZlEffFreq, double& ErEffFreq);
 
+  /// @brief Array version of analyseDispersion() (Kirschning model)
+  /// @param frequency Frequencies (Hz), n values
+  /// @param n Number of frequencies
+  /// @param[out] ZlEffFreq, ErEffFreq Outputs, n values each
+  void analyseDispersion(double W, double h, double er, double ZlEff,
+                         double ErEff, const double* frequency, int n,
+                         double* ZlEffFreq, double* ErEffFreq);
+
   /// @brief Analyzes conductor and dielectric losses in microstrip (α = αc + αd)
   /// @param W Line width (m)
   /// @param t Metal thickness (m)
@@ -324,6 +1137,14 @@ private:
                    double frequency, const string& Model, double& ac,
                    double& ad);
 
+  /// @brief Array version of analyseLoss() (Hammerstad model)
+  /// @param frequency Frequencies (Hz), n values
+  /// @param n Number of frequencies
+  /// @param[out] ac, ad Outputs, n values each
+  void analyseLoss(double W, double t, double er, double rho, double D,
+                   double tand, double ZlEff1, double ZlEff2, double ErEff,
+                   const double* frequency, int n, double* ac, double* ad);
+
   // Helper functions for microstrip calculations
   /// @brief Hammerstad and Jensen parameters for microstrip analysis
   /// @param u Normalized width W/h
@@ -353,6 +1174,13 @@ private:
   /// @param[out] ErEffFreq Frequency-dependent effective permittivity
   void Kirschning_er(double u, double fn, double er, double ErEff, double& ErEffFreq);
 
+  /// @brief Array version of Kirschning_er()
+  /// @param fn Normalized frequencies, n values
+  /// @param n Number of frequencies
+  /// @param[out] ErEffFreq Outputs, n values
+  void Kirschning_er(double u, const double* fn, int n, double er, double ErEff,
+                     double* ErEffFreq);
+
   /// @brief Kirschning-Jansen dispersion model for characteristic impedance
   /// @param ErEff DC effective permittivity
   /// @param ErEffFreq Frequency-dependent effective permittivity
@@ -361,6 +1189,13 @@ private:
   /// @param[out] ZlEffFreq Frequency-dependent characteristic impedance (Ω)
   void Kirschning_zl(double ErEff, double ErEffFreq, double ZlEff, double& r17, double& ZlEffFreq);
 
+  /// @brief Array version of Kirschning_zl()
+  /// @param ErEffFreq Frequency-dependent effective permittivity, n values
+  /// @param n Number of frequencies
+  /// @param[out] ZlEffFreq Outputs, n values
+  void Kirschning_zl(double ErEff, const double* ErEffFreq, int n, double ZlEff,
+                     double* ZlEffFreq);
+
   ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
   ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -368,12 +1203,15 @@ private:
   /// @brief Adds microstrip impedance step to admittance matrix
   /// @param Y Reference to circuit admittance matrix (modified in place)
   /// @param comp Component with step parameters (W1, W2, substrate properties)
-  void addMicrostripStepToAdmittance(vector<vector<Complex>>& Y,
-                                     const Component_SPAR& comp);
-  void calcMicrostripStepZ(double W1, double W2, double h, double er, double t,
-                           double frequency, const string& SModel,
-                           const string& DModel, Complex& z11, Complex& z12,
-                           Complex& z21, Complex& z22);
+  /// @param freq Analysis frequency (Hz)
+  void addMicrostripStepToAdmittance(NodalMatrix& Y,
+                                     const Component_SPAR& comp, double freq);
+  void calcMicrostripStepZ(const MicrostripStaticModel& model1,
+                           const MicrostripStaticModel& model2, double W1,
+                           double W2, double h, double er, double frequency,
+                           const string& DModel,
+                           Complex& z11, Complex& z12, Complex& z21,
+                           Complex& z22);
   ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
   ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -381,36 +1219,37 @@ private:
   /// @brief Adds microstrip open-end to admittance matrix
   /// @param Y Reference to circuit admittance matrix (modified in place)
   /// @param comp Component with open-end parameters (W, substrate properties)
-  void addMicrostripOpenToAdmittance(vector<vector<Complex>>& Y,
-                                     const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addMicrostripOpenToAdmittance(NodalMatrix& Y,
+                                     const Component_SPAR& comp, double freq);
 
   /// @brief Calculates admittance of microstrip open-end
+  /// @param model Static model of the line, with the strip thickness
+  /// correction (see analyseMicrostripLine())
   /// @param W Line width (m)
   /// @param h Substrate height (m)
   /// @param er Relative permittivity
-  /// @param t Metal thickness (m)
   /// @param frequency Operating frequency (Hz)
   /// @param Model Analysis model selector
-  /// @param SModel Quasi-static model
   /// @param DModel Dispersion model
   /// @return Complex admittance Y = jωC_end (S)
-  Complex calcMicrostripOpenY(double W, double h, double er, double t,
-                              double frequency, const string& Model,
-                              const string& SModel, const string& DModel);
+  Complex calcMicrostripOpenY(const MicrostripStaticModel& model, double W,
+                              double h, double er, double frequency,
+                              const string& Model, const string& DModel);
 
   /// @brief Calculates end-effect capacitance for microstrip open
+  /// @param model Static model of the line, with the strip thickness
+  /// correction (see analyseMicrostripLine())
   /// @param W Line width (m)
   /// @param h Substrate height (m)
   /// @param er Relative permittivity
-  /// @param t Metal thickness (m)
   /// @param frequency Operating frequency (Hz)
   /// @param Model Analysis model selector
-  /// @param SModel Quasi-static model
   /// @param DModel Dispersion model
   /// @return End capacitance C_end (F)
-  double calcMicrostripOpenCend(double W, double h, double er, double t,
-                                double frequency, const string& Model,
-                                const string& SModel, const string& DModel);
+  double calcMicrostripOpenCend(const MicrostripStaticModel& model, double W,
+                                double h, double er, double frequency,
+                                const string& Model, const string& DModel);
   ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
   ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -418,17 +1257,15 @@ private:
   /// @brief Adds microstrip via to admittance matrix
   /// @param Y Reference to circuit admittance matrix (modified in place)
   /// @param comp Component with via parameters (D, h, substrate properties)
-  void addMicrostripViaToAdmittance(vector<vector<Complex>>& Y,
-                                    const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addMicrostripViaToAdmittance(NodalMatrix& Y,
+                                    const Component_SPAR& comp, double freq);
 
   /// @brief Calculates impedance of microstrip via
-  /// @param D Via diameter (m)
-  /// @param h Substrate height (via length, m)
-  /// @param t Metal plating thickness (m)
-  /// @param rho Metal resistivity (Ω·m)
+  /// @param model Static model of the via (see analyseMicrostripVia())
   /// @param frequency Operating frequency (Hz)
   /// @return Complex via impedance Z = R + jωL (Ω)
-  Complex calcMicrostripViaImpedance(double D, double h, double t, double rho,
+  Complex calcMicrostripViaImpedance(const MicrostripStaticModel& model,
                                      double frequency);
 
   /// @brief Calculates DC resistance of microstrip via
@@ -445,10 +1282,25 @@ private:
   /// @brief Adds microstrip coupled lines to admittance matrix
   /// @param Y Reference to circuit admittance matrix (modified in place)
   /// @param comp Component with coupled line parameters (W, S, L, substrate)
-  void addMicrostripCoupledLinesToAdmittance(vector<vector<Complex>>& Y,
-                                             const Component_SPAR& comp);
+  /// @param freq Analysis frequency (Hz)
+  void addMicrostripCoupledLinesToAdmittance(NodalMatrix& Y,
+                                             const Component_SPAR& comp,
+                                             double freq);
+
+  /// @brief Stamps microstrip coupled lines given the propagation constants
+  /// of both modes
+  /// @param Y Reference to circuit admittance matrix (modified in place)
+  /// @param comp Coupled lines
+  /// @param alpha_e, beta_e, zl_e Even-mode attenuation, phase constant and
+  ///        impedance
+  /// @param alpha_o, beta_o, zl_o Odd-mode attenuation, phase constant and
+  ///        impedance
+  void stampMicrostripCoupledLines(NodalMatrix& Y, const Component_SPAR& comp,
+                                   double alpha_e, double beta_e, double zl_e,
+                                   double alpha_o, double beta_o, double zl_o);
 
   /// @brief Calculates propagation parameters for microstrip coupled lines
+  /// @param model Static model of the lines (see analyseMicrostripCoupled())
   /// @param W Line width (m)
   /// @param S Spacing between lines (edge-to-edge, m)
   /// @param h Substrate height (m)
@@ -465,7 +1317,8 @@ private:
   /// @param[out] beta_o Odd-mode phase constant (rad/m)
   /// @param[out] zl_o Odd-mode characteristic impedance (Ω)
   /// @param[out] ereff_o Odd-mode effective permittivity
-  void calcMicrostripCoupledPropagation(double W, double S, double h,
+  void calcMicrostripCoupledPropagation(const MicrostripStaticModel& model,
+                                        double W, double S, double h,
                                         double er, double t, double tand,
                                         double rho, double frequency,
                                         double& alpha_e, double& beta_e,
@@ -473,6 +1326,17 @@ private:
                                         double& alpha_o, double& beta_o,
                                         double& zl_o, double& ereff_o);
 
+  /// @brief Array version of calcMicrostripCoupledPropagation()
+  /// @param frequency Frequencies (Hz), n values
+  /// @param n Number of frequencies
+  /// @param[out] alpha_e, beta_e, zl_e, ereff_e, alpha_o, beta_o, zl_o, ereff_o
+  ///        Outputs, n values each
+  void calcMicrostripCoupledPropagation(
+      const MicrostripStaticModel& model, double W, double S, double h,
+      double er, double t, double tand, double rho, const double* frequency,
+      int n, double* alpha_e, double* beta_e, double* zl_e, double* ereff_e,
+      double* alpha_o, double* beta_o, double* zl_o, double* ereff_o);
+
   /// @brief Analyzes quasi-static parameters for coupled microstrip lines
   /// @param W Line width (m)
   /// @param h Substrate height (m)
@@ -511,6 +1375,18 @@ private:
                                 double& ZloFreq, double& ErEffeFreq,
                                 double& ErEffoFreq);
 
+  /// @brief Array version of analyseDispersionCoupled() (Kirschning model)
+  /// @param frequency Frequencies (Hz), n values
+  /// @param n Number of frequencies
+  /// @param[out] ZleFreq, ZloFreq, ErEffeFreq, ErEffoFreq Outputs, n values
+  ///        each
+  void analyseDispersionCoupled(double W, double h, double s, double t,
+                                double er, double Zle, double Zlo,
+                                double ErEffe, double ErEffo,
+                                const double* frequency, int n,
+                                double* ZleFreq, double* ZloFreq,
+                                double* ErEffeFreq, double* ErEffoFreq);
+
   /// @brief Analyzes losses for coupled microstrip lines (even or odd mode)
   /// @param W Line width (m)
   /// @param t Metal thickness (m)
@@ -533,13 +1409,10 @@ private:
   ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
   // Frequency sweep parameters
-  double f_start = 1e6;   ///< Frequency sweep start (Hz)
-  double f_stop = 1e9;    ///< Frequency sweep stop (Hz)
-  int n_points = 20;      ///< Number of frequency points
+  vector<double> sweepFrequencies; ///< Frequency grid of the sweep (Hz)
 
   // Simulation data
-  std::vector<std::vector<std::vector<Complex>>> sweepResults; ///< Stored S-parameter sweep data
-  QMap<QString, QList<double>> data; ///< Formatted sweep results for export
+  SweepResult sweepResult; ///< S-matrices of the last sweep
 
   /// @brief Parses value with SI prefixes and unit conversion
   /// @param input String containing numerical value with optional SI prefix (k, M, G, m, u, n, p)
@@ -548,16 +1421,38 @@ private:
   double parseScaledValue(const QString& input,
                           QString unit_type = QString(""));
 
+  /// @brief Allocation-free version of parseScaledValue() used by the netlist
+  /// parser
+  /// @param input Numerical value with optional SI prefix or length unit
+  /// @param length The unit is a length unit ("Length" unit type)
+  /// @return Numerical value in base SI units
+  static double parseScaledToken(string_view input, bool length = false);
+
+  /// @brief Parses a complex impedance in the "R±jX" format, e.g. 50-j10 or
+  /// 25Ohm+j1kOhm
+  /// @param input Impedance token
+  /// @param z Output. Not modified if the format is not valid
+  /// @return False if the format is not valid
+  static bool parseImpedanceToken(string_view input, Complex& z);
+
 public:
   /// @brief Constructor
-  SParameterCalculator() : numNodes(0), frequency(1e9) {}
+  SParameterCalculator() : numNodes(0), frequency(1e9) {
+    setFrequencySweep(1e6, 1e9, 20);
+  }
 
   /// @brief Sets netlist and parses components
   /// @param netlist Circuit netlist in custom format
   /// @return true if parsing succeeded, false otherwise
   bool setNetlist(const QString &netlist) {
     currentNetlist = netlist;
-    return parseNetlist();
+    bool ok = parseNetlist();
+    try {
+      compileCircuit();
+    } catch (const exception &e) {
+      cerr << "Error compiling the circuit: " << e.what() << endl;
+    }
+    return ok;
   }
 
   /// @brief Returns current netlist string
@@ -583,6 +1478,8 @@ public:
 
   /// @brief Calculates S-parameters at current frequency
   /// @return S-parameter matrix
+  /// @details The augmented nodal matrix is LU-factorized once and all the port
+  ///          excitations are back-substituted as a multi-RHS solve.
   vector<vector<Complex>> calculateSParameters();
 
   // SPAR Block component
@@ -591,14 +1488,21 @@ public:
                                      double Z0);
 
   /// @brief Adds S-parameter block to admittance matrix
-  void addSParamBlockToAdmittance(vector<vector<Complex>>& Y,
-                                  const Component_SPAR& comp);
+  void addSParamBlockToAdmittance(NodalMatrix& Y,
+                                  const Component_SPAR& comp, double freq);
 
   /// @brief Adds S-parameter block component
 
   void addSParameterBlock(const string& name, const vector<int>& nodes,
                           const vector<vector<Complex>>& Smatrix);
 
+  /// @brief Converts the Touchstone data of a frequency-dependent block into
+  /// an S-parameter table
+  /// @param comp Component with freqDepData
+  /// @return Table with the S-matrices (and the Y-matrices of 2-port blocks)
+  static shared_ptr<const SParameterTable>
+  makeSParameterTable(const Component_SPAR& comp);
+
   /// @brief Prints S-parameters in readable format to console
   void printSParameters(const vector<vector<Complex>>& S);
 
@@ -610,7 +1514,9 @@ public:
   void clear(){
     components.clear();
     ports.clear();
+    subcircuits.clear();
     numNodes = 0;
+    plan.valid = false;
   }
 
   // Getter methods
@@ -627,18 +1533,165 @@ public:
   double getFrequency() const { return frequency; }
 
   /// @brief Returns formatted sweep data
-  QMap<QString, QList<double>> getData() { return data; }
+  /// @details Compatibility view of getSweepResult(): the dB, angle, real and
+  ///          imaginary traces are evaluated on every call. Prefer
+  ///          SweepResult::trace() when only some traces are needed.
+  QMap<QString, QList<double>> getData() const {
+    return sweepResult.toDataMap();
+  }
 
   // Setter methods
   /// @brief Sets current analysis frequency
   void setFrequency(double freq) { frequency = freq; }
 
   /// @brief Configures frequency sweep parameters
-  void setFrequencySweep(double start, double stop, int points);
+  /// @param start Start frequency (Hz)
+  /// @param stop Stop frequency (Hz)
+  /// @param points Number of frequency points
+  /// @param logarithmic Spaces the points logarithmically (start and stop must
+  /// be positive)
+  void setFrequencySweep(double start, double stop, int points,
+                         bool logarithmic = false);
+
+  /// @brief Sets the frequencies of the sweep explicitly
+  /// @param frequencies Frequency list (Hz). The sweep is faster when it is
+  /// sorted, since the microstrip models and the subcircuits are then
+  /// evaluated once for the whole grid
+  void setFrequencyList(const vector<double>& frequencies) {
+    sweepFrequencies = frequencies;
+  }
+
+  /// @brief Returns the frequencies of the sweep (Hz)
+  const vector<double>& getSweepFrequencies() const {
+    return sweepFrequencies;
+  }
+
+  /// @brief Returns the S-matrices of the last sweep. Points that could not
+  /// be solved hold a zero matrix
+  const SweepResult& getSweepResult() const { return sweepResult; }
+
+  /// @brief Returns the reference impedance of a port
+  /// @param index Port index (0-based)
+  double getPortImpedance(int index) const { return ports.at(index).impedance; }
+
+  /// @brief Sets the minimum size of the augmented nodal system that is solved
+  /// with the sparse solver. Smaller systems use the dense LU factorization
+  void setSparseSolverThreshold(int systemSize) {
+    sparseThreshold = systemSize;
+    plan.valid = false;
+  }
+
+  /// @brief Sets the number of threads used by the frequency sweep
+  /// @param threads Number of worker threads. 0 uses one thread per core
+  void setNumThreads(int threads) { numThreads = max(threads, 0); }
+
+  /// @brief Returns the number of threads used by the frequency sweep
+  int getNumThreads() const;
+
+  /// @brief Enables the batched dense solver in frequency sweeps
+  /// @details Small circuits built from R, L, C, Z, stubs and ideal lines are
+  ///          solved SWEEP_BATCH frequencies at a time. It is enabled by
+  ///          default.
+  void setBatchedSweep(bool enable) {
+    batchedSweep = enable;
+    plan.valid = false;
+  }
+
+  /// @brief Enables the pole-residue sweep of lumped circuits
+  /// @details Circuits made of R, L and C only are reduced once to their
+  ///          poles and residues, and every frequency is then evaluated
+  ///          without solving the nodal equations. It is enabled by default.
+  void setPoleResidueSweep(bool enable) {
+    poleResidueSweep = enable;
+    plan.valid = false;
+  }
+
+  /// @brief Enables the incremental re-simulation of value-only edits
+  /// @details When the netlist changes only in component values (e.g. while
+  ///          tuning a filter), the sweep updates the nodal impedance matrices
+  ///          of a previous sweep instead of solving the circuit again. It is
+  ///          enabled by default.
+  void setIncrementalSweep(bool enable) {
+    incrementalSweep = enable;
+    incremental = IncrementalBase();
+  }
+
+  /// @brief Enables the adaptive frequency sampling
+  /// @details Only the frequencies needed to model the response are solved
+  ///          and the rest of the grid is filled by rational interpolation.
+  ///          Sharp resonances and notches are resolved with a few dozen
+  ///          solves instead of a dense grid. The incremental re-simulation
+  ///          is not used in this mode. It is disabled by default.
+  /// @param enable Enables the adaptive sampling
+  /// @param tolerance Largest difference allowed between the models and the
+  /// solved S-parameters
+  void setAdaptiveSweep(bool enable, double tolerance = 1e-4) {
+    adaptiveSweep = enable;
+    adaptiveTolerance = tolerance;
+  }
+
+  /// @brief Returns the number of frequencies solved by the last sweep. With
+  /// the adaptive sampling, it is usually much lower than the grid size
+  size_t getSolvedPoints() const { return solvedPoints; }
+
+  /// @brief Measures the time spent in each stage of the engine
+  /// @details The times are accumulated over the netlists and sweeps run
+  ///          after this call, which resets them.
+  void setStageTiming(bool enable) {
+    stageTiming = enable;
+    stageTimes = StageTimes();
+  }
+
+  /// @brief Returns the stage times measured since setStageTiming(true)
+  const StageTimes& getStageTimes() const { return stageTimes; }
+
+  /// @brief Returns the solver used by the sweeps of the compiled circuit:
+  /// "pole-residue" (once built by a sweep), "ladder", "batched", "sparse" or
+  /// "dense"
+  const char* getSweepSolver() const;
+
+  /// @brief Sets a flag that stops the sweep in progress when it becomes true
+  /// @details The flag is polled by the sweep workers between frequency
+  ///          blocks, so it can be set from another thread. A stopped sweep
+  ///          leaves no data (see wasCancelled()). nullptr disables it.
+  void setCancelFlag(const atomic<bool> *flag) { cancelFlag = flag; }
+
+  /// @brief Returns true if the last sweep was stopped by the cancel flag
+  bool wasCancelled() const { return cancelled; }
+
+  /// @brief Discards the cached microstrip models
+  /// @details The cache is keyed by geometry, so it never returns a stale
+  ///          model. It is cleared when the substrate changes to release the
+  ///          models of the old substrate.
+  void clearMicrostripModels() { microstripModels.clear(); }
 
   /// @brief Performs S-parameter calculation over frequency sweep
+  /// @details The frequency grid is split in contiguous blocks that are solved
+  ///          concurrently. The results are stored in frequency order and do
+  ///          not depend on the thread scheduling.
   void calculateSParameterSweep();
 
+  /// @brief Performs the frequency sweep and passes each point to a sink
+  /// @details The sweep is solved SWEEP_CHUNK points at a time and the points
+  ///          are passed in frequency order, so the memory used does not grow
+  ///          with the number of points. Nothing is stored in the calculator
+  ///          (getData() and getSweepResult() are left empty).
+  /// @param sink Receiver of the results, e.g. a SweepWriter
+  void calculateSParameterSweep(SweepSink& sink);
+
+  /// @brief Monte Carlo tolerance analysis over the frequency sweep
+  /// @details Each trial draws the component values from their tolerances and
+  ///          solves the sweep. The circuit is compiled once: the trials only
+  ///          update the values of the plan. The trials run on
+  ///          getNumThreads() threads and their draws depend only on the seed
+  ///          and the trial number, so the results do not depend on the
+  ///          number of threads. The circuit itself is not modified.
+  /// @param settings Tolerances, limits and envelopes
+  /// @param result Output. Yield and envelopes
+  /// @return false if the circuit cannot be simulated or the run was cancelled
+  bool runMonteCarlo(const MonteCarloSettings& settings,
+                     MonteCarloResult& result);
+
   /// @brief Prints all S-parameters from stored sweep
   void printSParameterSweep() const;
 
@@ -650,6 +1703,28 @@ private:
   /// the circuit
   /// @return true if parsing succeeded, false on error
   bool parseNetlist();
+
+  /// @brief Parses a SPAR line (S-parameter file or inline S-matrix)
+  /// @param line Netlist line
+  /// @param tokens Fields of the line
+  void parseSParameterBlock(string_view line,
+                            const vector<string_view> &tokens);
+
+  /// @brief Parses the netlist lines into the circuit. Subcircuit definitions
+  /// are skipped
+  /// @param text Netlist lines
+  void parseNetlistLines(string_view text);
+
+  /// @brief Parses the subcircuit definitions (.SUBCKT ... .ENDS) of the
+  /// netlist into subcircuits
+  /// @param text Netlist
+  void parseSubcircuits(string_view text);
+
+  /// @brief Parses a subcircuit instance: X1 node1 ... nodeN name
+  /// @param line Netlist line
+  /// @param tokens Fields of the line
+  void parseSubcircuitInstance(string_view line,
+                               const vector<string_view> &tokens);
 };
 
 #endif // SPARAMETERCALCULATOR_H
@@ -8,7 +8,7 @@
 
 #include "./../SParameterCalculator.h"
 
-vector<vector<Complex>>
+array<array<Complex, 4>, 4>
 SParameterCalculator::calculateCoupledLineYMatrix(double Z0e, double Z0o,
                                                   double length, double freq) {
   const double c = 299792458.0; // speed of light in m/s
@@ -27,7 +27,7 @@ SParameterCalculator::calculateCoupledLineYMatrix(double Z0e, double Z0o,
   // Handle the case where sin(theta) is very small
   if (abs(sinT) < 1e-12) {
     // Return zero matrix for resonant lengths
-    return createMatrix(4, 4);
+    return {};
   }
 
   // Calculate Y-parameters for coupled line using even/odd mode analysis
@@ -37,7 +37,7 @@ SParameterCalculator::calculateCoupledLineYMatrix(double Z0e, double Z0o,
   // [Y31  Y32  Y33  Y34]
   // [Y41  Y42  Y43  Y44]
 
-  vector<vector<Complex>> Y = createMatrix(4, 4);
+  array<array<Complex, 4>, 4> Y;
 
   // Self admittances (diagonal terms)
   Complex Y11 = j * (Ye + Yo) * cosT / (2.0 * sinT);
@@ -77,19 +77,19 @@ SParameterCalculator::calculateCoupledLineYMatrix(double Z0e, double Z0o,
 }
 
 void SParameterCalculator::addCoupledLineToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
   if (comp.nodes.size() != 4) {
     cerr << "Error: Coupled line must have exactly 4 nodes" << endl;
     return;
   }
 
-  double Z0e = comp.value["Z0e"];
-  double Z0o = comp.value["Z0o"];
-  double length = comp.value["Length"];
+  double Z0e = comp.params.coupled.Z0e;
+  double Z0o = comp.params.coupled.Z0o;
+  double length = comp.params.coupled.length;
 
   // Calculate the 4x4 Y-matrix for the coupled line
-  vector<vector<Complex>> coupledY =
-      calculateCoupledLineYMatrix(Z0e, Z0o, length, frequency);
+  array<array<Complex, 4>, 4> coupledY =
+      calculateCoupledLineYMatrix(Z0e, Z0o, length, freq);
 
   // Add the coupled line Y-matrix to the global admittance matrix
   for (int i = 0; i < 4; i++) {
@@ -88,15 +88,15 @@ SParameterCalculator::calculateIdealCouplerYMatrix(double k, double phase_deg,
 }
 
 void SParameterCalculator::addIdealCouplerToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double /*freq*/) {
   if (comp.nodes.size() != 4) {
     cerr << "Error: Ideal coupler must have exactly 4 nodes" << endl;
     return;
   }
 
-  double k = comp.value["k"];                 // Linear coupling coefficient
-  double phase_deg = comp.value["phase_deg"]; // Phase shift in degrees
-  double Z0 = comp.value["Z0"];               // Characteristic impedance
+  double k = comp.params.coupler.k;                 // Linear coupling coefficient
+  double phase_deg = comp.params.coupler.phase_deg; // Phase shift in degrees
+  double Z0 = comp.params.coupler.Z0;               // Characteristic impedance
 
   // Calculate the 4x4 Y-matrix for the ideal coupler
   vector<vector<Complex>> couplerY =
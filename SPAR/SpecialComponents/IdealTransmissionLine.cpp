@@ -9,14 +9,13 @@
 #include "./../SParameterCalculator.h"
 
 void SParameterCalculator::addTransmissionLineToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
   // Extract TLIN parameters
   int node1 = comp.nodes[0];
   int node2 = comp.nodes[1];
-  double Z0 = comp.value.value("Z0");
-  double Length = comp.value.value("Length"); // mm
+  double Z0 = comp.params.line.Z0;
+  double Length = comp.params.line.length; // mm
 
-  double freq = frequency;
   double c = 299792458.0; // speed of light [m/s], assume lossless line in air
   double l_m = Length;
 
@@ -9,28 +9,38 @@
 #include "./../../SParameterCalculator.h"
 
 void SParameterCalculator::addMicrostripCoupledLinesToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
   // Extract microstrip coupled lines parameters
-  int node1 = comp.nodes[0]; // Port 1 of line 1
-  int node2 = comp.nodes[1]; // Port 2 of line 1
-  int node3 = comp.nodes[2]; // Port 1 of line 2
-  int node4 = comp.nodes[3]; // Port 2 of line 2
-
-  double W = comp.value.value("W");       // Width of each line in meters
-  double S = comp.value.value("S");       // Spacing between lines in meters
-  double L = comp.value.value("L");       // Length in meters
-  double h = comp.value.value("h");       // Substrate height in meters
-  double er = comp.value.value("er");     // Relative permittivity
-  double t = comp.value.value("th", 0.0); // Conductor thickness (optional)
-  double tand = comp.value.value("tand", 0.0); // Loss tangent (optional)
-  double rho = comp.value.value("rho", 1e-10); // Surface Resistivity (optional)
+  const MicrostripParams &ms = comp.params.microstrip;
+  double W = ms.W;       // Width of each line in meters
+  double S = ms.S;       // Spacing between lines in meters
+  double h = ms.h;       // Substrate height in meters
+  double er = ms.er;     // Relative permittivity
+  double t = ms.t;       // Conductor thickness (optional)
+  double tand = ms.tand; // Loss tangent (optional)
+  double rho = ms.rho;   // Surface Resistivity (optional)
 
   // Calculate propagation characteristics for coupled lines
   double alpha_e, beta_e, zl_e, ereff_e; // Even mode
   double alpha_o, beta_o, zl_o, ereff_o; // Odd mode
-  calcMicrostripCoupledPropagation(W, S, h, er, t, tand, rho, frequency,
+  MicrostripStaticModel model = comp.msModel[0]
+                                    ? *comp.msModel[0]
+                                    : analyseMicrostripCoupled(W, S, h, er, t);
+  calcMicrostripCoupledPropagation(model, W, S, h, er, t, tand, rho, freq,
                                    alpha_e, beta_e, zl_e, ereff_e, alpha_o,
                                    beta_o, zl_o, ereff_o);
+  stampMicrostripCoupledLines(Y, comp, alpha_e, beta_e, zl_e, alpha_o, beta_o,
+                              zl_o);
+}
+
+void SParameterCalculator::stampMicrostripCoupledLines(
+    NodalMatrix &Y, const Component_SPAR &comp, double alpha_e, double beta_e,
+    double zl_e, double alpha_o, double beta_o, double zl_o) {
+  int node1 = comp.nodes[0]; // Port 1 of line 1
+  int node2 = comp.nodes[1]; // Port 2 of line 1
+  int node3 = comp.nodes[2]; // Port 1 of line 2
+  int node4 = comp.nodes[3]; // Port 2 of line 2
+  double L = comp.params.microstrip.L; // Length in meters
 
   // Even mode calculations
   Complex gamma_e(alpha_e, beta_e);
@@ -125,21 +135,22 @@ void SParameterCalculator::addMicrostripCoupledLinesToAdmittance(
 }
 
 void SParameterCalculator::calcMicrostripCoupledPropagation(
-    double W, double S, double h, double er, double t, double tand, double rho,
-    double frequency, double &alpha_e, double &beta_e, double &zl_e,
-    double &ereff_e, double &alpha_o, double &beta_o, double &zl_o,
-    double &ereff_o) {
+    const MicrostripStaticModel &model, double W, double S, double h,
+    double er, double t, double tand, double rho, double frequency,
+    double &alpha_e, double &beta_e, double &zl_e, double &ereff_e,
+    double &alpha_o, double &beta_o, double &zl_o, double &ereff_o) {
 
-  double ZlEff_e, ErEff_e, ZlEffFreq_e, ErEffFreq_e;
-  double ZlEff_o, ErEff_o, ZlEffFreq_o, ErEffFreq_o;
+  double ZlEffFreq_e, ErEffFreq_e;
+  double ZlEffFreq_o, ErEffFreq_o;
   double ac_e, ad_e, ac_o, ad_o;
 
-  string SModel = "Kirschning"; // Default model
   string DModel = "Kirschning"; // Default dispersion model
 
-  // Calculate BOTH even and odd modes together in quasi-static analysis
-  analyseQuasiStaticCoupled(W, h, S, t, er, SModel, ZlEff_e, ZlEff_o, ErEff_e,
-                            ErEff_o);
+  // Quasi-static analysis of both modes (see analyseMicrostripCoupled())
+  double ZlEff_e = model.Zle;
+  double ZlEff_o = model.Zlo;
+  double ErEff_e = model.ErEffe;
+  double ErEff_o = model.ErEffo;
 
   // Analyse dispersion for even and odd modes
   analyseDispersionCoupled(W, h, S, t, er, ZlEff_e, ZlEff_o, ErEff_e, ErEff_o,
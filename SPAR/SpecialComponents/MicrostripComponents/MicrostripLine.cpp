@@ -9,23 +9,34 @@
 #include "./../../SParameterCalculator.h"
 
 void SParameterCalculator::addMicrostripLineToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
   // Extract microstrip parameters
-  int node1 = comp.nodes[0];
-  int node2 = comp.nodes[1];
-
-  double W = comp.value.value("Width");        // Width in meters
-  double L = comp.value.value("Length");       // Length in meters
-  double h = comp.value.value("h");            // Substrate height in meters
-  double er = comp.value.value("er");          // Relative permittivity
-  double t = comp.value.value("th", 0.0);      // Conductor thickness (optional)
-  double tand = comp.value.value("tand", 0.0); // Loss tangent (optional)
-  double rho = comp.value.value("rho", 1e-10); // Surface Resistivity (optional)
+  const MicrostripParams &ms = comp.params.microstrip;
+  double W = ms.W;       // Width in meters
+  double h = ms.h;       // Substrate height in meters
+  double er = ms.er;     // Relative permittivity
+  double t = ms.t;       // Conductor thickness (optional)
+  double tand = ms.tand; // Loss tangent (optional)
+  double rho = ms.rho;   // Surface Resistivity (optional)
+
+  // Quasi-static part, shared by the lines with the same geometry
+  MicrostripStaticModel model =
+      comp.msModel[0] ? *comp.msModel[0] : analyseMicrostripLine(W, h, er, t);
 
   // Calculate propagation characteristics
   double alpha, beta, zl, ereff;
-  calcMicrostripPropagation(W, h, er, t, tand, rho, frequency, alpha, beta, zl,
-                            ereff);
+  calcMicrostripPropagation(model, W, h, er, t, tand, rho, freq, alpha, beta,
+                            zl, ereff);
+  stampMicrostripLine(Y, comp, alpha, beta, zl);
+}
+
+void SParameterCalculator::stampMicrostripLine(NodalMatrix &Y,
+                                               const Component_SPAR &comp,
+                                               double alpha, double beta,
+                                               double zl) {
+  int node1 = comp.nodes[0];
+  int node2 = comp.nodes[1];
+  double L = comp.params.microstrip.L; // Length in meters
 
   double z0 = 50.0;   // System impedance - make sure this matches your system
   double z = zl / z0; // normalized characteristic impedance
@@ -88,18 +99,19 @@ void SParameterCalculator::addMicrostripLineToAdmittance(
 }
 
 void SParameterCalculator::calcMicrostripPropagation(
-    double W, double h, double er, double t, double tand, double rho,
-    double frequency, double &alpha, double &beta, double &zl, double &ereff) {
+    const MicrostripStaticModel &model, double W, double h, double er,
+    double t, double tand, double rho, double frequency, double &alpha,
+    double &beta, double &zl, double &ereff) {
   // Local variables
   double ac, ad;
-  double ZlEff, ErEff, WEff, ZlEffFreq, ErEffFreq;
+  double ZlEffFreq, ErEffFreq;
 
   // Default model names
-  string SModel = "Hammerstad";
   string DModel = "Kirschning";
 
   // Quasi-static effective dielectric constant and impedance
-  analyseQuasiStatic(W, h, t, er, SModel, ZlEff, ErEff, WEff);
+  double ZlEff = model.ZlEff;
+  double ErEff = model.ErEff;
 
   // Analyse dispersion
   analyseDispersion(W, h, er, ZlEff, ErEff, frequency, DModel, ZlEffFreq,
@@ -0,0 +1,132 @@
+/// @file MicrostripModels.cpp
+/// @brief Cache of the frequency-independent part of the microstrip models
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "./../../SParameterCalculator.h"
+
+// Number of cached geometries. Beyond that, the cache is restarted (the
+// components keep their own references to the models in use)
+static const size_t MICROSTRIP_CACHE_SIZE = 4096;
+
+void SParameterCalculator::bindMicrostripModels() {
+  // The components of the subcircuits are bound too
+  vector<Component_SPAR *> targets;
+  for (Component_SPAR &comp : components) {
+    targets.push_back(&comp);
+  }
+  for (const shared_ptr<Subcircuit> &sub : subcircuits) {
+    for (Component_SPAR &comp : sub->components) {
+      targets.push_back(&comp);
+    }
+  }
+
+  for (Component_SPAR *target : targets) {
+    bindMicrostripModel(*target);
+  }
+}
+
+void SParameterCalculator::bindMicrostripModel(Component_SPAR &comp) {
+  comp.msModel[0].reset();
+  comp.msModel[1].reset();
+
+  // The static part does not depend on the losses (tand, rho), so they are
+  // not part of the key of the lines. Geometries that only differ in them
+  // share the same model
+  const MicrostripParams &ms = comp.params.microstrip;
+  switch (comp.type) {
+  case ComponentType_SPAR::MICROSTRIP_LINE:
+  case ComponentType_SPAR::MICROSTRIP_OPEN:
+    comp.msModel[0] =
+        getMicrostripModel({MS_LINE_MODEL, ms.W, ms.h, ms.er, ms.t, 0});
+    break;
+
+  case ComponentType_SPAR::MICROSTRIP_STEP:
+    comp.msModel[0] =
+        getMicrostripModel({MS_LINE_MODEL, ms.W, ms.h, ms.er, ms.t, 0});
+    comp.msModel[1] =
+        getMicrostripModel({MS_LINE_MODEL, ms.W2, ms.h, ms.er, ms.t, 0});
+    break;
+
+  case ComponentType_SPAR::MICROSTRIP_COUPLED_LINES:
+    comp.msModel[0] = getMicrostripModel(
+        {MS_COUPLED_MODEL, ms.W, ms.S, ms.h, ms.er, ms.t});
+    break;
+
+  case ComponentType_SPAR::MICROSTRIP_VIA:
+    comp.msModel[0] =
+        getMicrostripModel({MS_VIA_MODEL, ms.D, ms.h, ms.t, ms.rho, 0});
+    break;
+
+  default:
+    break;
+  }
+}
+
+shared_ptr<const MicrostripStaticModel>
+SParameterCalculator::getMicrostripModel(const MicrostripModelKey &key) {
+  if (microstripModels.size() > MICROSTRIP_CACHE_SIZE) {
+    microstripModels.clear();
+  }
+  shared_ptr<const MicrostripStaticModel> &model = microstripModels[key];
+  if (model) {
+    return model;
+  }
+
+  switch ((int)key[0]) {
+  case MS_LINE_MODEL:
+    model = make_shared<const MicrostripStaticModel>(
+        analyseMicrostripLine(key[1], key[2], key[3], key[4]));
+    break;
+  case MS_COUPLED_MODEL:
+    model = make_shared<const MicrostripStaticModel>(
+        analyseMicrostripCoupled(key[1], key[2], key[3], key[4], key[5]));
+    break;
+  default: // MS_VIA_MODEL
+    model = make_shared<const MicrostripStaticModel>(
+        analyseMicrostripVia(key[1], key[2], key[3], key[4]));
+    break;
+  }
+  return model;
+}
+
+MicrostripStaticModel SParameterCalculator::analyseMicrostripLine(double W,
+                                                                  double h,
+                                                                  double er,
+                                                                  double t) {
+  MicrostripStaticModel model;
+  analyseQuasiStatic(W, h, t, er, "Hammerstad", model.ZlEff, model.ErEff,
+                     model.WEff);
+  return model;
+}
+
+MicrostripStaticModel
+SParameterCalculator::analyseMicrostripCoupled(double W, double S, double h,
+                                               double er, double t) {
+  MicrostripStaticModel model;
+  analyseQuasiStaticCoupled(W, h, S, t, er, "Kirschning", model.Zle, model.Zlo,
+                            model.ErEffe, model.ErEffo);
+  return model;
+}
+
+MicrostripStaticModel SParameterCalculator::analyseMicrostripVia(double D,
+                                                                 double h,
+                                                                 double t,
+                                                                 double rho) {
+  MicrostripStaticModel model;
+  double r = D / 2.0; // Via radius
+
+  // DC resistance
+  double v = h / M_PI / (r * r - (r - t) * (r - t));
+  model.R = rho * v;
+
+  // Skin effect factor
+  model.fs = M_PI * MU0 * t * t / rho;
+
+  // Inductance
+  double a = sqrt(r * r + h * h);
+  model.L = MU0 * (h * log((h + a) / r) + 1.5 * (r - a));
+  return model;
+}
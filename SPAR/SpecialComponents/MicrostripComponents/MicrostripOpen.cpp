@@ -9,25 +9,28 @@
 #include "./../../SParameterCalculator.h"
 
 void SParameterCalculator::addMicrostripOpenToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
   // Extract microstrip open end parameters
   int node1 = comp.nodes[0];
 
-  double W = comp.value.value("W");       // Width in meters
-  double h = comp.value.value("h");       // Substrate height in meters
-  double er = comp.value.value("er");     // Relative permittivity
-  double t = comp.value.value("th", 0.0); // Conductor thickness (optional)
+  const MicrostripParams &ms = comp.params.microstrip;
+  double W = ms.W;   // Width in meters
+  double h = ms.h;   // Substrate height in meters
+  double er = ms.er; // Relative permittivity
+  double t = ms.t;   // Conductor thickness (optional)
 
   // Get model type (default: Kirschning)
   string Model = "Kirschning"; // Default model
 
   // Default model names (hardcoded for now, can be made configurable later)
-  string SModel = "Hammerstad";
   string DModel = "Kirschning";
 
+  // Quasi-static part, shared with the lines of the same width
+  MicrostripStaticModel model =
+      comp.msModel[0] ? *comp.msModel[0] : analyseMicrostripLine(W, h, er, t);
+
   // Calculate admittance for the open end
-  Complex y =
-      calcMicrostripOpenY(W, h, er, t, frequency, Model, SModel, DModel);
+  Complex y = calcMicrostripOpenY(model, W, h, er, freq, Model, DModel);
 
   // Add to admittance matrix
   if (node1 > 0) {
@@ -35,20 +38,17 @@ void SParameterCalculator::addMicrostripOpenToAdmittance(
   }
 }
 
-Complex SParameterCalculator::calcMicrostripOpenY(double W, double h, double er,
-                                                  double t, double frequency,
-                                                  const string &Model,
-                                                  const string &SModel,
-                                                  const string &DModel) {
+Complex SParameterCalculator::calcMicrostripOpenY(
+    const MicrostripStaticModel &model, double W, double h, double er,
+    double frequency, const string &Model, const string &DModel) {
   double omega = 2.0 * M_PI * frequency;
   Complex y;
 
   // Alexopoulos and Wu model
   if (Model == "Alexopoulos") {
-    double ZlEff, ErEff, WEff, ZlEffFreq, ErEffFreq;
-    analyseQuasiStatic(W, h, t, er, SModel, ZlEff, ErEff, WEff);
-    analyseDispersion(W, h, er, ZlEff, ErEff, frequency, DModel, ZlEffFreq,
-                      ErEffFreq);
+    double ZlEffFreq, ErEffFreq;
+    analyseDispersion(W, h, er, model.ZlEff, model.ErEff, frequency, DModel,
+                      ZlEffFreq, ErEffFreq);
 
     // Warning: Model defined for er = 9.9
     if (fabs(er - 9.9) > 0.2) {
@@ -80,7 +80,7 @@ Complex SParameterCalculator::calcMicrostripOpenY(double W, double h, double er,
   } else {
     // Kirschning or Hammerstad model - simple capacitive end effect
     double c =
-        calcMicrostripOpenCend(W, h, er, t, frequency, Model, SModel, DModel);
+        calcMicrostripOpenCend(model, W, h, er, frequency, Model, DModel);
     y = Complex(0.0, omega * c);
   }
 
@@ -88,13 +88,12 @@ Complex SParameterCalculator::calcMicrostripOpenY(double W, double h, double er,
 }
 
 double SParameterCalculator::calcMicrostripOpenCend(
-    double W, double h, double er, double t, double frequency,
-    const string &Model, const string &SModel, const string &DModel) {
+    const MicrostripStaticModel &model, double W, double h, double er,
+    double frequency, const string &Model, const string &DModel) {
   // Calculate line parameters
-  double ZlEff, ErEff, WEff, ZlEffFreq, ErEffFreq;
-  analyseQuasiStatic(W, h, t, er, SModel, ZlEff, ErEff, WEff);
-  analyseDispersion(W, h, er, ZlEff, ErEff, frequency, DModel, ZlEffFreq,
-                    ErEffFreq);
+  double ZlEffFreq, ErEffFreq;
+  analyseDispersion(W, h, er, model.ZlEff, model.ErEff, frequency, DModel,
+                    ZlEffFreq, ErEffFreq);
 
   double W_h = W / h;
   double dl = 0.0;
@@ -9,24 +9,32 @@
 #include "./../../SParameterCalculator.h"
 
 void SParameterCalculator::addMicrostripStepToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
   // Extract microstrip step parameters
   int node1 = comp.nodes[0];
   int node2 = comp.nodes[1];
 
-  double W1 = comp.value.value("W1");     // Width of first section in meters
-  double W2 = comp.value.value("W2");     // Width of second section in meters
-  double h = comp.value.value("h");       // Substrate height in meters
-  double er = comp.value.value("er");     // Relative permittivity
-  double t = comp.value.value("th", 0.0); // Conductor thickness (optional)
+  const MicrostripParams &ms = comp.params.microstrip;
+  double W1 = ms.W;   // Width of first section in meters
+  double W2 = ms.W2;  // Width of second section in meters
+  double h = ms.h;    // Substrate height in meters
+  double er = ms.er;  // Relative permittivity
+  double t = ms.t;    // Conductor thickness (optional)
 
   // Default model names (hardcoded for now, can be made configurable later)
-  string SModel = "Hammerstad";
   string DModel = "Kirschning";
 
+  // Quasi-static models of both sections
+  MicrostripStaticModel model1 = comp.msModel[0]
+                                     ? *comp.msModel[0]
+                                     : analyseMicrostripLine(W1, h, er, t);
+  MicrostripStaticModel model2 = comp.msModel[1]
+                                     ? *comp.msModel[1]
+                                     : analyseMicrostripLine(W2, h, er, t);
+
   // Calculate Z-parameters for the step discontinuity
   Complex z11, z12, z21, z22;
-  calcMicrostripStepZ(W1, W2, h, er, t, frequency, SModel, DModel, z11, z12,
+  calcMicrostripStepZ(model1, model2, W1, W2, h, er, freq, DModel, z11, z12,
                       z21, z22);
 
   // Convert Z-parameters to Y-parameters
@@ -59,9 +67,10 @@ void SParameterCalculator::addMicrostripStepToAdmittance(
 }
 
 void SParameterCalculator::calcMicrostripStepZ(
-    double W1, double W2, double h, double er, double t, double frequency,
-    const string &SModel, const string &DModel, Complex &z11, Complex &z12,
-    Complex &z21, Complex &z22) {
+    const MicrostripStaticModel &model1, const MicrostripStaticModel &model2,
+    double W1, double W2, double h, double er, double frequency,
+    const string &DModel, Complex &z11, Complex &z12, Complex &z21,
+    Complex &z22) {
   // Compute parallel capacitance
   double t1 = log10(er);
   double t2 = W1 / W2;
@@ -73,17 +82,15 @@ void SParameterCalculator::calcMicrostripStepZ(
   double Ls = h * (t2 * (40.5 + 0.2 * t2) - 75.0 * t1);
 
   // Calculate line parameters for W1
-  double ZlEff1, ErEff1, WEff1, ZlEffFreq1, ErEffFreq1;
-  analyseQuasiStatic(W1, h, t, er, SModel, ZlEff1, ErEff1, WEff1);
-  analyseDispersion(W1, h, er, ZlEff1, ErEff1, frequency, DModel, ZlEffFreq1,
-                    ErEffFreq1);
+  double ZlEffFreq1, ErEffFreq1;
+  analyseDispersion(W1, h, er, model1.ZlEff, model1.ErEff, frequency, DModel,
+                    ZlEffFreq1, ErEffFreq1);
   double L1 = ZlEffFreq1 * sqrt(ErEffFreq1) / C0;
 
   // Calculate line parameters for W2
-  double ZlEff2, ErEff2, WEff2, ZlEffFreq2, ErEffFreq2;
-  analyseQuasiStatic(W2, h, t, er, SModel, ZlEff2, ErEff2, WEff2);
-  analyseDispersion(W2, h, er, ZlEff2, ErEff2, frequency, DModel, ZlEffFreq2,
-                    ErEffFreq2);
+  double ZlEffFreq2, ErEffFreq2;
+  analyseDispersion(W2, h, er, model2.ZlEff, model2.ErEff, frequency, DModel,
+                    ZlEffFreq2, ErEffFreq2);
   double L2 = ZlEffFreq2 * sqrt(ErEffFreq2) / C0;
 
   // Normalize series inductance
@@ -0,0 +1,353 @@
+/// @file MicrostripSweep.cpp
+/// @brief Array versions of the microstrip dispersion and loss models, used to
+/// evaluate a whole frequency sweep at once
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "./../../SParameterCalculator.h"
+
+// The functions below evaluate the same expressions as their scalar
+// counterparts. Only the subexpressions that do not depend on frequency are
+// taken out of the loops, keeping the order of the operations, so the results
+// are identical to the point-by-point evaluation
+
+void SParameterCalculator::prepareMicrostripSweep(const vector<double> &freqs) {
+  microstripSweep.clear();
+  int n = freqs.size();
+  if (!plan.valid || n == 0) {
+    return;
+  }
+
+  bool found = false;
+  for (int i : plan.dynamicStamps) {
+    ComponentType_SPAR type = components[i].type;
+    found |= type == ComponentType_SPAR::MICROSTRIP_LINE ||
+             type == ComponentType_SPAR::MICROSTRIP_COUPLED_LINES;
+  }
+  if (!found) {
+    return;
+  }
+
+  microstripSweep.resize(components.size());
+  vector<double> ereff(n), ereffOdd(n);
+  for (int i : plan.dynamicStamps) {
+    const Component_SPAR &comp = components[i];
+    const MicrostripParams &ms = comp.params.microstrip;
+    MicrostripSweep &table = microstripSweep[i];
+
+    if (comp.type == ComponentType_SPAR::MICROSTRIP_LINE) {
+      MicrostripStaticModel model =
+          comp.msModel[0] ? *comp.msModel[0]
+                          : analyseMicrostripLine(ms.W, ms.h, ms.er, ms.t);
+      table.alpha[0].resize(n);
+      table.beta[0].resize(n);
+      table.zl[0].resize(n);
+      calcMicrostripPropagation(model, ms.W, ms.h, ms.er, ms.t, ms.tand,
+                                ms.rho, freqs.data(), n, table.alpha[0].data(),
+                                table.beta[0].data(), table.zl[0].data(),
+                                ereff.data());
+    } else if (comp.type == ComponentType_SPAR::MICROSTRIP_COUPLED_LINES) {
+      MicrostripStaticModel model =
+          comp.msModel[0]
+              ? *comp.msModel[0]
+              : analyseMicrostripCoupled(ms.W, ms.S, ms.h, ms.er, ms.t);
+      for (int m = 0; m < 2; m++) {
+        table.alpha[m].resize(n);
+        table.beta[m].resize(n);
+        table.zl[m].resize(n);
+      }
+      calcMicrostripCoupledPropagation(
+          model, ms.W, ms.S, ms.h, ms.er, ms.t, ms.tand, ms.rho, freqs.data(),
+          n, table.alpha[0].data(), table.beta[0].data(), table.zl[0].data(),
+          ereff.data(), table.alpha[1].data(), table.beta[1].data(),
+          table.zl[1].data(), ereffOdd.data());
+    }
+  }
+}
+
+void SParameterCalculator::stampDynamic(NodalMatrix &Y, int index, double freq,
+                                        int point) {
+  const Component_SPAR &comp = components[index];
+  if (point >= 0 && index < (int)microstripSweep.size()) {
+    const MicrostripSweep &table = microstripSweep[index];
+    if (comp.type == ComponentType_SPAR::MICROSTRIP_LINE &&
+        !table.zl[0].empty()) {
+      stampMicrostripLine(Y, comp, table.alpha[0][point],
+                          table.beta[0][point], table.zl[0][point]);
+      return;
+    }
+    if (comp.type == ComponentType_SPAR::MICROSTRIP_COUPLED_LINES &&
+        !table.zl[1].empty()) {
+      stampMicrostripCoupledLines(
+          Y, comp, table.alpha[0][point], table.beta[0][point],
+          table.zl[0][point], table.alpha[1][point], table.beta[1][point],
+          table.zl[1][point]);
+      return;
+    }
+  }
+  stampComponent(Y, comp, freq);
+}
+
+void SParameterCalculator::calcMicrostripPropagation(
+    const MicrostripStaticModel &model, double W, double h, double er,
+    double t, double tand, double rho, const double *frequency, int n,
+    double *alpha, double *beta, double *zl, double *ereff) {
+  vector<double> ad(n);
+
+  analyseDispersion(W, h, er, model.ZlEff, model.ErEff, frequency, n, zl,
+                    ereff);
+  analyseLoss(W, t, er, rho, 0.0, tand, model.ZlEff, model.ZlEff, model.ErEff,
+              frequency, n, alpha, ad.data());
+
+  for (int i = 0; i < n; i++) {
+    alpha[i] = alpha[i] + ad[i];
+    beta[i] = sqrt(ereff[i]) * 2 * M_PI * frequency[i] / C0;
+  }
+}
+
+void SParameterCalculator::calcMicrostripCoupledPropagation(
+    const MicrostripStaticModel &model, double W, double S, double h,
+    double er, double t, double tand, double rho, const double *frequency,
+    int n, double *alpha_e, double *beta_e, double *zl_e, double *ereff_e,
+    double *alpha_o, double *beta_o, double *zl_o, double *ereff_o) {
+  vector<double> ad_e(n), ad_o(n);
+
+  analyseDispersionCoupled(W, h, S, t, er, model.Zle, model.Zlo, model.ErEffe,
+                           model.ErEffo, frequency, n, zl_e, zl_o, ereff_e,
+                           ereff_o);
+  analyseLoss(W, t, er, rho, 0.0, tand, model.Zle, model.Zlo, model.ErEffe,
+              frequency, n, alpha_e, ad_e.data());
+  analyseLoss(W, t, er, rho, 0.0, tand, model.Zlo, model.Zle, model.ErEffo,
+              frequency, n, alpha_o, ad_o.data());
+
+  for (int i = 0; i < n; i++) {
+    alpha_e[i] = alpha_e[i] + ad_e[i];
+    beta_e[i] = sqrt(ereff_e[i]) * 2 * M_PI * frequency[i] / C0;
+    alpha_o[i] = alpha_o[i] + ad_o[i];
+    beta_o[i] = sqrt(ereff_o[i]) * 2 * M_PI * frequency[i] / C0;
+  }
+}
+
+void SParameterCalculator::analyseDispersion(double W, double h, double er,
+                                             double ZlEff, double ErEff,
+                                             const double *frequency, int n,
+                                             double *ZlEffFreq,
+                                             double *ErEffFreq) {
+  vector<double> fn(n);
+  for (int i = 0; i < n; i++) {
+    fn[i] = frequency[i] * h / 1e6;
+  }
+  Kirschning_er(W / h, fn.data(), n, er, ErEff, ErEffFreq);
+  Kirschning_zl(ErEff, ErEffFreq, n, ZlEff, ZlEffFreq);
+}
+
+void SParameterCalculator::analyseLoss(double W, double t, double er,
+                                       double rho, double D, double tand,
+                                       double ZlEff1, double ZlEff2,
+                                       double ErEff, const double *frequency,
+                                       int n, double *ac, double *ad) {
+  // Conductor losses
+  if (t != 0.0) {
+    double Ki = exp(-1.2 * pow((ZlEff1 + ZlEff2) / 2.0 / Z0, 0.7));
+    double ZW = ZlEff1 * W;
+    if (D == 0.0 && rho != 0.0) {
+      // No surface roughness: Kr = 1
+      for (int i = 0; i < n; i++) {
+        double Rs = sqrt(M_PI * frequency[i] * MU0 * rho);
+        ac[i] = Rs / ZW * Ki;
+      }
+    } else {
+      for (int i = 0; i < n; i++) {
+        double Rs = sqrt(M_PI * frequency[i] * MU0 * rho);
+        double ds = rho / Rs;
+        double Kr = 1.0 + (2.0 / M_PI) * atan(1.4 * pow(D / ds, 2.0));
+        ac[i] = Rs / ZW * Ki * Kr;
+      }
+    }
+  } else {
+    fill(ac, ac + n, 0.0);
+  }
+
+  // Dielectric losses
+  double k = M_PI * er / (er - 1.0) * (ErEff - 1.0) / sqrt(ErEff) * tand;
+  for (int i = 0; i < n; i++) {
+    ad[i] = k / (C0 / frequency[i]);
+  }
+}
+
+void SParameterCalculator::Kirschning_er(double u, const double *fn, int n,
+                                         double er, double ErEff,
+                                         double *ErEffFreq) {
+  double c1 = 0.065683 * exp(-8.7513 * u);
+  double p2 = 0.33622 * (1 - exp(-0.03442 * er));
+  double c3 = 0.0363 * exp(-4.6 * u);
+  double p4 = 1 + 2.751 * (1 - exp(-pow(er / 15.916, 8.)));
+  double de = er - ErEff;
+  for (int i = 0; i < n; i++) {
+    double p1 = 0.27488 + (0.6315 + 0.525 / pow(1. + 0.0157 * fn[i], 20.)) * u -
+                c1;
+    double p3 = c3 * (1 - exp(-pow(fn[i] / 38.7, 4.97)));
+    double p = p1 * p2 * pow((0.1844 + p3 * p4) * fn[i], 1.5763);
+    ErEffFreq[i] = er - de / (1 + p);
+  }
+}
+
+void SParameterCalculator::Kirschning_zl(double ErEff, const double *ErEffFreq,
+                                         int n, double ZlEff,
+                                         double *ZlEffFreq) {
+  for (int i = 0; i < n; i++) {
+    ZlEffFreq[i] = ZlEff * sqrt(ErEff / ErEffFreq[i]);
+  }
+}
+
+void SParameterCalculator::analyseDispersionCoupled(
+    double W, double h, double s, double t, double er, double Zle, double Zlo,
+    double ErEffe, double ErEffo, const double *frequency, int n,
+    double *ZleFreq, double *ZloFreq, double *ErEffeFreq, double *ErEffoFreq) {
+  double u = W / h;
+  double g = s / h;
+  double ue, uo;
+
+  // Compute u_odd, u_even
+  if (t > 0.0) {
+    double B = (u < 0.1592) ? 2.0 * M_PI * W : h;
+    double dW = t * (1.0 + log(2.0 * B / t)) / M_PI;
+    double dt = t / (er * g);
+    ue = (W + dW * (1.0 - 0.5 * exp(-0.69 * dW / dt))) / h;
+    uo = ue + dt / h;
+  } else {
+    ue = u;
+    uo = u;
+  }
+
+  // Frequency-independent terms of the Kirschning model
+  double ce1 = 0.065683 * exp(-8.7513 * ue);
+  double co1 = 0.065683 * exp(-8.7513 * uo);
+  double p2 = 0.33622 * (1.0 - exp(-0.03442 * er));
+  double ce3 = 0.0363 * exp(-4.6 * ue);
+  double co3 = 0.0363 * exp(-4.6 * uo);
+  double p4 = 1.0 + 2.751 * (1.0 - exp(-pow(er / 15.916, 8.0)));
+  double p5 = 0.334 * exp(-3.3 * pow(er / 15.0, 3.0)) + 0.746;
+  double g7a = pow(g, 0.479);
+  double g7b = exp(-1.347 * pow(g, 0.595) - 0.17 * pow(g, 2.5));
+  double de = er - ErEffe;
+  double dO = er - ErEffo;
+
+  double p8 = 0.7168 * (1.0 + 1.076 / (1.0 + 0.0576 * (er - 1.0)));
+  double a9 = atan(2.481 * pow(er / 8.0, 0.946));
+  double p10 = 0.242 * pow(er - 1.0, 0.55);
+  double a11 = atan(1.263 * pow(uo / 3.0, 1.629));
+  double d12 = 1.0 + 1.183 * pow(uo, 1.376);
+  double p13 = 1.695 * p10 / (0.414 + 1.605 * p10);
+  double e15 = exp(-p13 * pow(g, 1.092));
+
+  double q11 = 0.893 * (1.0 - 0.3 / (1.0 + 0.7 * (er - 1.0)));
+  double g12a = exp(-2.87 * g);
+  double g12b = pow(g, 0.902);
+  double q13 = 1.0 + 0.038 * pow(er / 8.0, 5.1);
+  double tq = pow(er / 15.0, 4.0);
+  double q14 = 1.0 + 1.203 * tq / (1.0 + tq);
+  double n15 = 1.887 * exp(-1.5 * pow(g, 0.84)) * pow(g, q14);
+  double u15a = pow(u, 2.0 / q13);
+  double u15b = 0.125 + pow(u, 1.626 / q13);
+  double k16 = 1.0 + 9.0 / (1.0 + 0.403 * pow(er - 1.0, 2.0));
+  double c17 = 0.394 * (1.0 - exp(-1.47 * pow(u / 7.0, 0.672)));
+  double q18 = 0.61 * (1.0 - exp(-2.31 * pow(u / 8.0, 1.593))) /
+               (1.0 + 6.544 * pow(g, 4.17));
+  double c19 = 0.21 * pow(g, 4.0) / (1.0 + 0.18 * pow(g, 4.9)) /
+               (1.0 + 0.1 * pow(u, 2.0));
+  double k20 = 0.09 + 1.0 / (1.0 + 0.1 * pow(er - 1.0, 2.7));
+  tq = pow(u, 2.5);
+  double q21 = fabs(1.0 - 42.54 * pow(g, 0.133) * exp(-0.812 * g) * tq /
+                              (1.0 + 0.033 * tq));
+
+  double qe = 0.016 + pow(0.0514 * er * q21, 4.524);
+  double pe = 4.766 * exp(-3.228 * pow(u, 0.641));
+  double de1 = 5.086 * qe;
+  double de2 = 0.3838 + 0.386 * qe;
+  double de3 = exp(-22.2 * pow(u, 1.92));
+  double t6 = pow(er - 1.0, 6.0);
+  double de4 = 1.0 + 10.0 * t6;
+  double ce = -0.004625 * pe * pow(er, 1.674);
+
+  double q29 = 15.16 / (1.0 + 0.196 * pow(er - 1.0, 2.0));
+  tq = pow(er - 1.0, 2.0);
+  double k25 = 1.0 + 2.333 * tq / (5.0 + tq);
+  tq = pow((er - 1.0) / 13.0, 12.0);
+  double q26 = 30.0 - 22.2 * tq / (1.0 + 3.0 * tq) - q29;
+  tq = pow(er - 1.0, 1.5);
+  double q27 = 0.4 * pow(g, 0.84) * (1.0 + 2.5 * tq / (5.0 + tq));
+  tq = pow(er - 1.0, 3.0);
+  double q28 = 0.149 * tq / (94.5 + 0.038 * tq);
+  double d23 = 1.0 + 0.025 * pow(u, 2.0);
+  tq = pow(u, 0.894);
+  double c24 = 2.506 * q28 * tq / (3.575 + tq);
+  double u24 = 1.0 + 1.3 * u;
+  double g25 = pow(0.46 * g, 2.2);
+
+  // Dispersion of the single line (used for the impedances)
+  vector<double> fn(n), ErEffFreq_e(n), ErEffFreq_o(n);
+  for (int i = 0; i < n; i++) {
+    fn[i] = frequency[i] * h * 1e-6;
+  }
+  Kirschning_er(u, fn.data(), n, er, ErEffe, ErEffFreq_e.data());
+  Kirschning_er(u, fn.data(), n, er, ErEffo, ErEffFreq_o.data());
+
+  for (int i = 0; i < n; i++) {
+    double f = fn[i];
+    double k1 = 0.525 / pow(1.0 + 0.0157 * f, 20.0);
+    double e3 = 1.0 - exp(-pow(f / 38.7, 4.97));
+
+    // Even relative dielectric constant dispersion
+    double p1 = 0.27488 * (0.6315 + k1) * ue - ce1;
+    double p3 = ce3 * e3;
+    double p6 = p5 * exp(-pow(f / 18.0, 0.368));
+    double p7 = 1.0 + 4.069 * p6 * g7a * g7b;
+    double Fe = p1 * p2 * pow((p3 * p4 + 0.1844 * p7) * f, 1.5763);
+    ErEffeFreq[i] = er - de / (1.0 + Fe);
+
+    // Odd relative dielectric constant dispersion
+    p1 = 0.27488 * (0.6315 + k1) * uo - co1;
+    p3 = co3 * e3;
+    double p9 = p8 - 0.7913 * (1.0 - exp(-pow(f / 20.0, 1.424))) * a9;
+    double p11 = 0.6366 * (exp(-0.3401 * f) - 1.0) * a11;
+    double p12 = p9 + (1.0 - p9) / d12;
+    double p14 = 0.8928 + 0.1072 * (1.0 - exp(-0.42 * pow(f / 20.0, 3.215)));
+    double p15 = fabs(1.0 - 0.8928 * (1.0 + p11) * e15 * p12 / p14);
+    double Fo = p1 * p2 * pow((p3 * p4 + 0.1844) * f * p15, 1.5763);
+    ErEffoFreq[i] = er - dO / (1.0 + Fo);
+
+    // Dispersion of even characteristic impedance
+    double tf = pow(f / 20.0, 4.91);
+    double q12 = 2.121 * tf / (1.0 + q11 * tf) * g12a * g12b;
+    double q15 = n15 / (1.0 + 0.41 * pow(f / 15.0, 3.0) * u15a / u15b);
+    double q16 = q15 * k16;
+    double q17 = c17 * (1.0 - exp(-4.25 * pow(f / 20.0, 1.87)));
+    double q19 = c19 / (1.0 + pow(f / 24.0, 3.0));
+    double q20 = q19 * k20;
+
+    // Kirschning_zl() sets the exponent q0 to 1
+    double q0 = 1.0;
+    double re = pow(f / 28.843, 12.0);
+    double dd = de1 * re / de2 * de3 / (1.0 + 1.2992 * re) * t6 / de4;
+    double Ce = 1.0 + 1.275 * (1.0 - exp(ce * pow(f / 18.365, 2.745))) - q12 +
+                q16 - q17 + q18 + q20;
+    ZleFreq[i] = Zle * pow((0.9408 * pow(ErEffFreq_e[i], Ce) - 0.9603) /
+                               ((0.9408 - dd) * pow(ErEffe, Ce) - 0.9603),
+                           q0);
+
+    // Dispersion of odd characteristic impedance
+    double ZlFreq = Zlo * sqrt(ErEffo / ErEffFreq_o[i]);
+    double q25 = 0.3 * pow(f, 2.0) / (10.0 + pow(f, 2.0)) * k25;
+    double q22 =
+        0.925 * pow(f / q26, 1.536) / (1.0 + 0.3 * pow(f / 30.0, 1.536));
+    double q23 =
+        1.0 + 0.005 * f * q27 / (1.0 + 0.812 * pow(f / 15.0, 1.9)) / d23;
+    double q24 = c24 * pow(u24 * f / 99.25, 4.29);
+    ZloFreq[i] = ZlFreq + (Zlo * pow(ErEffoFreq[i] / ErEffo, q22) -
+                           ZlFreq * q23) /
+                              (1.0 + q24 + g25 * q25);
+  }
+}
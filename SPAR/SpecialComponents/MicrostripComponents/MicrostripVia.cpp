@@ -9,24 +9,28 @@
 #include "./../../SParameterCalculator.h"
 
 void SParameterCalculator::addMicrostripViaToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
   // Extract microstrip via parameters
   int node1 = comp.nodes[0];
 
-  int N = comp.value.value("N");               // Number of vias in parallel
-  double D = comp.value.value("D");            // Via diameter in meters
-  double h = comp.value.value("h");            // Substrate height in meters
-  double t = comp.value.value("th");           // Conductor thickness in meters
-  double rho = comp.value.value("rho", 1e-10); // Resistivity in Ohm*m
+  const MicrostripParams &ms = comp.params.microstrip;
+  int N = ms.N;        // Number of vias in parallel
+  double D = ms.D;     // Via diameter in meters
+  double h = ms.h;     // Substrate height in meters
+  double t = ms.t;     // Conductor thickness in meters
+  double rho = ms.rho; // Resistivity in Ohm*m
 
   // Calculate via impedance
-  Complex Z = calcMicrostripViaImpedance(D, h, t, rho, frequency);
+  MicrostripStaticModel model = comp.msModel[0]
+                                    ? *comp.msModel[0]
+                                    : analyseMicrostripVia(D, h, t, rho);
+  Complex Z = calcMicrostripViaImpedance(model, freq);
 
   // Multiple vias effect
   Z /= N;
 
   // Check frequency validity
-  if (frequency * h >= 0.03 * C0) {
+  if (freq * h >= 0.03 * C0) {
     // Warning: Model defined for freq*h/C0 < 0.03
     // Model may be less accurate at higher frequencies
   }
@@ -40,23 +44,13 @@ void SParameterCalculator::addMicrostripViaToAdmittance(
   }
 }
 
-Complex SParameterCalculator::calcMicrostripViaImpedance(double D, double h,
-                                                         double t, double rho,
-                                                         double frequency) {
-  double r = D / 2.0; // Via radius
-
-  // Calculate DC resistance
-  double v = h / M_PI / (r * r - (r - t) * (r - t));
-  double R = rho * v;
-
+Complex SParameterCalculator::calcMicrostripViaImpedance(
+    const MicrostripStaticModel &model, double frequency) {
   // Calculate frequency-dependent resistance (skin effect)
-  double fs = M_PI * MU0 * t * t / rho;
-  double res = R * sqrt(1.0 + frequency * fs);
+  double res = model.R * sqrt(1.0 + frequency * model.fs);
 
-  // Calculate inductance
-  double a = sqrt(r * r + h * h);
-  double ind = MU0 * (h * log((h + a) / r) + 1.5 * (r - a));
-  double X = 2.0 * M_PI * frequency * ind;
+  // Reactance of the via inductance
+  double X = 2.0 * M_PI * frequency * model.L;
 
   // Return complex impedance Z = R(f) + j*omega*L
   return Complex(res, X);
@@ -12,38 +12,82 @@ vector<vector<Complex>>
 SParameterCalculator::convertS2Y(const vector<vector<Complex>> &S, double Z0) {
 
   int N = S.size();
-  auto I = createMatrix(N, N);
-  auto I_minus_S = createMatrix(N, N);
-  auto I_plus_S = createMatrix(N, N);
+  vector<Complex> Sflat(N * N), Yflat(N * N);
+  for (int i = 0; i < N; i++) {
+    copy(S[i].begin(), S[i].begin() + N, Sflat.begin() + i * N);
+  }
+  if (!nPortSToY(Sflat.data(), N, Z0, Yflat.data())) {
+    throw runtime_error("Matrix is singular and cannot be inverted");
+  }
+
+  vector<vector<Complex>> Y = createMatrix(N, N);
+  for (int i = 0; i < N; i++) {
+    copy(Yflat.begin() + i * N, Yflat.begin() + (i + 1) * N, Y[i].begin());
+  }
+  return Y;
+}
+
+bool SParameterCalculator::nPortSToY(const Complex *S, int N, double Z0,
+                                     Complex *Y) {
+  if (N == 2) {
+    return twoPortSToY(S[0], S[1], S[2], S[3], Z0, Y);
+  }
 
+  // I - S and I + S commute, so Y = G0 * (I - S) * inv(I + S) is also
+  // G0 * inv(I + S) * (I - S): one factorization and N right-hand sides
+  ComplexMatrix A(N, N), B(N, N);
   for (int i = 0; i < N; i++) {
-    I[i][i] = Complex(1, 0);
     for (int j = 0; j < N; j++) {
-      I_minus_S[i][j] = I[i][j] - S[i][j];
-      I_plus_S[i][j] = I[i][j] + S[i][j];
+      Complex d = (i == j) ? Complex(1, 0) : Complex(0, 0);
+      A(i, j) = d + S[i * N + j];
+      B(i, j) = d - S[i * N + j];
     }
   }
+  vector<int> pivots;
+  try {
+    luFactorize(A, pivots);
+  } catch (const runtime_error &) {
+    return false;
+  }
+  luSolve(A, pivots, B);
 
-  auto I_plus_S_inv = invertMatrix(I_plus_S);
-
-  vector<vector<Complex>> Y = createMatrix(N, N);
   double G0 = 1.0 / Z0;
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      Y[i * N + j] = G0 * B(i, j);
+    }
+  }
+  return true;
+}
 
+void SParameterCalculator::stampNPortY(NodalMatrix &Y, const vector<int> &nodes,
+                                       const Complex *Yp) {
+  int N = nodes.size();
   for (int i = 0; i < N; i++) {
+    if (nodes[i] <= 0) {
+      continue;
+    }
     for (int j = 0; j < N; j++) {
-      Complex sum(0, 0);
-      for (int k = 0; k < N; k++) {
-        sum += I_minus_S[i][k] * I_plus_S_inv[k][j];
+      if (nodes[j] > 0) {
+        Y[nodes[i] - 1][nodes[j] - 1] += Yp[i * N + j];
       }
-      Y[i][j] = G0 * sum;
     }
   }
+}
 
-  return Y;
+void SParameterCalculator::stampNPortSParameters(NodalMatrix &Y,
+                                                 const vector<int> &nodes,
+                                                 const Complex *S, double Z0) {
+  int N = nodes.size();
+  vector<Complex> Yp(N * N);
+  if (!nPortSToY(S, N, Z0, Yp.data())) {
+    throw runtime_error("Matrix is singular and cannot be inverted");
+  }
+  stampNPortY(Y, nodes, Yp.data());
 }
 
 void SParameterCalculator::addSParamBlockToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
 
   int numRFPorts = comp.numRFPorts;
 
@@ -56,29 +100,45 @@ void SParameterCalculator::addSParamBlockToAdmittance(
 
   if (numRFPorts == 1) {
     // One-port device (.s1p)
-    addOnePortSParamToAdmittance(Y, comp);
+    addOnePortSParamToAdmittance(Y, comp, freq);
   } else if (numRFPorts == 2) {
     // Two-port device (.s2p)
-    addTwoPortSParamToAdmittance(Y, comp);
+    addTwoPortSParamToAdmittance(Y, comp, freq);
   } else {
-    cerr << "Error: Only 1-port and 2-port S-parameter devices are supported. "
-         << "Found " << numRFPorts << " ports.\n";
+    // N-port device, one node per port (referred to ground). The block is
+    // static, so the conversion runs once per circuit
+    if ((int)comp.nodes.size() != numRFPorts) {
+      cerr << "Error: " << numRFPorts << "-port S-parameter device must have "
+           << numRFPorts << " circuit nodes\n";
+      return;
+    }
+    vector<Complex> S(numRFPorts * numRFPorts);
+    for (int i = 0; i < numRFPorts; i++) {
+      copy_n(comp.Smatrix[i].begin(), numRFPorts, S.begin() + i * numRFPorts);
+    }
+    stampNPortSParameters(Y, comp.nodes, S.data(), comp.referenceImpedance);
   }
 }
 
 void SParameterCalculator::addOnePortSParamToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double /*freq*/) {
 
-  if (comp.nodes.size() != 2) {
-    cerr << "Error: One-port S-parameter device must have exactly 2 circuit "
+  if (comp.nodes.empty() || comp.nodes.size() > 2) {
+    cerr << "Error: One-port S-parameter device must have 1 or 2 circuit "
             "nodes\n";
     return;
   }
 
-  // Extract S11 from 1x1 S-matrix
-  Complex S11 = comp.Smatrix[0][0];
-  double Z0 = comp.referenceImpedance;
+  // Extract S11 from 1x1 S-matrix. With a single node, the device is
+  // referred to ground
+  int node2 = comp.nodes.size() == 2 ? comp.nodes[1] : 0;
+  stampOnePortSParameters(Y, comp.nodes[0], node2, comp.Smatrix[0][0],
+                          comp.referenceImpedance);
+}
 
+void SParameterCalculator::stampOnePortSParameters(NodalMatrix &Y, int node1,
+                                                   int node2, Complex S11,
+                                                   double Z0) {
   // Convert S11 to impedance: Z = Z0 * (1 + S11) / (1 - S11)
   Complex denominator = Complex(1, 0) - S11;
   if (abs(denominator) < 1e-12) {
@@ -96,9 +156,6 @@ void SParameterCalculator::addOnePortSParamToAdmittance(
 
   Complex Y_device = Complex(1, 0) / Z_device;
 
-  int node1 = comp.nodes[0];
-  int node2 = comp.nodes[1];
-
   // Add to admittance matrix like a two-terminal device
   if (node1 > 0) {
     Y[node1 - 1][node1 - 1] += Y_device;
@@ -113,7 +170,7 @@ void SParameterCalculator::addOnePortSParamToAdmittance(
 }
 
 void SParameterCalculator::addTwoPortSParamToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double /*freq*/) {
 
   if (comp.nodes.size() != 2) {
     cerr << "Error: Two-port S-parameter device must have exactly 2 circuit "
@@ -121,53 +178,125 @@ void SParameterCalculator::addTwoPortSParamToAdmittance(
     return;
   }
 
-  double Z0 = comp.referenceImpedance;
+  const vector<vector<Complex>> &S = comp.Smatrix;
+  stampTwoPortSParameters(Y, comp.nodes[0], comp.nodes[1], S[0][0], S[0][1],
+                          S[1][0], S[1][1], comp.referenceImpedance);
+}
+
+void SParameterCalculator::stampTwoPortSParameters(NodalMatrix &Y, int node1,
+                                                   int node2, Complex S11,
+                                                   Complex S12, Complex S21,
+                                                   Complex S22, double Z0) {
+  Complex Yp[4];
+  if (!twoPortSToY(S11, S12, S21, S22, Z0, Yp)) {
+    throw runtime_error("Matrix is singular and cannot be inverted");
+  }
+  stampTwoPortY(Y, node1, node2, Yp);
+}
+
+bool SParameterCalculator::twoPortSToY(Complex S11, Complex S12, Complex S21,
+                                       Complex S22, double Z0, Complex *Y) {
+  // Y = G0 * (I - S) * inv(I + S), with the 2x2 inverse in closed form
+  Complex det = (Complex(1, 0) + S11) * (Complex(1, 0) + S22) - S12 * S21;
+  if (abs(det) < 1e-12) {
+    return false;
+  }
+  Complex k = 1.0 / (Z0 * det);
+
+  Y[0] = k * ((Complex(1, 0) - S11) * (Complex(1, 0) + S22) + S12 * S21);
+  Y[1] = -2.0 * k * S12;
+  Y[2] = -2.0 * k * S21;
+  Y[3] = k * ((Complex(1, 0) + S11) * (Complex(1, 0) - S22) + S12 * S21);
+  return true;
+}
 
-  // Convert 2x2 S-matrix to 2x2 Y-matrix
-  vector<vector<Complex>> Y_device = convertS2Y(comp.Smatrix, Z0);
+void SParameterCalculator::stampTwoPortY(NodalMatrix &Y, int node1, int node2,
+                                         const Complex *Yp) {
+  const Complex &Y11 = Yp[0];
+  const Complex &Y12 = Yp[1];
+  const Complex &Y21 = Yp[2];
+  const Complex &Y22 = Yp[3];
 
-  int node1 = comp.nodes[0]; // Port 1 connection (port 2 grounded)
-  int node2 = comp.nodes[1]; // Port 2 connection (port 1 grounded)
+  // node1: port 1 connection (port 2 grounded)
+  // node2: port 2 connection (port 1 grounded)
 
   // Add Y-parameters to global admittance matrix
   // Y11: self-admittance at node1
   if (node1 > 0) {
-    Y[node1 - 1][node1 - 1] += Y_device[0][0];
+    Y[node1 - 1][node1 - 1] += Y11;
   }
 
   // Y22: self-admittance at node2
   if (node2 > 0) {
-    Y[node2 - 1][node2 - 1] += Y_device[1][1];
+    Y[node2 - 1][node2 - 1] += Y22;
   }
 
   // Y12, Y21: mutual admittances
   if (node1 > 0 && node2 > 0) {
-    Y[node1 - 1][node2 - 1] += Y_device[0][1];
-    Y[node2 - 1][node1 - 1] += Y_device[1][0];
+    Y[node1 - 1][node2 - 1] += Y12;
+    Y[node2 - 1][node1 - 1] += Y21;
   }
 }
 
 void SParameterCalculator::addFrequencyDependentSParamBlockToAdmittance(
-    vector<vector<Complex>> &Y, const Component_SPAR &comp) {
+    NodalMatrix &Y, const Component_SPAR &comp, double freq) {
 
   int numRFPorts = comp.numRFPorts;
+  int numNodes = comp.nodes.size();
 
-  // Get interpolated S-matrix at current frequency
-  vector<vector<Complex>> S_interp =
-      interpolateFrequencyDependentSMatrix(comp, frequency);
+  if (numRFPorts < 1) {
+    cerr << "Error: Frequency-dependent S-parameter device without ports\n";
+    return;
+  }
+  if (numRFPorts == 1 ? (numNodes < 1 || numNodes > 2)
+                      : numNodes != numRFPorts) {
+    cerr << "Error: " << numRFPorts << "-port S-parameter device must have "
+         << (numRFPorts == 1 ? "1 or 2" : to_string(numRFPorts))
+         << " circuit nodes\n";
+    return;
+  }
 
-  // Create temporary component with interpolated S-matrix for processing
-  Component_SPAR tempComp = comp;
-  tempComp.Smatrix = S_interp;
+  shared_ptr<const SParameterTable> table =
+      comp.sTable ? comp.sTable : makeSParameterTable(comp);
+  if (table->size != numRFPorts) {
+    cerr << "Error: S-parameter data does not match the port count\n";
+    return;
+  }
+
+  // The stamps may run concurrently, so the matrix lives on the stack up to
+  // two ports
+  Complex small[4];
+  vector<Complex> large;
+  Complex *S = small;
+  if (numRFPorts > 2) {
+    large.resize(numRFPorts * numRFPorts);
+    S = large.data();
+  }
+
+  // Blocks with more than two ports interpolate the Y-matrices computed at
+  // load time, so no N x N system is solved per frequency
+  if (numRFPorts > 2 && !table->Y.empty()) {
+    interpolateSParameterTable(*table, freq, S, true);
+    stampNPortY(Y, comp.nodes, S);
+    return;
+  }
+
+  // Get interpolated S-matrix at current frequency
+  int sample = interpolateSParameterTable(*table, freq, S);
 
   // Process using the same logic as constant S-parameter blocks
   if (numRFPorts == 1) {
-    addOnePortSParamToAdmittance(Y, tempComp);
-  } else if (numRFPorts == 2) {
-    addTwoPortSParamToAdmittance(Y, tempComp);
+    int node2 = numNodes == 2 ? comp.nodes[1] : 0;
+    stampOnePortSParameters(Y, comp.nodes[0], node2, S[0],
+                            comp.referenceImpedance);
+  } else if (numRFPorts > 2) {
+    stampNPortSParameters(Y, comp.nodes, S, comp.referenceImpedance);
+  } else if (sample >= 0 && !table->Y.empty()) {
+    // On a sample (or outside the data range): Y was computed at load time
+    stampTwoPortY(Y, comp.nodes[0], comp.nodes[1], &table->Y[sample * 4]);
   } else {
-    cerr << "Error: Only 1-port and 2-port frequency-dependent devices "
-            "supported\n";
+    stampTwoPortSParameters(Y, comp.nodes[0], comp.nodes[1], S[0], S[1], S[2],
+                            S[3], comp.referenceImpedance);
   }
 }
 
@@ -176,7 +305,7 @@ void SParameterCalculator::addFrequencyDependentSParamBlockToAdmittance(
 /// @param name Component identifier string
 /// @param nodes Vector of node numbers for connections
 /// @param Smatrix S-parameter matrix (frequency-independent)
-/// @param numRFPorts Number of RF ports (1, 2, 3, or 4)
+/// @param numRFPorts Number of RF ports
 /// @param Z0 Reference impedance for S-parameters (typically 50Ω)
 ///
 void SParameterCalculator::addSParameterDevice(
@@ -184,8 +313,8 @@ void SParameterCalculator::addSParameterDevice(
     const vector<vector<Complex>> &Smatrix, int numRFPorts, double Z0 = 50.0) {
 
   // Validate inputs
-  if (numRFPorts != 1 && numRFPorts != 2) {
-    cerr << "Error: Only 1-port and 2-port devices supported\n";
+  if (numRFPorts < 1) {
+    cerr << "Error: The device must have at least one port\n";
     return;
   }
 
@@ -194,14 +323,18 @@ void SParameterCalculator::addSParameterDevice(
     return;
   }
 
-  if ((numRFPorts == 1 && nodes.size() != 2) ||
-      (numRFPorts == 2 && nodes.size() != 2)) {
+  // One node per port (referred to ground). A one-port may also be connected
+  // between two nodes
+  int numDeviceNodes = nodes.size();
+  if ((numRFPorts == 1 && (numDeviceNodes < 1 || numDeviceNodes > 2)) ||
+      (numRFPorts > 1 && numDeviceNodes != numRFPorts)) {
     cerr << "Error: Node count mismatch for " << numRFPorts << "-port device\n";
     return;
   }
 
   components.emplace_back(ComponentType_SPAR::SPAR_BLOCK, name, nodes, Smatrix,
                           numRFPorts, Z0);
+  plan.valid = false;
 
   // Update numNodes
   for (int node : nodes) {
@@ -216,6 +349,7 @@ void SParameterCalculator::addSParameterBlock(
     const string &name, const vector<int> &nodes,
     const vector<vector<Complex>> &Smatrix) {
   components.emplace_back(ComponentType_SPAR::SPAR_BLOCK, name, nodes, Smatrix);
+  plan.valid = false;
   for (int node : nodes) {
     if (node > numNodes) {
       numNodes = node;
@@ -224,75 +358,135 @@ void SParameterCalculator::addSParameterBlock(
 }
 
 ///
-/// @brief Interpolates S-matrix from frequency-dependent data
-/// @param comp Component containing S-parameter data
-/// @param freq Target frequency for interpolation (Hz)
-/// @return Interpolated S-parameter matrix at specified frequency
-/// @details Performs linear interpolation between adjacent frequency points.
-///          If freq is outside data range, uses nearest endpoint values (no
-///          extrapolation). The real and the imaginary parts are interpolated
-///          independently.
-/// @note Required for frequency-dependent components
+/// @brief Converts the Touchstone data of a frequency-dependent block into an
+/// S-parameter table
+/// @param comp Component with freqDepData
+/// @return Table with the S-matrices (and the Y-matrices of 2-port blocks)
+/// @details The matrix size is the number of RF ports of the component (the
+///          number of nodes if it is not set). Entries missing in the data are
+///          set to zero.
 ///
-vector<vector<Complex>>
-SParameterCalculator::interpolateFrequencyDependentSMatrix(
-    const Component_SPAR &comp, double freq) {
+shared_ptr<const SParameterTable>
+SParameterCalculator::makeSParameterTable(const Component_SPAR &comp) {
+  auto table = make_shared<SParameterTable>();
+  int N = comp.numRFPorts > 0 ? comp.numRFPorts : comp.nodes.size();
+  table->size = N;
 
   if (!comp.freqDepData.contains("frequency")) {
     cerr << "Error: Frequency-dependent S-parameter missing frequency data"
          << endl;
-    int N = comp.nodes.size();
-    return createMatrix(N, N); // Return zero matrix as fallback
+    return table;
   }
 
-  const QList<double> &frequencies = comp.freqDepData["frequency"];
-  int N = comp.nodes.size(); // Number of ports
+  const QList<double> frequencies = comp.freqDepData.value("frequency");
+  int M = frequencies.size();
+  table->frequency.assign(frequencies.begin(), frequencies.end());
+  table->S.assign((size_t)M * N * N, Complex(0, 0));
 
-  if (frequencies.isEmpty()) {
-    return createMatrix(N, N);
+  // The keys are looked up once per matrix entry
+  for (int row = 0; row < N; row++) {
+    for (int col = 0; col < N; col++) {
+      QString key = QString("S%1%2_").arg(row + 1).arg(col + 1);
+      const QList<double> re = comp.freqDepData.value(key + "re");
+      const QList<double> im = comp.freqDepData.value(key + "im");
+      for (int k = 0; k < M; k++) {
+        double realPart = k < re.size() ? re.at(k) : 0.0;
+        double imagPart = k < im.size() ? im.at(k) : 0.0;
+        table->S[(k * N + row) * N + col] = Complex(realPart, imagPart);
+      }
+    }
   }
 
-  // Handle edge cases
-  if (freq <= frequencies.first()) {
-    // Use first frequency point
-    return extractSMatrixAtIndex(comp, 0);
+  // Y-matrices at the samples of the blocks with one node per port. They
+  // are not used if any sample is singular, so that the error is reported by
+  // the stamp
+  if (N >= 2 && N == (int)comp.nodes.size()) {
+    table->Y.resize(table->S.size());
+    for (int k = 0; k < M; k++) {
+      if (!nPortSToY(&table->S[k * N * N], N, comp.referenceImpedance,
+                     &table->Y[k * N * N])) {
+        table->Y.clear();
+        break;
+      }
+    }
   }
-  if (freq >= frequencies.last()) {
-    // Use last frequency point
-    return extractSMatrixAtIndex(comp, frequencies.size() - 1);
+  return table;
+}
+
+int SParameterCalculator::interpolateSParameterTable(
+    const SParameterTable &table, double freq, Complex *S, bool admittance) {
+  const vector<double> &frequencies = table.frequency;
+  const vector<Complex> &data = admittance ? table.Y : table.S;
+  int entries = table.size * table.size;
+
+  if (frequencies.empty()) {
+    fill(S, S + entries, Complex(0, 0));
+    return -1;
   }
 
-  // Find interpolation points
-  int i = 0;
-  for (i = 0; i < frequencies.size() - 1; i++) {
-    if (freq >= frequencies[i] && freq <= frequencies[i + 1]) {
-      break;
+  // Nearest endpoint outside the data range, otherwise the sample interval
+  // [i, i+1] that contains freq
+  int M = frequencies.size();
+  int i = 0, sample = -1;
+  if (freq <= frequencies.front()) {
+    sample = 0;
+  } else if (freq >= frequencies.back()) {
+    sample = M - 1;
+  } else {
+    i = upper_bound(frequencies.begin(), frequencies.end(), freq) -
+        frequencies.begin() - 1;
+    if (freq == frequencies[i]) {
+      sample = i;
     }
   }
+  if (sample >= 0) {
+    copy_n(&data[sample * entries], entries, S);
+    return sample;
+  }
 
-  // Linear interpolation between two frequency points
+  // Linear interpolation between two frequency points. The real and the
+  // imaginary parts are interpolated independently
   double f1 = frequencies[i];
   double f2 = frequencies[i + 1];
   double t = (freq - f1) / (f2 - f1); // Interpolation parameter
 
-  vector<vector<Complex>> S1 = extractSMatrixAtIndex(comp, i);
-  vector<vector<Complex>> S2 = extractSMatrixAtIndex(comp, i + 1);
+  const Complex *S1 = &data[i * entries];
+  const Complex *S2 = &data[(i + 1) * entries];
+  for (int e = 0; e < entries; e++) {
+    double real_interp = S1[e].real() + t * (S2[e].real() - S1[e].real());
+    double imag_interp = S1[e].imag() + t * (S2[e].imag() - S1[e].imag());
+    S[e] = Complex(real_interp, imag_interp);
+  }
+  return -1;
+}
 
-  vector<vector<Complex>> S_interp = createMatrix(N, N);
+///
+/// @brief Interpolates S-matrix from frequency-dependent data
+/// @param comp Component containing S-parameter data
+/// @param freq Target frequency for interpolation (Hz)
+/// @return Interpolated S-parameter matrix at specified frequency
+/// @details Performs linear interpolation between adjacent frequency points.
+///          If freq is outside data range, uses nearest endpoint values (no
+///          extrapolation). The real and the imaginary parts are interpolated
+///          independently.
+/// @note Required for frequency-dependent components
+///
+vector<vector<Complex>>
+SParameterCalculator::interpolateFrequencyDependentSMatrix(
+    const Component_SPAR &comp, double freq) {
+  shared_ptr<const SParameterTable> table =
+      comp.sTable ? comp.sTable : makeSParameterTable(comp);
+  int N = table->size;
+
+  vector<Complex> S(N * N);
+  interpolateSParameterTable(*table, freq, S.data());
 
+  vector<vector<Complex>> S_interp = createMatrix(N, N);
   for (int row = 0; row < N; row++) {
     for (int col = 0; col < N; col++) {
-      // Interpolate real and imaginary parts separately
-      Complex s1 = S1[row][col];
-      Complex s2 = S2[row][col];
-
-      double real_interp = s1.real() + t * (s2.real() - s1.real());
-      double imag_interp = s1.imag() + t * (s2.imag() - s1.imag());
-
-      S_interp[row][col] = Complex(real_interp, imag_interp);
+      S_interp[row][col] = S[row * N + col];
     }
   }
-
   return S_interp;
 }
 
@@ -302,52 +496,30 @@ SParameterCalculator::interpolateFrequencyDependentSMatrix(
 /// @param freqIndex Index into frequency array
 /// @return S-parameter matrix at the indexed frequency point
 /// @details Direct lookup without interpolation.
-/// @note Used when analysis frequency exactly matches a tabulated point, or as
-/// part of interpolation routine.
+/// @note Used when analysis frequency exactly matches a tabulated point.
 ///
 vector<vector<Complex>>
 SParameterCalculator::extractSMatrixAtIndex(const Component_SPAR &comp,
                                             int freqIndex) {
-
-  int N = comp.nodes.size();
+  shared_ptr<const SParameterTable> table =
+      comp.sTable ? comp.sTable : makeSParameterTable(comp);
+  int N = table->size;
   vector<vector<Complex>> S = createMatrix(N, N);
 
+  if (freqIndex < 0 || freqIndex >= (int)table->frequency.size()) {
+    return S;
+  }
   for (int row = 0; row < N; row++) {
     for (int col = 0; col < N; col++) {
-      QString reKey = QString("S%1%2_re")
-                          .arg(QString::number(row + 1),  // %1
-                               QString::number(col + 1)); // %2
-
-      QString imKey = QString("S%1%2_im")
-                          .arg(QString::number(row + 1),  // %1
-                               QString::number(col + 1)); // %2
-
-      double realPart = 0.0, imagPart = 0.0;
-
-      if (comp.freqDepData.contains(reKey)) {
-        const auto &values = comp.freqDepData.value(reKey);
-        if (freqIndex < values.size()) {
-          realPart = values.at(freqIndex);
-        }
-      }
-
-      if (comp.freqDepData.contains(imKey)) {
-        const auto &values = comp.freqDepData.value(imKey);
-        if (freqIndex < values.size()) {
-          imagPart = values.at(freqIndex);
-        }
-      }
-
-      S[row][col] = Complex(realPart, imagPart);
+      S[row][col] = table->S[(freqIndex * N + row) * N + col];
     }
   }
-
   return S;
 }
 
 ///
 /// @brief Parses inline S-matrix from netlist string format
-/// @param matrixStr String containing S-parameters in format: (re,im) (re,im);
+/// @param matrix String containing S-parameters in format: (re,im) (re,im);
 /// ...
 /// @param numPorts Number of ports
 /// @return S-parameter matrix extracted from string
@@ -355,43 +527,45 @@ SParameterCalculator::extractSMatrixAtIndex(const Component_SPAR &comp,
 ///          1-port: (S11_re,S11_im)
 ///          2-port: (S11_re,S11_im) (S12_re,S12_im); (S21_re,S21_im)
 ///          (S22_re,S22_im) Semicolons separate rows, parentheses contain
-///          complex pairs (real,imag).
+///          complex pairs (real,imag). The values are read with
+///          parseScaledToken(), as the rest of the netlist.
 ///
 vector<vector<Complex>>
-SParameterCalculator::parseInlineSMatrix(const QString &matrixStr,
-                                         int numPorts) {
+SParameterCalculator::parseInlineSMatrix(string_view matrix, int numPorts) {
   vector<vector<Complex>> Smat(numPorts,
                                vector<Complex>(numPorts, Complex(0, 0)));
 
-  if (numPorts == 1) {
-    // Parse single entry: (re,im)
-    static const QRegularExpression rx(
-        "\\(([-+]?\\d*\\.?\\d+[a-zA-Z]*),([-+]?\\d*\\.?\\d+[a-zA-Z]*)\\)");
-    QRegularExpressionMatch match = rx.match(matrixStr);
-    if (match.hasMatch()) {
-      double re = parseScaledValue(match.captured(1));
-      double im = parseScaledValue(match.captured(2));
-      Smat[0][0] = Complex(re, im);
+  // One row per semicolon. Empty rows are skipped
+  int r = 0;
+  size_t rowStart = 0;
+  while (r < numPorts && rowStart < matrix.size()) {
+    size_t rowEnd = min(matrix.find(';', rowStart), matrix.size());
+    string_view row = matrix.substr(rowStart, rowEnd - rowStart);
+    rowStart = rowEnd + 1;
+    if (row.empty()) {
+      continue;
     }
-  } else if (numPorts == 2) {
-    // Parse 2x2 matrix entries separated by semicolons
-    QStringList rows = matrixStr.split(";", Qt::SkipEmptyParts);
-
-    for (int r = 0; r < qMin(2, rows.size()); r++) {
-      QString row = rows[r].trimmed();
-      static const QRegularExpression rx(
-          "\\(([-+]?\\d*\\.?\\d+[a-zA-Z]*),([-+]?\\d*\\.?\\d+[a-zA-Z]*)\\)");
-      QRegularExpressionMatchIterator it = rx.globalMatch(row);
-
-      int c = 0;
-      while (it.hasNext() && c < 2) {
-        auto match = it.next();
-        double re = parseScaledValue(match.captured(1));
-        double im = parseScaledValue(match.captured(2));
-        Smat[r][c] = Complex(re, im);
-        c++;
+
+    // Entries: (re,im)
+    size_t pos = 0;
+    int c = 0;
+    while (c < numPorts) {
+      size_t open = row.find('(', pos);
+      size_t comma = row.find(',', open);
+      size_t close = row.find(')', open);
+      if (open == string_view::npos || close == string_view::npos) {
+        break;
+      }
+      pos = close + 1;
+      if (comma > close) {
+        continue; // Not a complex pair
       }
+      double re = parseScaledToken(row.substr(open + 1, comma - open - 1));
+      double im = parseScaledToken(row.substr(comma + 1, close - comma - 1));
+      Smat[r][c] = Complex(re, im);
+      c++;
     }
+    r++;
   }
 
   return Smat;
@@ -0,0 +1,138 @@
+/// @file Subcircuit.cpp
+/// @brief Subcircuit instances, stamped as their port admittance matrix
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "./../SParameterCalculator.h"
+
+#include <set>
+
+void SParameterCalculator::reduceSubcircuit(const Subcircuit &sub, double freq,
+                                            Complex *Yp) {
+  int N = sub.numNodes;
+  int P = sub.numPorts;
+  int I = N - P; // Internal nodes
+
+  ComplexMatrix Yt(N, N);
+  DenseNodalMatrix Y(Yt);
+  for (const Component_SPAR &comp : sub.components) {
+    stampComponent(Y, comp, freq);
+  }
+
+  // The port nodes get gmin from the circuit, the internal nodes get it here
+  double gmin = 1e-12;
+  for (int i = 0; i < I; i++) {
+    Yt(i, i) += Complex(gmin, 0);
+  }
+
+  for (int i = 0; i < P; i++) {
+    for (int j = 0; j < P; j++) {
+      Yp[i * P + j] = Yt(I + i, I + j);
+    }
+  }
+  if (I == 0) {
+    return;
+  }
+
+  // Schur complement of the internal nodes:
+  //   Yp = Ypp - Ypi * inv(Yii) * Yip
+  ComplexMatrix Yii(I, I), X(I, P);
+  for (int a = 0; a < I; a++) {
+    copy(Yt.row(a), Yt.row(a) + I, Yii.row(a));
+    copy(Yt.row(a) + I, Yt.row(a) + N, X.row(a));
+  }
+  vector<int> pivots;
+  luFactorize(Yii, pivots);
+  luSolve(Yii, pivots, X);
+
+  for (int i = 0; i < P; i++) {
+    for (int a = 0; a < I; a++) {
+      Complex y = Yt(I + i, a);
+      if (y == Complex(0, 0)) {
+        continue;
+      }
+      for (int j = 0; j < P; j++) {
+        Yp[i * P + j] -= y * X(a, j);
+      }
+    }
+  }
+}
+
+void SParameterCalculator::stampSubcircuit(NodalMatrix &Y,
+                                           const Component_SPAR &comp,
+                                           double freq) {
+  const Subcircuit &sub = *comp.subcircuit;
+  int P = sub.numPorts;
+
+  auto it = lower_bound(sub.frequency.begin(), sub.frequency.end(), freq);
+  if (it != sub.frequency.end() && *it == freq) {
+    size_t k = it - sub.frequency.begin();
+    if (sub.reduced[k]) {
+      stampNPortY(Y, comp.nodes, &sub.Y[k * P * P]);
+      return;
+    }
+  }
+
+  // Not a sweep frequency
+  vector<Complex> Yp(P * P);
+  reduceSubcircuit(sub, freq, Yp.data());
+  stampNPortY(Y, comp.nodes, Yp.data());
+}
+
+void SParameterCalculator::prepareSubcircuitSweep(const vector<double> &freqs) {
+  int n = freqs.size();
+  if (subcircuits.empty() || n == 0 || !is_sorted(freqs.begin(), freqs.end())) {
+    return;
+  }
+
+  // Subcircuits used by the circuit. A definition only instantiates the ones
+  // defined before it
+  set<const Subcircuit *> used;
+  for (const Component_SPAR &comp : components) {
+    if (comp.type == ComponentType_SPAR::SUBCIRCUIT) {
+      used.insert(comp.subcircuit.get());
+    }
+  }
+  for (auto sub = subcircuits.rbegin(); sub != subcircuits.rend(); ++sub) {
+    if (!used.count(sub->get())) {
+      continue;
+    }
+    for (const Component_SPAR &comp : (*sub)->components) {
+      if (comp.type == ComponentType_SPAR::SUBCIRCUIT) {
+        used.insert(comp.subcircuit.get());
+      }
+    }
+  }
+
+  // The nested subcircuits are reduced first, so their matrices are available
+  // when the outer ones are stamped
+  for (const shared_ptr<Subcircuit> &sub : subcircuits) {
+    if (!used.count(sub.get()) || sub->frequency == freqs) {
+      continue;
+    }
+    int P2 = sub->numPorts * sub->numPorts;
+    sub->frequency.clear();
+    sub->Y.assign((size_t)n * P2, Complex(0, 0));
+    sub->reduced.assign(n, 0);
+
+    // A failed reduction is reported by the point that stamps it
+    runSweepWorkers(n, [&](int first, int last, SolverContext &) {
+      for (int k = first; k < last && !cancelRequested(); k++) {
+        try {
+          reduceSubcircuit(*sub, freqs[k], &sub->Y[(size_t)k * P2]);
+          sub->reduced[k] = 1;
+        } catch (const std::exception &) {
+        }
+      }
+    });
+
+    if (cancelRequested()) {
+      sub->Y.clear();
+      sub->reduced.clear();
+      return;
+    }
+    sub->frequency = freqs;
+  }
+}
@@ -0,0 +1,143 @@
+/// @file SweepResult.cpp
+/// @brief S-parameters of a frequency sweep
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "SweepResult.h"
+
+#include <cmath>
+
+// Number of quantities in SweepResult::Quantity
+static const int QUANTITIES = 5;
+
+SweepResult::SweepResult(int numPorts, double Z0,
+                         const vector<double> &frequency)
+    : ports(numPorts), Z0(Z0), frequency(frequency),
+      S(frequency.size() * numPorts * numPorts),
+      solved(frequency.size(), 0) {}
+
+SweepResult::SweepResult(const SweepResult &other)
+    : ports(other.ports), Z0(other.Z0), frequency(other.frequency),
+      S(other.S), solved(other.solved) {
+  lock_guard<mutex> lock(other.cacheMutex);
+  traces = other.traces;
+}
+
+SweepResult::SweepResult(SweepResult &&other) noexcept
+    : ports(other.ports), Z0(other.Z0), frequency(move(other.frequency)),
+      S(move(other.S)), solved(move(other.solved)),
+      traces(move(other.traces)) {}
+
+SweepResult &SweepResult::operator=(SweepResult other) noexcept {
+  ports = other.ports;
+  Z0 = other.Z0;
+  frequency.swap(other.frequency);
+  S.swap(other.S);
+  solved.swap(other.solved);
+  lock_guard<mutex> lock(cacheMutex);
+  traces.swap(other.traces);
+  return *this;
+}
+
+void SweepResult::clear() {
+  ports = 0;
+  frequency.clear();
+  S.clear();
+  solved.clear();
+  lock_guard<mutex> lock(cacheMutex);
+  traces.clear();
+}
+
+void SweepResult::computeTrace(int i, int j, Quantity quantity,
+                               vector<double> &values) const {
+  values.clear();
+  values.reserve(size());
+  for (size_t k = 0; k < size(); k++) {
+    if (!solved[k]) {
+      continue;
+    }
+    Complex s = at(k, i, j);
+    switch (quantity) {
+    case Quantity::REAL:
+      values.push_back(s.real());
+      break;
+    case Quantity::IMAG:
+      values.push_back(s.imag());
+      break;
+    case Quantity::MAGNITUDE:
+      values.push_back(sqrt(s.real() * s.real() + s.imag() * s.imag()));
+      break;
+    case Quantity::DB:
+      values.push_back(
+          20.0 * log10(sqrt(s.real() * s.real() + s.imag() * s.imag())));
+      break;
+    case Quantity::ANGLE:
+      values.push_back(atan2(s.imag(), s.real()) * 180.0 / M_PI);
+      break;
+    }
+  }
+}
+
+const vector<double> &SweepResult::trace(int i, int j,
+                                         Quantity quantity) const {
+  int key = (i * ports + j) * QUANTITIES + static_cast<int>(quantity);
+  lock_guard<mutex> lock(cacheMutex);
+  auto it = traces.find(key);
+  if (it == traces.end()) {
+    it = traces.emplace(key, vector<double>()).first;
+    computeTrace(i, j, quantity, it->second);
+  }
+  return it->second;
+}
+
+QMap<QString, QList<double>> SweepResult::toDataMap() const {
+  QMap<QString, QList<double>> data;
+  if (ports == 0) {
+    return data;
+  }
+  data["n_ports"].append(ports);
+  data["Z0"].append(Z0);
+  if (empty()) {
+    return data;
+  }
+
+  QList<double> &freq = data["frequency"];
+  freq.reserve(size());
+  for (double f : frequency) {
+    freq.append(f);
+  }
+
+  // The traces already computed are copied, the rest are evaluated here
+  // without keeping them
+  static const pair<const char *, Quantity> keys[] = {
+      {"_dB", Quantity::DB},
+      {"_ang", Quantity::ANGLE},
+      {"_re", Quantity::REAL},
+      {"_im", Quantity::IMAG}};
+  vector<double> values;
+  for (int i = 0; i < ports; i++) {
+    for (int j = 0; j < ports; j++) {
+      QString name = QString("S%1%2").arg(i + 1).arg(j + 1);
+      for (const auto &key : keys) {
+        int cacheKey =
+            (i * ports + j) * QUANTITIES + static_cast<int>(key.second);
+        const vector<double> *trace = nullptr;
+        {
+          lock_guard<mutex> lock(cacheMutex);
+          auto it = traces.find(cacheKey);
+          if (it != traces.end()) {
+            trace = &it->second;
+          }
+        }
+        if (!trace) {
+          computeTrace(i, j, key.second, values);
+          trace = &values;
+        }
+        data[name + key.first] = QList<double>(trace->begin(), trace->end());
+      }
+    }
+  }
+  return data;
+}
@@ -0,0 +1,116 @@
+/// @file SweepResult.h
+/// @brief S-parameters of a frequency sweep
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#ifndef SWEEPRESULT_H
+#define SWEEPRESULT_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <complex>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+using Complex = complex<double>;
+
+/// @class SweepResult
+/// @brief Complex S-matrices of a sweep and the traces derived from them
+/// @details Only the frequencies and the S-matrices are stored. The dB,
+///          magnitude and angle traces are computed the first time they are
+///          requested and then kept. Points that could not be solved hold a
+///          zero matrix and are left out of the traces, as in getData().
+class SweepResult {
+public:
+  /// @enum Quantity
+  /// @brief Derived quantities of an S-parameter
+  enum class Quantity {
+    REAL,      ///< Real part
+    IMAG,      ///< Imaginary part
+    MAGNITUDE, ///< Magnitude (linear)
+    DB,        ///< Magnitude (dB)
+    ANGLE      ///< Angle (degrees)
+  };
+
+  SweepResult() = default;
+
+  /// @brief Creates a result with zero S-matrices, no point solved
+  /// @param numPorts Number of ports
+  /// @param Z0 Reference impedance (Ω)
+  /// @param frequency Frequencies of the points (Hz)
+  SweepResult(int numPorts, double Z0, const vector<double> &frequency);
+
+  SweepResult(const SweepResult &other);
+  SweepResult(SweepResult &&other) noexcept;
+  SweepResult &operator=(SweepResult other) noexcept;
+
+  /// @brief Returns the number of ports
+  int getNumPorts() const { return ports; }
+
+  /// @brief Returns the reference impedance (Ω)
+  double getZ0() const { return Z0; }
+
+  /// @brief Returns the number of points
+  size_t size() const { return frequency.size(); }
+
+  /// @brief Returns true if the result has no points
+  bool empty() const { return frequency.empty(); }
+
+  /// @brief Returns the frequencies of the points (Hz)
+  const vector<double> &getFrequency() const { return frequency; }
+
+  /// @brief Returns the S-matrix of point k, stored by rows
+  const Complex *matrix(size_t k) const { return &S[k * ports * ports]; }
+
+  /// @brief Returns the S-matrix of point k to be written. The derived
+  /// traces are not updated: write the matrices before requesting them
+  Complex *matrix(size_t k) { return &S[k * ports * ports]; }
+
+  /// @brief Returns S(i, j) at point k (0-based indices)
+  Complex at(size_t k, int i, int j) const {
+    return S[(k * ports + i) * ports + j];
+  }
+
+  /// @brief Returns true if point k was solved
+  bool isSolved(size_t k) const { return solved[k] != 0; }
+
+  /// @brief Marks point k as solved or failed
+  void setSolved(size_t k, bool ok) { solved[k] = ok; }
+
+  /// @brief Returns a derived trace of S(i, j), computed on first request
+  /// @param i Row (0-based)
+  /// @param j Column (0-based)
+  /// @param quantity Quantity of the trace
+  /// @return Values at the solved points. The reference stays valid while
+  /// the result is alive
+  const vector<double> &trace(int i, int j, Quantity quantity) const;
+
+  /// @brief Returns the sweep in the format of
+  /// SParameterCalculator::getData(): "n_ports", "Z0", "frequency" and
+  /// S<i><j>_dB, _ang, _re and _im for every port pair
+  QMap<QString, QList<double>> toDataMap() const;
+
+  /// @brief Removes all the points and the ports
+  void clear();
+
+private:
+  /// @brief Evaluates a derived trace into values
+  void computeTrace(int i, int j, Quantity quantity,
+                    vector<double> &values) const;
+
+  int ports = 0;
+  double Z0 = 50;
+  vector<double> frequency; ///< Frequencies (Hz)
+  vector<Complex> S;        ///< S-matrix of point k, (i, j) at (k*N+i)*N+j
+  vector<char> solved;      ///< 1 if the point was solved
+
+  mutable mutex cacheMutex;                ///< Guards traces
+  mutable map<int, vector<double>> traces; ///< Derived traces already used
+};
+
+#endif // SWEEPRESULT_H
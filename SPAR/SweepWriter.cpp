@@ -0,0 +1,146 @@
+/// @file SweepWriter.cpp
+/// @brief Streaming output of S-parameter sweeps (Touchstone, CSV, binary)
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "SweepWriter.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+
+// The buffer is written when it reaches this size (bytes)
+static const size_t WRITE_BLOCK = 1 << 16;
+
+// Touchstone v1 puts at most 4 pairs on a line
+static const int PAIRS_PER_LINE = 4;
+
+// Magnitude written in dB for a zero entry (e.g. an unsolved point), instead
+// of -inf, which the Touchstone and CSV readers reject. Same floor as the
+// viewer uses when it reads a file
+static const double DB_FLOOR = -300;
+
+SweepWriter::SweepWriter(FILE *out, FileType type, DataFormat format)
+    : out(out), type(type), format(format) {
+  buffer.reserve(WRITE_BLOCK + 4096);
+}
+
+string SweepWriter::extension(FileType type, int numPorts) {
+  switch (type) {
+  case FileType::CSV:
+    return ".csv";
+  case FileType::BINARY:
+    return ".sbin";
+  default:
+    return ".s" + to_string(numPorts) + "p";
+  }
+}
+
+void SweepWriter::put(double value) {
+  char text[32];
+  auto result = to_chars(text, text + sizeof(text), value);
+  buffer.append(text, result.ptr);
+}
+
+void SweepWriter::putPair(Complex s, char separator) {
+  double first = s.real(), second = s.imag();
+  if (format != DataFormat::RI) {
+    first = abs(s);
+    second = arg(s) * 180.0 / M_PI;
+    if (format == DataFormat::DB) {
+      first = first > 0 ? max(20.0 * log10(first), DB_FLOOR) : DB_FLOOR;
+    }
+  }
+  put(separator);
+  put(first);
+  put(separator);
+  put(second);
+}
+
+void SweepWriter::beginSweep(int numPorts, double Z0, size_t) {
+  ports = numPorts;
+
+  if (type == FileType::BINARY) {
+    int32_t n = numPorts;
+    put("SPARBIN1");
+    putBinary(&n, sizeof(n));
+    putBinary(&Z0, sizeof(Z0));
+    return;
+  }
+
+  static const char *formatNames[] = {"RI", "MA", "DB"};
+  static const char *columnNames[][2] = {
+      {"_re", "_im"}, {"_mag", "_ang"}, {"_dB", "_ang"}};
+  int f = static_cast<int>(format);
+
+  if (type == FileType::CSV) {
+    put("frequency");
+    for (int i = 1; i <= ports; i++) {
+      for (int j = 1; j <= ports; j++) {
+        string name = "S" + to_string(i) + to_string(j);
+        put(',');
+        put(name + columnNames[f][0]);
+        put(',');
+        put(name + columnNames[f][1]);
+      }
+    }
+    put('\n');
+    return;
+  }
+  put("! Touchstone file generated by SParameterCalculator\n");
+  put("# HZ S ");
+  put(formatNames[f]);
+  put(" R ");
+  put(Z0);
+  put('\n');
+}
+
+void SweepWriter::addPoint(double freq, const Complex *S) {
+  if (type == FileType::BINARY) {
+    putBinary(&freq, sizeof(freq));
+    putBinary(S, ports * ports * sizeof(Complex));
+  } else if (type == FileType::CSV) {
+    put(freq);
+    for (int i = 0; i < ports; i++) {
+      for (int j = 0; j < ports; j++) {
+        putPair(S[i * ports + j], ',');
+      }
+    }
+    put('\n');
+  } else if (ports <= 2) {
+    // 2-port files list the matrix by columns: S11 S21 S12 S22
+    put(freq);
+    for (int j = 0; j < ports; j++) {
+      for (int i = 0; i < ports; i++) {
+        putPair(S[i * ports + j], ' ');
+      }
+    }
+    put('\n');
+  } else {
+    // The rest by rows, each row starting a new line
+    put(freq);
+    for (int i = 0; i < ports; i++) {
+      for (int j = 0; j < ports; j++) {
+        if (j > 0 && j % PAIRS_PER_LINE == 0) {
+          put('\n');
+        }
+        putPair(S[i * ports + j], ' ');
+      }
+      put('\n');
+    }
+  }
+
+  if (buffer.size() >= WRITE_BLOCK) {
+    flush();
+  }
+}
+
+bool SweepWriter::flush() {
+  if (!buffer.empty() && !failed) {
+    failed = fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size();
+  }
+  buffer.clear();
+  return !failed;
+}
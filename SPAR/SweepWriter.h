@@ -0,0 +1,117 @@
+/// @file SweepWriter.h
+/// @brief Streaming output of S-parameter sweeps (Touchstone, CSV, binary)
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#ifndef SWEEPWRITER_H
+#define SWEEPWRITER_H
+
+#include <complex>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using Complex = complex<double>;
+
+/// @class SweepSink
+/// @brief Receives the results of a sweep point by point
+/// @details SParameterCalculator::calculateSParameterSweep(SweepSink&) solves
+///          the sweep in blocks and passes each point to the sink in
+///          frequency order, so the whole sweep is never held in memory.
+class SweepSink {
+public:
+  virtual ~SweepSink() = default;
+
+  /// @brief Called before the first point
+  /// @param numPorts Number of ports
+  /// @param Z0 Reference impedance (Ω)
+  /// @param numPoints Number of points of the sweep
+  virtual void beginSweep(int /*numPorts*/, double /*Z0*/,
+                          size_t /*numPoints*/) {}
+
+  /// @brief Receives the S-matrix of a point. Points that could not be solved
+  /// are passed as a zero matrix
+  /// @param freq Frequency (Hz)
+  /// @param S S-matrix (numPorts x numPorts), stored by rows
+  virtual void addPoint(double freq, const Complex *S) = 0;
+
+  /// @brief Called after the last point. Not called if the sweep is cancelled
+  virtual void endSweep() {}
+};
+
+/// @class SweepWriter
+/// @brief Sink that writes the sweep to a file
+/// @details The numbers are formatted with std::to_chars in their shortest
+///          round-trip form, so reading the file back gives the same doubles.
+///          The text is accumulated in a buffer and written in large blocks.
+class SweepWriter : public SweepSink {
+public:
+  /// @enum FileType
+  /// @brief Output file types
+  enum class FileType {
+    TOUCHSTONE, ///< Touchstone v1, frequency in Hz
+    CSV,        ///< One row per frequency: frequency, S11 pair, S12 pair, ...
+    BINARY      ///< "SPARBIN1", int32 ports, double Z0, then per point the
+                ///< frequency and the S-matrix by rows as (re, im) doubles.
+                ///< Native byte order
+  };
+
+  /// @enum DataFormat
+  /// @brief Representation of the S-parameters in text files
+  enum class DataFormat {
+    RI, ///< Real and imaginary parts
+    MA, ///< Magnitude and angle (degrees)
+    DB  ///< Magnitude in dB and angle (degrees)
+  };
+
+  /// @brief Constructor
+  /// @param out Output stream (a file opened with fopen or stdout). It is
+  /// not closed by the writer
+  /// @param type File type
+  /// @param format Representation of the S-parameters (text files only)
+  SweepWriter(FILE *out, FileType type, DataFormat format = DataFormat::RI);
+
+  /// @brief Destructor. Writes the buffered text
+  ~SweepWriter() override { flush(); }
+
+  SweepWriter(const SweepWriter &) = delete;
+  SweepWriter &operator=(const SweepWriter &) = delete;
+
+  /// @brief Writes the file header (option line or column names)
+  void beginSweep(int numPorts, double Z0, size_t numPoints) override;
+
+  /// @brief Writes the S-matrix of a frequency point
+  void addPoint(double freq, const Complex *S) override;
+
+  /// @brief Writes the buffered data
+  void endSweep() override { flush(); }
+
+  /// @brief Writes the buffered data to the output stream
+  /// @return false if an error occurred while writing
+  bool flush();
+
+  /// @brief Returns the usual file extension of the type (.s2p, .csv, ...)
+  static string extension(FileType type, int numPorts);
+
+private:
+  void put(double value);
+  void put(char c) { buffer.push_back(c); }
+  void put(string_view text) { buffer.append(text); }
+  void putBinary(const void *data, size_t size) {
+    buffer.append(static_cast<const char *>(data), size);
+  }
+  void putPair(Complex s, char separator);
+
+  FILE *out;
+  FileType type;
+  DataFormat format;
+  int ports = 0;
+  string buffer;       ///< Data not written yet
+  bool failed = false; ///< A write failed
+};
+
+#endif // SWEEPWRITER_H
@@ -0,0 +1,69 @@
+/// @file TouchstoneCache.cpp
+/// @brief Process-wide cache of the Touchstone files used by the netlists
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "TouchstoneCache.h"
+
+#include <QFileInfo>
+
+mutex TouchstoneCache::cacheMutex;
+map<QString, TouchstoneCache::Entry> TouchstoneCache::entries;
+
+shared_ptr<const TouchstoneModel>
+TouchstoneCache::load(const QString &filename) {
+  QFileInfo info(filename);
+  QString path = info.canonicalFilePath();
+  if (path.isEmpty()) {
+    return nullptr;
+  }
+  qint64 modified = info.lastModified().toMSecsSinceEpoch();
+  qint64 size = info.size();
+
+  {
+    lock_guard<mutex> lock(cacheMutex);
+    auto it = entries.find(path);
+    if (it != entries.end() && it->second.modified == modified &&
+        it->second.size == size) {
+      return it->second.model;
+    }
+  }
+
+  // The file is read without the lock, so other files can be looked up in
+  // the meantime. If two threads read the same file, the last one is kept
+  auto model = make_shared<TouchstoneModel>();
+  model->data = readTouchstoneFile(path);
+  model->numPorts = model->data.contains("n_ports")
+                        ? (int)model->data["n_ports"].first()
+                        : 0;
+
+  // The table of a file does not depend on the nodes of the component: the
+  // Y-matrices are only built for 2-ports and up, which have one node per
+  // port
+  if (model->numPorts >= 1 && model->numPorts <= 9) {
+    vector<int> nodes(model->numPorts);
+    for (int k = 0; k < model->numPorts; k++) {
+      nodes[k] = k + 1;
+    }
+    Component_SPAR comp(ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK, "",
+                        nodes, model->data, model->numPorts);
+    model->table = comp.sTable;
+  }
+
+  lock_guard<mutex> lock(cacheMutex);
+  entries[path] = Entry{modified, size, model};
+  return model;
+}
+
+void TouchstoneCache::invalidate(const QString &filename) {
+  QString path = QFileInfo(filename).canonicalFilePath();
+  lock_guard<mutex> lock(cacheMutex);
+  entries.erase(path.isEmpty() ? filename : path);
+}
+
+void TouchstoneCache::clear() {
+  lock_guard<mutex> lock(cacheMutex);
+  entries.clear();
+}
@@ -0,0 +1,62 @@
+/// @file TouchstoneCache.h
+/// @brief Process-wide cache of the Touchstone files used by the netlists
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#ifndef TOUCHSTONECACHE_H
+#define TOUCHSTONECACHE_H
+
+#include "SParameterCalculator.h"
+
+#include <mutex>
+
+/// @struct TouchstoneModel
+/// @brief Parsed Touchstone file, shared by all the components that use it
+/// @details It is never modified after it is created, so it can be used from
+///          several engines and threads at once.
+struct TouchstoneModel {
+  QMap<QString, QList<double>> data; ///< Data as returned by readTouchstoneFile()
+  int numPorts = 0;                  ///< Number of ports of the file
+  shared_ptr<const SParameterTable> table; ///< S (and Y) matrices of the data
+};
+
+/// @class TouchstoneCache
+/// @brief Keeps the files read by SPAR netlist lines, so re-parsing a netlist
+/// does not read them again
+/// @details The entries are keyed by canonical path and checked against the
+///          modification time and size of the file on every lookup. A file
+///          that changed is read again. invalidate() drops an entry at once
+///          (e.g. from QFileSystemWatcher::fileChanged), which also covers
+///          edits that keep the time stamp and size.
+class TouchstoneCache {
+public:
+  /// @brief Returns the model of a Touchstone file, reading it if it is not
+  /// cached or has changed
+  /// @param filename Path of the file (.sNp)
+  /// @return Model of the file, or nullptr if it does not exist
+  static shared_ptr<const TouchstoneModel> load(const QString& filename);
+
+  /// @brief Drops the entry of a file. Components already created keep the
+  /// model they hold
+  /// @param filename Path of the file
+  static void invalidate(const QString& filename);
+
+  /// @brief Drops all the entries
+  static void clear();
+
+private:
+  /// @struct Entry
+  /// @brief Cached model and the state of the file when it was read
+  struct Entry {
+    qint64 modified = 0; ///< Modification time (ms since epoch)
+    qint64 size = -1;    ///< Size (bytes)
+    shared_ptr<const TouchstoneModel> model;
+  };
+
+  static mutex cacheMutex;           ///< Guards entries
+  static map<QString, Entry> entries; ///< Entries by canonical path
+};
+
+#endif // TOUCHSTONECACHE_H
@@ -0,0 +1,298 @@
+/// @file adaptive.cpp
+/// @brief Adaptive frequency sampling with local rational models
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "SParameterCalculator.h"
+
+// Points of the grid solved before the first refinement
+static const int ADAPTIVE_INITIAL_POINTS = 17;
+
+// Solved points used by each local rational model
+static const int ADAPTIVE_MODEL_POINTS = 6;
+
+// Fraction of the grid solved before the sampling gives up and solves the
+// rest of the points that are not accepted yet
+static const double ADAPTIVE_MAX_SOLVED = 0.5;
+
+/// @struct LocalModel
+/// @brief Rational models of the S-parameters around a group of solved points
+/// @details Each S-parameter is a Thiele continued fraction through the
+///          points, y(f) = a0 + (f - f0) / (a1 + (f - f1) / (a2 + ...)). The
+///          coefficients are the inverse differences of the solved values, so
+///          building the model costs O(n^2) and evaluating it O(n).
+struct LocalModel {
+  int first = -1;                   ///< First solved point (support index)
+  int n = 0;                        ///< Number of solved points
+  double x[ADAPTIVE_MODEL_POINTS];  ///< Frequencies of the points (Hz)
+  vector<Complex> a;                ///< Coefficients, n per S-parameter
+};
+
+// Builds the models through the solved points [first, first + n) of support
+static void buildModel(const vector<double> &freqs, const SweepResult &result,
+                       const vector<int> &support, int first, int n,
+                       LocalModel &model) {
+  int entries = result.getNumPorts() * result.getNumPorts();
+  model.first = first;
+  model.n = n;
+  model.a.resize(entries * n);
+  for (int k = 0; k < n; k++) {
+    model.x[k] = freqs[support[first + k]];
+  }
+  Complex phi[ADAPTIVE_MODEL_POINTS];
+  for (int e = 0; e < entries; e++) {
+    for (int k = 0; k < n; k++) {
+      phi[k] = result.matrix(support[first + k])[e];
+    }
+    // Inverse differences. A zero difference leaves a coefficient that is not
+    // finite, and the prediction falls back to linear interpolation
+    for (int level = 0; level < n; level++) {
+      for (int k = level + 1; k < n; k++) {
+        phi[k] = (model.x[k] - model.x[level]) / (phi[k] - phi[level]);
+      }
+    }
+    copy(phi, phi + n, &model.a[e * n]);
+  }
+}
+
+// Evaluates the models at freq. Returns false if the result is not finite
+// (freq on a pole of a model)
+static bool evaluateModel(const LocalModel &model, double freq, int entries,
+                          Complex *S) {
+  for (int e = 0; e < entries; e++) {
+    const Complex *a = &model.a[e * model.n];
+    Complex y = a[model.n - 1];
+    for (int k = model.n - 2; k >= 0; k--) {
+      y = a[k] + (freq - model.x[k]) / y;
+    }
+    if (!isfinite(y.real()) || !isfinite(y.imag())) {
+      return false;
+    }
+    S[e] = y;
+  }
+  return true;
+}
+
+// Predicts the S-matrix at a point of the grid from the solved points around
+// it. support holds the indices of the solved points in ascending order. shift
+// moves the group of solved points by that many positions (a neighbouring
+// model). The model is rebuilt only when the group of solved points changes
+static void predictPoint(const vector<double> &freqs, const SweepResult &result,
+                         const vector<int> &support, int point, int shift,
+                         Complex *S, LocalModel &model) {
+  int entries = result.getNumPorts() * result.getNumPorts();
+  int n = min<int>(ADAPTIVE_MODEL_POINTS, support.size());
+  int p = lower_bound(support.begin(), support.end(), point) - support.begin();
+  int first = min(max(p - n / 2 + shift, 0), (int)support.size() - n);
+  if (model.first != first || model.n != n) {
+    buildModel(freqs, result, support, first, n, model);
+  }
+  if (evaluateModel(model, freqs[point], entries, S)) {
+    return;
+  }
+
+  // Linear interpolation between the nearest solved points
+  int left = max(p - 1, 0), right = min(p, (int)support.size() - 1);
+  double fl = freqs[support[left]], fr = freqs[support[right]];
+  double u = (fr > fl) ? (freqs[point] - fl) / (fr - fl) : 0;
+  for (int e = 0; e < entries; e++) {
+    S[e] = (1 - u) * result.matrix(support[left])[e] +
+           u * result.matrix(support[right])[e];
+  }
+}
+
+bool SParameterCalculator::solveAdaptiveSweep(const vector<double> &freqs,
+                                              SweepResult &result,
+                                              vector<string> &errors) {
+  int n = freqs.size();
+  int n_ports = ports.size();
+  int entries = n_ports * n_ports;
+  double Z0 = result.getZ0();
+
+  // The models are built over increasing frequencies. Short or unsorted
+  // grids are solved point by point
+  bool ascending = adjacent_find(freqs.begin(), freqs.end(),
+                                 greater_equal<double>()) == freqs.end();
+  if (n <= 2 * ADAPTIVE_INITIAL_POINTS || !ascending) {
+    solvedPoints += n;
+    return solveSweep(freqs, result, errors, false);
+  }
+
+  // Solves some points of the grid and adds them to the support
+  vector<char> failed(n, 0);
+  vector<int> support;
+  auto solvePoints = [&](const vector<int> &points) {
+    vector<double> subset(points.size());
+    for (size_t k = 0; k < points.size(); k++) {
+      subset[k] = freqs[points[k]];
+    }
+    SweepResult solved(n_ports, Z0, subset);
+    vector<string> subsetErrors(points.size());
+    if (!solveSweep(subset, solved, subsetErrors, false)) {
+      return false;
+    }
+    solvedPoints += points.size();
+    for (size_t k = 0; k < points.size(); k++) {
+      int g = points[k];
+      if (solved.isSolved(k)) {
+        copy(solved.matrix(k), solved.matrix(k) + entries, result.matrix(g));
+        result.setSolved(g, true);
+        support.push_back(g);
+      } else {
+        failed[g] = 1;
+        errors[g] = subsetErrors[k];
+      }
+    }
+    sort(support.begin(), support.end());
+    return true;
+  };
+
+  // Evenly spaced initial points, both ends included
+  vector<int> points;
+  for (int k = 0; k < ADAPTIVE_INITIAL_POINTS; k++) {
+    points.push_back((long long)k * (n - 1) / (ADAPTIVE_INITIAL_POINTS - 1));
+  }
+  if (!solvePoints(points)) {
+    return false;
+  }
+  vector<pair<int, int>> intervals;
+  for (size_t k = 1; k < points.size(); k++) {
+    intervals.push_back({points[k - 1], points[k]});
+  }
+
+  // Each round solves two points inside every open interval, at one and two
+  // thirds of it, and compares them with the prediction of the models. An
+  // interval is accepted when both predictions match the solutions and the
+  // models around the neighbouring groups of solved points agree at all its
+  // other points. Otherwise, its three parts are refined in the next round.
+  // Intervals with fewer than three points inside are solved directly.
+  // The predictions of the accepted intervals are kept in the result, and
+  // an interval is opened again when the points solved later change them
+  vector<pair<int, int>> accepted;
+  LocalModel model, left, right;
+  vector<Complex> S(entries), SLeft(entries), SRight(entries);
+  auto predictionMoved = [&](int g) {
+    predictPoint(freqs, result, support, g, 0, S.data(), model);
+    for (int e = 0; e < entries; e++) {
+      if (abs(S[e] - result.matrix(g)[e]) > adaptiveTolerance) {
+        return true;
+      }
+    }
+    return false;
+  };
+  while (!intervals.empty()) {
+    int count = intervals.size();
+    vector<int> targets, checks(2 * count, -1);
+    for (int k = 0; k < count; k++) {
+      auto [a, b] = intervals[k];
+      if (b - a <= 3) {
+        for (int g = a + 1; g < b; g++) {
+          if (!failed[g]) {
+            targets.push_back(g);
+          }
+        }
+        continue;
+      }
+      for (int q = 0; q < 2; q++) {
+        checks[2 * k + q] = targets.size();
+        targets.push_back(a + (q + 1) * (b - a) / 3);
+      }
+    }
+
+    // Sampling that keeps failing ends by solving the rest of the open
+    // intervals, so it never costs much more than the full sweep
+    if ((support.size() + targets.size()) > ADAPTIVE_MAX_SOLVED * n) {
+      targets.clear();
+      for (auto [a, b] : intervals) {
+        for (int g = a + 1; g < b; g++) {
+          if (!result.isSolved(g) && !failed[g]) {
+            targets.push_back(g);
+          }
+        }
+      }
+      if (!solvePoints(targets)) {
+        return false;
+      }
+      break;
+    }
+
+    vector<Complex> predicted(targets.size() * entries);
+    bool modelReady = support.size() >= 2;
+    for (int c : checks) {
+      if (c >= 0 && modelReady) {
+        predictPoint(freqs, result, support, targets[c], 0,
+                     &predicted[c * entries], model);
+      }
+    }
+
+    if (!solvePoints(targets)) {
+      return false;
+    }
+
+    vector<pair<int, int>> next, kept;
+    for (auto [a, b] : accepted) {
+      bool moved = false;
+      for (int g = a + 1; !moved && g < b; g++) {
+        moved = !result.isSolved(g) && !failed[g] && predictionMoved(g);
+      }
+      (moved ? next : kept).push_back({a, b});
+    }
+    accepted.swap(kept);
+
+    size_t firstAccepted = accepted.size();
+    for (int k = 0; k < count; k++) {
+      if (checks[2 * k] < 0) {
+        continue; // Solved directly
+      }
+      auto [a, b] = intervals[k];
+      int t1 = targets[checks[2 * k]], t2 = targets[checks[2 * k + 1]];
+      bool converged = modelReady;
+      for (int q = 0; converged && q < 2; q++) {
+        int c = checks[2 * k + q];
+        converged = !failed[targets[c]];
+        for (int e = 0; converged && e < entries; e++) {
+          converged = abs(predicted[c * entries + e] -
+                          result.matrix(targets[c])[e]) <= adaptiveTolerance;
+        }
+      }
+      for (int g = a + 1; converged && g < b; g++) {
+        if (result.isSolved(g) || failed[g]) {
+          continue;
+        }
+        predictPoint(freqs, result, support, g, -1, SLeft.data(), left);
+        predictPoint(freqs, result, support, g, 1, SRight.data(), right);
+        for (int e = 0; converged && e < entries; e++) {
+          converged = abs(SLeft[e] - SRight[e]) <= adaptiveTolerance;
+        }
+      }
+      for (auto [from, to] : {pair(a, t1), pair(t1, t2), pair(t2, b)}) {
+        if (to - from > 1) {
+          (converged ? accepted : next).push_back({from, to});
+        }
+      }
+    }
+    for (size_t k = firstAccepted; k < accepted.size(); k++) {
+      for (int g = accepted[k].first + 1; g < accepted[k].second; g++) {
+        if (!result.isSolved(g) && !failed[g]) {
+          predictPoint(freqs, result, support, g, 0, result.matrix(g), model);
+        }
+      }
+    }
+    intervals.swap(next);
+  }
+
+  // The rest of the grid is evaluated from the models. Points that failed to
+  // solve are left unsolved
+  if (support.empty()) {
+    return true;
+  }
+  for (int g = 0; g < n; g++) {
+    if (!result.isSolved(g) && !failed[g]) {
+      predictPoint(freqs, result, support, g, 0, result.matrix(g), model);
+      result.setSolved(g, true);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,86 @@
+/// @file component_params.cpp
+/// @brief Resolution of the named component parameters into typed fields
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "SParameterCalculator.h"
+
+void Component_SPAR::resolveParameters() {
+  params = ComponentParams();
+
+  switch (type) {
+  case ComponentType_SPAR::RESISTOR:
+    params.lumped.value = value.value("R");
+    break;
+
+  case ComponentType_SPAR::CAPACITOR:
+    params.lumped.value = value.value("C");
+    break;
+
+  case ComponentType_SPAR::INDUCTOR:
+    params.lumped.value = value.value("L");
+    break;
+
+  case ComponentType_SPAR::COMPLEX_IMPEDANCE: {
+    Complex Z = Zvalue.value("Z");
+    params.impedance.re = Z.real();
+    params.impedance.im = Z.imag();
+    break;
+  }
+
+  case ComponentType_SPAR::TRANSMISSION_LINE:
+  case ComponentType_SPAR::OPEN_STUB:
+  case ComponentType_SPAR::SHORT_STUB:
+    params.line.Z0 = value.value("Z0");
+    params.line.length = value.value("Length");
+    break;
+
+  case ComponentType_SPAR::COUPLED_LINE:
+    params.coupled.Z0e = value.value("Z0e");
+    params.coupled.Z0o = value.value("Z0o");
+    params.coupled.length = value.value("Length");
+    break;
+
+  case ComponentType_SPAR::IDEAL_COUPLER:
+    params.coupler.k = value.value("k");
+    params.coupler.phase_deg = value.value("phase_deg");
+    params.coupler.Z0 = value.value("Z0");
+    break;
+
+  case ComponentType_SPAR::MICROSTRIP_LINE:
+  case ComponentType_SPAR::MICROSTRIP_COUPLED_LINES:
+  case ComponentType_SPAR::MICROSTRIP_STEP:
+  case ComponentType_SPAR::MICROSTRIP_OPEN:
+  case ComponentType_SPAR::MICROSTRIP_VIA: {
+    MicrostripParams &ms = params.microstrip;
+    if (type == ComponentType_SPAR::MICROSTRIP_LINE) {
+      ms.W = value.value("Width");
+      ms.L = value.value("Length");
+    } else if (type == ComponentType_SPAR::MICROSTRIP_STEP) {
+      ms.W = value.value("W1");
+      ms.W2 = value.value("W2");
+    } else {
+      ms.W = value.value("W");
+      ms.L = value.value("L");
+    }
+    ms.S = value.value("S");
+    ms.D = value.value("D");
+    ms.N = value.value("N");
+    ms.h = value.value("h");
+    ms.er = value.value("er");
+    ms.t = value.value("th", 0.0);
+    ms.tand = value.value("tand", 0.0);
+    ms.rho = value.value("rho", 1e-10);
+    break;
+  }
+
+  case ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK:
+    sTable = SParameterCalculator::makeSParameterTable(*this);
+    break;
+
+  default:
+    break;
+  }
+}
@@ -0,0 +1,253 @@
+/// @file incremental.cpp
+/// @brief Incremental re-simulation of value-only circuit edits
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "SParameterCalculator.h"
+
+// Largest number of modified nodes handled as a low-rank update. Beyond that,
+// the sweep stores new matrices
+static const int INCREMENTAL_MAX_RANK = 16;
+
+// Memory budget for the nodal impedance matrices of a sweep (bytes)
+static const double INCREMENTAL_MAX_BYTES = 256.0 * 1024 * 1024;
+
+// Largest |dY| * |Z| of an update. Beyond it, the correction cancels most of
+// Z (e.g. a value edited to 0 Ω, stamped as 1e12 S) and the point is solved
+// again
+static const double INCREMENTAL_MAX_GAIN = 1e6;
+
+// Smallest ratio between the pivots of the capacitance matrix of an update
+static const double INCREMENTAL_MIN_PIVOT_RATIO = 1e-8;
+
+bool SParameterCalculator::sameValues(const Component_SPAR &a,
+                                      const Component_SPAR &b) {
+  if (a.value != b.value || a.Zvalue != b.Zvalue || a.Smatrix != b.Smatrix ||
+      a.freqDepData != b.freqDepData || a.subcircuit != b.subcircuit) {
+    return false;
+  }
+  if (a.type == ComponentType_SPAR::SPAR_BLOCK ||
+      a.type == ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK) {
+    return a.referenceImpedance == b.referenceImpedance;
+  }
+  return true;
+}
+
+bool SParameterCalculator::sameTopology(const IncrementalBase &base) const {
+  if (base.numNodes != numNodes || base.ports.size() != ports.size() ||
+      base.components.size() != components.size()) {
+    return false;
+  }
+  for (size_t p = 0; p < ports.size(); p++) {
+    if (base.ports[p].node != ports[p].node ||
+        base.ports[p].impedance != ports[p].impedance) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < components.size(); i++) {
+    const Component_SPAR &a = base.components[i];
+    const Component_SPAR &b = components[i];
+    if (a.type != b.type || a.nodes != b.nodes) {
+      return false;
+    }
+    if ((a.type == ComponentType_SPAR::SPAR_BLOCK ||
+         a.type == ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK) &&
+        a.numRFPorts != b.numRFPorts) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SParameterCalculator::IncrementalMode
+SParameterCalculator::prepareIncrementalSweep() {
+  // Ladders are already solved in linear time
+  if (!incrementalSweep || !plan.valid || plan.ladder.valid) {
+    return IncrementalMode::NONE;
+  }
+
+  IncrementalBase &base = incremental;
+  int n_points = sweepFrequencies.size();
+  if (base.frequencies != sweepFrequencies || !sameTopology(base)) {
+    return IncrementalMode::NONE;
+  }
+
+  // Nodes of the components modified since the matrices were stored (or
+  // since the previous sweep, if there are no matrices)
+  base.changed.clear();
+  base.localNodes.clear();
+  for (int i = 0; i < (int)components.size(); i++) {
+    if (sameValues(base.components[i], components[i])) {
+      continue;
+    }
+    base.changed.push_back(i);
+    for (int node : components[i].nodes) {
+      if (node > 0 && find(base.localNodes.begin(), base.localNodes.end(),
+                           node - 1) == base.localNodes.end()) {
+        base.localNodes.push_back(node - 1);
+      }
+    }
+  }
+  bool lowRank = (int)base.localNodes.size() <= INCREMENTAL_MAX_RANK;
+  if ((int)base.Z.size() == n_points) {
+    // Matrices far from the new circuit are dropped. They are stored again
+    // after the next small edit
+    return lowRank ? IncrementalMode::UPDATE : IncrementalMode::NONE;
+  }
+
+  // The matrices are stored after a small value-only edit, when more edits
+  // like it are likely, and only once per circuit. Repeating a sweep or
+  // changing most of the values does not store them
+  if (base.changed.empty() || !lowRank) {
+    return IncrementalMode::NONE;
+  }
+  double bytes = (double)numNodes * numNodes * sizeof(Complex) * n_points;
+  if (bytes > INCREMENTAL_MAX_BYTES) {
+    return IncrementalMode::NONE;
+  }
+  base.Z.assign(n_points, ComplexMatrix()); // One slot per point
+  return IncrementalMode::CAPTURE;
+}
+
+void SParameterCalculator::finishIncrementalSweep(IncrementalMode mode) {
+  if (mode == IncrementalMode::UPDATE) {
+    return; // The stored matrices still belong to the original circuit
+  }
+  IncrementalBase &base = incremental;
+  if (mode == IncrementalMode::NONE) {
+    base.Z.clear();
+  }
+  base.components = components;
+  base.ports = ports;
+  base.numNodes = numNodes;
+  base.frequencies = sweepFrequencies;
+}
+
+void SParameterCalculator::captureNodalImpedance(int index, double freq,
+                                                 SolverContext &ctx,
+                                                 vector<vector<Complex>> &S) {
+  IncrementalBase &base = incremental;
+  int N = numNodes;
+  int numPorts = ports.size();
+
+  // Nodal matrix with the port admittances on the port nodes
+  ComplexMatrix &Yt = ctx.denseSystem;
+  Yt.resize(N, N);
+  DenseNodalMatrix Y(Yt);
+  buildAdmittanceMatrix(Y, freq);
+  for (const Port &port : ports) {
+    Yt(port.node - 1, port.node - 1) += Complex(1.0 / port.impedance, 0);
+  }
+
+  // Z is only sized once the factorization succeeded, so a failed point
+  // leaves an empty slot and is never updated
+  luFactorize(Yt, ctx.pivots);
+  ComplexMatrix &Z = base.Z[index];
+  Z.resize(N, N);
+  for (int i = 0; i < N; i++) {
+    Z(i, i) = Complex(1, 0);
+  }
+  luSolve(Yt, ctx.pivots, Z);
+
+  // Port j is driven by a 2/Zj current source, so V = Z * (2/Zj) e_j
+  for (int i = 0; i < numPorts; i++) {
+    for (int j = 0; j < numPorts; j++) {
+      Complex V =
+          Z(ports[i].node - 1, ports[j].node - 1) * (2.0 / ports[j].impedance);
+      S[i][j] = (i == j) ? V - Complex(1, 0) : V;
+    }
+  }
+}
+
+void SParameterCalculator::updateSParameters(int index, double freq,
+                                             SolverContext &ctx,
+                                             vector<vector<Complex>> &S) {
+  const IncrementalBase &base = incremental;
+  const ComplexMatrix &Z = base.Z[index];
+  if (Z.rows() != numNodes) {
+    throw runtime_error("The nodal impedance matrix is not available");
+  }
+
+  const vector<int> &L = base.localNodes;
+  int r = L.size();
+  int numPorts = ports.size();
+
+  // Admittance change on the modified nodes: dY = new stamps - old stamps
+  ComplexMatrix &dY = ctx.deltaY;
+  ComplexMatrix &dYOld = ctx.deltaYOld;
+  dY.resize(r, r);
+  dYOld.resize(r, r);
+  LocalNodalMatrix newStamps(L, dY);
+  LocalNodalMatrix oldStamps(L, dYOld);
+  for (int i : base.changed) {
+    stampComponent(newStamps, components[i], freq);
+    stampComponent(oldStamps, base.components[i], freq);
+  }
+  for (int a = 0; a < r; a++) {
+    for (int b = 0; b < r; b++) {
+      dY(a, b) -= dYOld(a, b);
+    }
+  }
+
+  // Woodbury identity with U = [e_L]:
+  //   Z' = Z - Z(:,L) * inv(I + dY * Z(L,L)) * dY * Z(L,:)
+  // Only the port rows and columns of Z' are needed
+  ComplexMatrix &K = ctx.capacitance;
+  ComplexMatrix &R = ctx.coupling;
+  K.resize(r, r);
+  R.resize(r, numPorts);
+  for (int a = 0; a < r; a++) {
+    K(a, a) = Complex(1, 0);
+    for (int c = 0; c < r; c++) {
+      Complex d = dY(a, c);
+      if (d == Complex(0, 0)) {
+        continue;
+      }
+      for (int b = 0; b < r; b++) {
+        K(a, b) += d * Z(L[c], L[b]);
+      }
+      for (int p = 0; p < numPorts; p++) {
+        R(a, p) += d * Z(L[c], ports[p].node - 1);
+      }
+    }
+  }
+  // A large correction cancels most of Z, and an ill-conditioned K amplifies
+  // its rounding errors. Both cases are solved again from scratch
+  double dYNorm = 0, ZNorm = 0;
+  for (int a = 0; a < r; a++) {
+    double dYRow = 0, ZRow = 0;
+    for (int b = 0; b < r; b++) {
+      dYRow += abs(dY(a, b));
+      ZRow += abs(Z(L[a], L[b]));
+    }
+    dYNorm = max(dYNorm, dYRow);
+    ZNorm = max(ZNorm, ZRow);
+  }
+  if (dYNorm * ZNorm > INCREMENTAL_MAX_GAIN) {
+    throw runtime_error("The update is too large for the stored matrices");
+  }
+  luFactorize(K, ctx.pivots);
+  double minPivot = HUGE_VAL, maxPivot = 0;
+  for (int a = 0; a < r; a++) {
+    minPivot = min(minPivot, abs(K(a, a)));
+    maxPivot = max(maxPivot, abs(K(a, a)));
+  }
+  if (r > 0 && minPivot < INCREMENTAL_MIN_PIVOT_RATIO * maxPivot) {
+    throw runtime_error("The update is ill-conditioned");
+  }
+  luSolve(K, ctx.pivots, R);
+
+  for (int i = 0; i < numPorts; i++) {
+    int ni = ports[i].node - 1;
+    for (int j = 0; j < numPorts; j++) {
+      Complex z = Z(ni, ports[j].node - 1);
+      for (int a = 0; a < r; a++) {
+        z -= Z(ni, L[a]) * R(a, j);
+      }
+      Complex V = z * (2.0 / ports[j].impedance);
+      S[i][j] = (i == j) ? V - Complex(1, 0) : V;
+    }
+  }
+}
@@ -0,0 +1,204 @@
+/// @file ladder.cpp
+/// @brief ABCD cascade analysis of 2-port ladder circuits
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "SParameterCalculator.h"
+
+void SParameterCalculator::analyzeLadder() {
+  LadderPlan &ladder = plan.ladder;
+  ladder = LadderPlan();
+
+  if (ports.size() != 2) {
+    return;
+  }
+  int in = ports[0].node;
+  int out = ports[1].node;
+  if (in == out) {
+    return;
+  }
+
+  // Classify the components into shunt branches (one terminal grounded) and
+  // series branches (keyed by the pair of nodes)
+  vector<vector<int>> shunt(numNodes + 1);
+  map<pair<int, int>, vector<int>> series;
+  vector<vector<int>> neighbours(numNodes + 1);
+  vector<bool> used(numNodes + 1, false);
+
+  for (int i = 0; i < (int)components.size(); i++) {
+    const Component_SPAR &comp = components[i];
+    switch (comp.type) {
+    case ComponentType_SPAR::RESISTOR:
+    case ComponentType_SPAR::CAPACITOR:
+    case ComponentType_SPAR::INDUCTOR:
+    case ComponentType_SPAR::COMPLEX_IMPEDANCE:
+    case ComponentType_SPAR::OPEN_STUB:
+    case ComponentType_SPAR::SHORT_STUB:
+    case ComponentType_SPAR::TRANSMISSION_LINE:
+      break;
+    default:
+      return; // Not a ladder element
+    }
+    if (comp.nodes.size() != 2) {
+      return;
+    }
+
+    int a = comp.nodes[0];
+    int b = comp.nodes[1];
+    if (comp.type == ComponentType_SPAR::TRANSMISSION_LINE) {
+      if (a == 0 || b == 0 || a == b) {
+        return;
+      }
+    } else if (a == b) {
+      continue; // Shorted element, no contribution
+    }
+
+    if (a == 0 || b == 0) {
+      int node = a + b;
+      shunt[node].push_back(i);
+      used[node] = true;
+      continue;
+    }
+
+    vector<int> &branch = series[{min(a, b), max(a, b)}];
+    if (branch.empty()) {
+      neighbours[a].push_back(b);
+      neighbours[b].push_back(a);
+    }
+    branch.push_back(i);
+    used[a] = used[b] = true;
+  }
+
+  // The series branches must form a simple path from port 1 to port 2
+  vector<int> path = {in};
+  vector<bool> visited(numNodes + 1, false);
+  visited[in] = true;
+  if (neighbours[in].size() != 1 || neighbours[out].size() != 1) {
+    return;
+  }
+  int prev = 0;
+  int cur = in;
+  while (cur != out) {
+    if (cur != in && neighbours[cur].size() != 2) {
+      return;
+    }
+    int next = (neighbours[cur][0] != prev) ? neighbours[cur][0]
+                                            : neighbours[cur].back();
+    if (next == prev || visited[next]) {
+      return;
+    }
+    visited[next] = true;
+    path.push_back(next);
+    prev = cur;
+    cur = next;
+  }
+
+  // Every node with a component must be part of the chain
+  for (int node = 1; node <= numNodes; node++) {
+    if (used[node] && !visited[node]) {
+      return;
+    }
+  }
+
+  auto addSection = [&](LadderSection::Kind kind, const vector<int> &elems) {
+    int first = ladder.elements.size();
+    ladder.elements.insert(ladder.elements.end(), elems.begin(), elems.end());
+    ladder.sections.push_back({kind, first, (int)ladder.elements.size()});
+  };
+
+  for (size_t k = 0; k < path.size(); k++) {
+    addSection(LadderSection::SHUNT, shunt[path[k]]);
+    if (k + 1 == path.size()) {
+      break;
+    }
+
+    const vector<int> &branch =
+        series[{min(path[k], path[k + 1]), max(path[k], path[k + 1])}];
+    bool hasLine = false;
+    for (int i : branch) {
+      hasLine |= components[i].type == ComponentType_SPAR::TRANSMISSION_LINE;
+    }
+    if (hasLine && branch.size() > 1) {
+      ladder.sections.clear();
+      ladder.elements.clear();
+      return; // Lines in parallel with other elements
+    }
+    addSection(hasLine ? LadderSection::LINE : LadderSection::SERIES, branch);
+  }
+
+  ladder.valid = true;
+}
+
+bool SParameterCalculator::solveLadder(double freq,
+                                       vector<vector<Complex>> &S) {
+  const LadderPlan &ladder = plan.ladder;
+  const Complex one(1, 0);
+  const double gmin = 1e-12; // Same as in the nodal analysis
+
+  // ABCD matrix of the cascade
+  Complex A = one, B = 0, C = 0, D = one;
+
+  for (const LadderSection &section : ladder.sections) {
+    if (section.kind == LadderSection::LINE) {
+      const Component_SPAR &line = components[ladder.elements[section.first]];
+      const double c = 299792458.0;
+      double theta = 2 * M_PI * freq / c * line.params.line.length;
+      double sinT = sin(theta);
+      double cosT = cos(theta);
+      if (abs(sinT) < 1e-12) {
+        return false; // Handled as in the nodal analysis
+      }
+      double Z0 = line.params.line.Z0;
+      Complex a(cosT, 0), b(0, Z0 * sinT), cc(0, sinT / Z0), d(cosT, 0);
+      Complex nA = A * a + B * cc;
+      Complex nB = A * b + B * d;
+      Complex nC = C * a + D * cc;
+      Complex nD = C * b + D * d;
+      A = nA;
+      B = nB;
+      C = nC;
+      D = nD;
+      continue;
+    }
+
+    Complex y(0, 0);
+    for (int p = section.first; p < section.last; p++) {
+      y += getAdmittance(components[ladder.elements[p]], freq);
+    }
+
+    if (section.kind == LadderSection::SHUNT) {
+      y += gmin;
+      if (!isfinite(y.real()) || !isfinite(y.imag())) {
+        return false;
+      }
+      A += B * y;
+      C += D * y;
+    } else {
+      if (abs(y) < 1e-12 || !isfinite(y.real()) || !isfinite(y.imag())) {
+        return false; // Open series branch
+      }
+      Complex z = one / y;
+      B += A * z;
+      D += C * z;
+    }
+  }
+
+  // Conversion to S-parameters. The port voltages are referred to the
+  // incident voltage, as in the nodal analysis
+  double Z1 = ports[0].impedance;
+  double Z2 = ports[1].impedance;
+  Complex denom = A * Z2 + B + C * Z1 * Z2 + D * Z1;
+  if (abs(denom) < 1e-300 || !isfinite(abs(denom))) {
+    return false;
+  }
+
+  // Every section has a unit determinant, so AD - BC = 1. Computing it from
+  // the cascade loses all the digits when A, B, C and D are large
+  S[0][0] = (A * Z2 + B - C * Z1 * Z2 - D * Z1) / denom;
+  S[0][1] = 2.0 * Z1 / denom;
+  S[1][0] = 2.0 * Z2 / denom;
+  S[1][1] = (-A * Z2 + B - C * Z1 * Z2 + D * Z1) / denom;
+  return true;
+}
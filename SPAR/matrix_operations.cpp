@@ -10,59 +10,319 @@
 vector<vector<Complex>>
 SParameterCalculator::invertMatrix(const vector<vector<Complex>> &matrix) {
   int n = matrix.size();
-  vector<vector<Complex>> augmented(n, vector<Complex>(2 * n, Complex(0, 0)));
+  ComplexMatrix lu(matrix);
+  vector<int> pivots;
+  luFactorize(lu, pivots);
 
-  // Create augmented matrix [A|I]
+  // Solve A * X = I
+  ComplexMatrix inverse(n, n);
   for (int i = 0; i < n; i++) {
-    for (int j = 0; j < n; j++) {
-      augmented[i][j] = matrix[i][j];
-    }
-    augmented[i][i + n] = Complex(1, 0);
+    inverse(i, i) = Complex(1, 0);
   }
+  luSolve(lu, pivots, inverse);
 
-  // Forward elimination
-  for (int i = 0; i < n; i++) {
+  return inverse.toNested();
+}
+
+void SParameterCalculator::luFactorize(ComplexMatrix &matrix,
+                                       vector<int> &pivots) {
+  int n = matrix.rows();
+  pivots.resize(n);
+
+  for (int k = 0; k < n; k++) {
     // Find pivot
-    int pivot = i;
-    for (int j = i + 1; j < n; j++) {
-      if (abs(augmented[j][i]) > abs(augmented[pivot][i])) {
-        pivot = j;
+    int pivot = k;
+    double pivotMag = abs(matrix(k, k));
+    for (int i = k + 1; i < n; i++) {
+      double mag = abs(matrix(i, k));
+      if (mag > pivotMag) {
+        pivot = i;
+        pivotMag = mag;
       }
     }
 
+    if (pivotMag < 1e-12) {
+      throw runtime_error("Matrix is singular and cannot be inverted");
+    }
+
     // Swap rows
-    if (pivot != i) {
-      swap(augmented[i], augmented[pivot]);
+    pivots[k] = pivot;
+    if (pivot != k) {
+      matrix.swapRows(k, pivot);
     }
 
-    // Make diagonal element 1
-    Complex diag = augmented[i][i];
-    if (abs(diag) < 1e-12) {
-      throw runtime_error("Matrix is singular and cannot be inverted");
+    // Compute the multipliers and update the trailing submatrix. The
+    // multipliers divide by the pivot rather than scaling by its reciprocal:
+    // a row that mirrors the pivot row (e.g. the 1e12 S of a 0 Ω element)
+    // then gets an exact -1 and its large entries cancel exactly
+    const Complex *pivotRow = matrix.row(k);
+    for (int i = k + 1; i < n; i++) {
+      Complex *row = matrix.row(i);
+      if (row[k] == Complex(0, 0)) {
+        continue; // Nothing to eliminate (common in nodal matrices)
+      }
+      Complex factor = row[k] / pivotRow[k];
+      row[k] = factor;
+      for (int j = k + 1; j < n; j++) {
+        row[j] -= factor * pivotRow[j];
+      }
     }
+  }
+}
+
+void SParameterCalculator::luSolve(const ComplexMatrix &lu,
+                                   const vector<int> &pivots,
+                                   ComplexMatrix &rhs) {
+  int n = lu.rows();
+  if (n == 0) {
+    return;
+  }
+  int nrhs = rhs.cols();
 
-    for (int j = 0; j < 2 * n; j++) {
-      augmented[i][j] /= diag;
+  // Apply the row interchanges
+  for (int k = 0; k < n; k++) {
+    if (pivots[k] != k) {
+      rhs.swapRows(k, pivots[k]);
     }
+  }
 
-    // Eliminate column
-    for (int j = 0; j < n; j++) {
-      if (i != j) {
-        Complex factor = augmented[j][i];
-        for (int k = 0; k < 2 * n; k++) {
-          augmented[j][k] -= factor * augmented[i][k];
-        }
+  // Forward substitution (L has unit diagonal)
+  for (int k = 0; k < n; k++) {
+    const Complex *xk = rhs.row(k);
+    for (int i = k + 1; i < n; i++) {
+      Complex factor = lu(i, k);
+      if (factor == Complex(0, 0)) {
+        continue;
+      }
+      Complex *xi = rhs.row(i);
+      for (int c = 0; c < nrhs; c++) {
+        xi[c] -= factor * xk[c];
       }
     }
   }
 
-  // Extract inverse matrix
-  vector<vector<Complex>> inverse(n, vector<Complex>(n));
+  // Back substitution
+  for (int k = n - 1; k >= 0; k--) {
+    Complex *xk = rhs.row(k);
+    const Complex diag = lu(k, k);
+    for (int c = 0; c < nrhs; c++) {
+      xk[c] /= diag;
+    }
+    for (int i = 0; i < k; i++) {
+      Complex factor = lu(i, k);
+      if (factor == Complex(0, 0)) {
+        continue;
+      }
+      Complex *xi = rhs.row(i);
+      for (int c = 0; c < nrhs; c++) {
+        xi[c] -= factor * xk[c];
+      }
+    }
+  }
+}
+
+bool SParameterCalculator::schurDecompose(ComplexMatrix &H, ComplexMatrix &Q) {
+  int n = H.rows();
+  Q.resize(n, n);
+  for (int i = 0; i < n; i++) {
+    Q(i, i) = Complex(1, 0);
+  }
+
+  double matrixNorm = 0;
   for (int i = 0; i < n; i++) {
     for (int j = 0; j < n; j++) {
-      inverse[i][j] = augmented[i][j + n];
+      matrixNorm = max(matrixNorm, abs(H(i, j)));
     }
   }
+  if (matrixNorm == 0) {
+    return true;
+  }
 
-  return inverse;
+  // Householder reduction to upper Hessenberg form
+  vector<Complex> v(n);
+  for (int k = 0; k < n - 2; k++) {
+    double alpha = 0;
+    for (int i = k + 1; i < n; i++) {
+      alpha += norm(H(i, k));
+    }
+    alpha = sqrt(alpha);
+    if (alpha == 0) {
+      continue;
+    }
+    Complex x0 = H(k + 1, k);
+    Complex phase = (abs(x0) > 0) ? x0 / abs(x0) : Complex(1, 0);
+    fill(v.begin(), v.end(), Complex(0, 0));
+    v[k + 1] = x0 + phase * alpha;
+    for (int i = k + 2; i < n; i++) {
+      v[i] = H(i, k);
+    }
+    double vnorm = 0;
+    for (int i = k + 1; i < n; i++) {
+      vnorm += norm(v[i]);
+    }
+    vnorm = sqrt(vnorm);
+    for (int i = k + 1; i < n; i++) {
+      v[i] /= vnorm;
+    }
+    // H = (I - 2 v v^H) H
+    for (int j = 0; j < n; j++) {
+      Complex dot = 0;
+      for (int i = k + 1; i < n; i++) {
+        dot += conj(v[i]) * H(i, j);
+      }
+      dot *= 2.0;
+      for (int i = k + 1; i < n; i++) {
+        H(i, j) -= v[i] * dot;
+      }
+    }
+    // H = H (I - 2 v v^H) and Q = Q (I - 2 v v^H)
+    for (ComplexMatrix *M : {&H, &Q}) {
+      for (int i = 0; i < n; i++) {
+        Complex *row = M->row(i);
+        Complex dot = 0;
+        for (int j = k + 1; j < n; j++) {
+          dot += row[j] * v[j];
+        }
+        dot *= 2.0;
+        for (int j = k + 1; j < n; j++) {
+          row[j] -= dot * conj(v[j]);
+        }
+      }
+    }
+    for (int i = k + 2; i < n; i++) {
+      H(i, k) = Complex(0, 0);
+    }
+  }
+
+  // Shifted QR iteration. The rotations are applied to the whole matrix, so
+  // that it ends upper triangular
+  const double eps = numeric_limits<double>::epsilon();
+  vector<Complex> rc(n), rs(n);
+  int hi = n - 1;
+  int iterations = 0, totalIterations = 0;
+  while (hi > 0) {
+    int l = hi;
+    while (l > 0) {
+      double scale = abs(H(l - 1, l - 1)) + abs(H(l, l));
+      if (scale == 0) {
+        scale = matrixNorm;
+      }
+      if (abs(H(l, l - 1)) <= eps * scale) {
+        H(l, l - 1) = Complex(0, 0);
+        break;
+      }
+      l--;
+    }
+    if (l == hi) {
+      hi--;
+      iterations = 0;
+      continue;
+    }
+    if (++totalIterations > 30 * n) {
+      return false;
+    }
+
+    // Wilkinson shift from the trailing 2x2 block. Exceptional shifts break
+    // cycles
+    Complex shift;
+    if (++iterations % 10 == 0) {
+      shift = H(hi, hi) + abs(H(hi, hi - 1));
+    } else {
+      Complex a = H(hi - 1, hi - 1), b = H(hi - 1, hi), c = H(hi, hi - 1),
+              d = H(hi, hi);
+      Complex half = (a - d) / 2.0;
+      Complex root = sqrt(half * half + b * c);
+      Complex mu1 = d - b * c / (half + root), mu2 = d - b * c / (half - root);
+      if (abs(half + root) == 0) {
+        shift = mu2;
+      } else if (abs(half - root) == 0) {
+        shift = mu1;
+      } else {
+        shift = (abs(mu1 - d) < abs(mu2 - d)) ? mu1 : mu2;
+      }
+      if (!isfinite(shift.real()) || !isfinite(shift.imag())) {
+        shift = d;
+      }
+    }
+
+    // H - shift * I = R (rotations on the rows), then R * G^H + shift * I
+    for (int i = l; i <= hi; i++) {
+      H(i, i) -= shift;
+    }
+    for (int k = l; k < hi; k++) {
+      Complex a = H(k, k), b = H(k + 1, k);
+      double r = hypot(abs(a), abs(b));
+      Complex c = (r > 0) ? a / r : Complex(1, 0);
+      Complex s = (r > 0) ? b / r : Complex(0, 0);
+      rc[k] = c;
+      rs[k] = s;
+      for (int j = k; j < n; j++) {
+        Complex x = H(k, j), y = H(k + 1, j);
+        H(k, j) = conj(c) * x + conj(s) * y;
+        H(k + 1, j) = -s * x + c * y;
+      }
+    }
+    for (int k = l; k < hi; k++) {
+      Complex c = rc[k], s = rs[k];
+      int last = min(k + 1, hi);
+      for (int i = 0; i <= last; i++) {
+        Complex x = H(i, k), y = H(i, k + 1);
+        H(i, k) = x * c + y * s;
+        H(i, k + 1) = -x * conj(s) + y * conj(c);
+      }
+      for (int i = 0; i < n; i++) {
+        Complex x = Q(i, k), y = Q(i, k + 1);
+        Q(i, k) = x * c + y * s;
+        Q(i, k + 1) = -x * conj(s) + y * conj(c);
+      }
+    }
+    for (int i = l; i <= hi; i++) {
+      H(i, i) += shift;
+    }
+  }
+
+  for (int i = 1; i < n; i++) {
+    H(i, i - 1) = Complex(0, 0);
+  }
+  return true;
+}
+
+void SParameterCalculator::swapSchurDiagonal(ComplexMatrix &T,
+                                             ComplexMatrix &Q, int k) {
+  int n = T.rows();
+  Complex t11 = T(k, k), t22 = T(k + 1, k + 1);
+  Complex f = T(k, k + 1), g = t22 - t11;
+  if (g == Complex(0, 0)) {
+    return;
+  }
+
+  // Rotation [c s; -conj(s) c] that takes (f, g) to (r, 0)
+  double c;
+  Complex s;
+  double r = hypot(abs(f), abs(g));
+  if (f == Complex(0, 0)) {
+    c = 0;
+    s = conj(g) / abs(g);
+  } else {
+    c = abs(f) / r;
+    s = (f / abs(f)) * conj(g) / r;
+  }
+
+  for (int j = k + 2; j < n; j++) {
+    Complex x = T(k, j), y = T(k + 1, j);
+    T(k, j) = c * x + s * y;
+    T(k + 1, j) = -conj(s) * x + c * y;
+  }
+  for (int i = 0; i < k; i++) {
+    Complex x = T(i, k), y = T(i, k + 1);
+    T(i, k) = c * x + conj(s) * y;
+    T(i, k + 1) = -s * x + c * y;
+  }
+  for (int i = 0; i < n; i++) {
+    Complex x = Q(i, k), y = Q(i, k + 1);
+    Q(i, k) = c * x + conj(s) * y;
+    Q(i, k + 1) = -s * x + c * y;
+  }
+  T(k, k) = t22;
+  T(k + 1, k + 1) = t11;
 }
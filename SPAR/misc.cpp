@@ -8,26 +8,113 @@
 
 #include "SParameterCalculator.h"
 
+#include <charconv>
+
+static bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' ||
+         c == '\f';
+}
+
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+static bool isLetter(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Skips the digits starting at pos. Returns the number of digits
+static size_t skipDigits(string_view s, size_t &pos) {
+  size_t start = pos;
+  while (pos < s.size() && isDigit(s[pos])) {
+    pos++;
+  }
+  return pos - start;
+}
+
+// Converts [+-]digits[.digits][e[+-]digits] (already validated)
+static double toDouble(string_view s) {
+  bool negative = false;
+  if (!s.empty() && (s[0] == '+' || s[0] == '-')) {
+    negative = (s[0] == '-');
+    s.remove_prefix(1);
+  }
+  double value = 0;
+  if (from_chars(s.data(), s.data() + s.size(), value).ec ==
+      errc::result_out_of_range) {
+    value = strtod(string(s).c_str(), nullptr); // inf or denormal
+  }
+  return negative ? -value : value;
+}
+
+// UTF-8 encoding of the micro sign (µ) and of Â (the micro sign read as
+// Latin-1 by older versions)
+static const string_view MICRO = "\xC2\xB5";
+static const string_view A_CIRCUMFLEX = "\xC3\x82";
+
 double SParameterCalculator::parseScaledValue(const QString &input,
                                               QString unit_type) {
-  // Regex to split number from unit
-  static const QRegularExpression regex(
-      "^\\s*([+-]?(?:\\d+(?:\\.\\d*)?|\\.\\d+)(?:[eE][+-]?\\d+)?)\\s*([a-zA-"
-      "ZÂµ]*)\\s*$");
-  QRegularExpressionMatch match = regex.match(input);
+  QByteArray utf8 = input.toUtf8();
+  return parseScaledToken(string_view(utf8.constData(), utf8.size()),
+                          unit_type == QString("Length"));
+}
 
-  if (!match.hasMatch()) {
+double SParameterCalculator::parseScaledToken(string_view input, bool length) {
+  // Trim
+  size_t pos = 0, end = input.size();
+  while (pos < end && isSpace(input[pos])) {
+    pos++;
+  }
+  while (end > pos && isSpace(input[end - 1])) {
+    end--;
+  }
+  input = input.substr(0, end);
+
+  // Number: [+-]?(\d+(\.\d*)?|\.\d+)([eE][+-]?\d+)?
+  size_t numberStart = pos;
+  if (pos < end && (input[pos] == '+' || input[pos] == '-')) {
+    pos++;
+  }
+  size_t digits = skipDigits(input, pos);
+  if (pos < end && input[pos] == '.') {
+    pos++;
+    digits += skipDigits(input, pos);
+  }
+  if (digits == 0) {
     return 0.0;
   }
+  if (pos < end && (input[pos] == 'e' || input[pos] == 'E')) {
+    // Otherwise, the 'e' is the start of the unit
+    size_t exponent = pos + 1;
+    if (exponent < end && (input[exponent] == '+' || input[exponent] == '-')) {
+      exponent++;
+    }
+    if (skipDigits(input, exponent) > 0) {
+      pos = exponent;
+    }
+  }
+  double value = toDouble(input.substr(numberStart, pos - numberStart));
 
-  double value = match.captured(1).toDouble();
-  QString unit = match.captured(2).trimmed();
+  // Unit: letters and micro signs
+  while (pos < end && isSpace(input[pos])) {
+    pos++;
+  }
+  size_t unitStart = pos;
+  while (pos < end) {
+    if (isLetter(input[pos])) {
+      pos++;
+    } else if (input.substr(pos, 2) == MICRO ||
+               input.substr(pos, 2) == A_CIRCUMFLEX) {
+      pos += 2;
+    } else {
+      return 0.0; // Invalid character
+    }
+  }
+  string_view unit = input.substr(unitStart);
 
-  if (unit_type == QString("Length")) {
-    // Handle explicit length units FIRST (before SI prefixes)
-    static const QMap<QString, double> lengthUnits = {
+  if (length) {
+    // Explicit length units
+    static const pair<string_view, double> lengthUnits[] = {
         {"nm", 1e-9},     // nanometers to meters
-        {"µ", 1e-6},      // micrometers to meters
+        {MICRO, 1e-6},    // micrometers to meters
         {"um", 1e-6},     // micrometers to meters
         {"mm", 1e-3},     // millimeters to meters
         {"cm", 1e-2},     // centimeters to meters
@@ -38,36 +125,104 @@ double SParameterCalculator::parseScaledValue(const QString &input,
         {"in", 0.0254},   // inches to meters
         {"ft", 0.3048}    // feet to meters
     };
+    for (const auto &lengthUnit : lengthUnits) {
+      if (unit == lengthUnit.first) {
+        return value * lengthUnit.second;
+      }
+    }
+    return -1;
+  }
+
+  // SI prefixes for electrical units (capacitance, inductance, etc.). Only
+  // the first character of the unit is the prefix
+  if (unit.empty()) {
+    return value;
+  }
+  if (unit.substr(0, 2) == MICRO) {
+    return value * 1e-6;
+  }
+  switch (unit[0]) {
+  case 'f':
+    return value * 1e-15; // femto
+  case 'p':
+    return value * 1e-12; // pico
+  case 'n':
+    return value * 1e-9; // nano
+  case 'u':
+    return value * 1e-6; // micro
+  case 'm':
+    return value * 1e-3; // mili
+  case 'k':
+  case 'K':
+    return value * 1e3; // kilo
+  case 'M':
+    return value * 1e6; // mega
+  case 'G':
+    return value * 1e9; // giga
+  case 'T':
+    return value * 1e12; // tera
+  default:
+    return value * 1.0;
+  }
+}
 
-    // Check for exact length unit match first
-    if (lengthUnits.contains(unit)) {
-      return value * lengthUnits[unit];
+bool SParameterCalculator::parseImpedanceToken(string_view input, Complex &z) {
+  // Format: [+-]X[kKmM][Ohm][[+-]jX[kKmM][Ohm]] where X is \d*\.?\d+
+  size_t pos = 0;
+
+  // Scans X[kKmM] and returns false if there is no number
+  auto scanValue = [&]() {
+    size_t digits = skipDigits(input, pos);
+    if (pos + 1 < input.size() && input[pos] == '.' &&
+        isDigit(input[pos + 1])) {
+      pos++;
+      digits += skipDigits(input, pos);
     }
-  } else {
-
-    // SI prefixes for electrical units (capacitance, inductance, etc.)
-    static const QMap<QString, double> scaleMap = {
-        {"f", 1e-15}, // femto
-        {"p", 1e-12}, // pico
-        {"n", 1e-9},  // nano
-        {"u", 1e-6},  // micro
-        {"µ", 1e-6},  // micro (Unicode)
-        {"m", 1e-3},  // mili
-        {"", 1.0},    // no prefix
-        {"k", 1e3},   // kilo
-        {"K", 1e3},   // kilo
-        {"M", 1e6},   // mega
-        {"G", 1e9},   // giga
-        {"T", 1e12}   // tera
-    };
+    if (digits == 0) {
+      return false;
+    }
+    if (pos < input.size() && (input[pos] == 'k' || input[pos] == 'K' ||
+                               input[pos] == 'm' || input[pos] == 'M')) {
+      pos++;
+    }
+    return true;
+  };
+  auto skipOhm = [&]() {
+    if (input.substr(pos, 3) == "Ohm") {
+      pos += 3;
+    }
+  };
 
-    // For electrical units, extract first character as prefix
-    QString prefix;
-    if (!unit.isEmpty()) {
-      prefix = QString(unit.at(0));
+  // Real part
+  if (pos < input.size() && (input[pos] == '+' || input[pos] == '-')) {
+    pos++;
+  }
+  if (!scanValue()) {
+    return false;
+  }
+  double real = parseScaledToken(input.substr(0, pos));
+  skipOhm();
+
+  // Imaginary part
+  double imag = 0.0;
+  if (pos + 1 < input.size() && (input[pos] == '+' || input[pos] == '-') &&
+      input[pos + 1] == 'j') {
+    bool negative = (input[pos] == '-');
+    pos += 2;
+    size_t start = pos;
+    if (!scanValue()) {
+      return false;
+    }
+    imag = parseScaledToken(input.substr(start, pos - start));
+    if (negative) {
+      imag = -imag;
     }
-    double scale = scaleMap.value(prefix, 1.0);
-    return value * scale;
+    skipOhm();
+  }
+
+  if (pos != input.size()) {
+    return false;
   }
-  return -1;
+  z = Complex(real, imag);
+  return true;
 }
@@ -0,0 +1,402 @@
+/// @file monte_carlo.cpp
+/// @brief Monte Carlo tolerance and yield analysis
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "SParameterCalculator.h"
+
+#include <random>
+
+// E24 values. E6 and E12 take every fourth and every second value
+static const double E24_VALUES[] = {1.0, 1.1, 1.2, 1.3, 1.5, 1.6, 1.8, 2.0,
+                                    2.2, 2.4, 2.7, 3.0, 3.3, 3.6, 3.9, 4.3,
+                                    4.7, 5.1, 5.6, 6.2, 6.8, 7.5, 8.2, 9.1};
+
+// Returns true if n is the number of values per decade of an E-series
+static bool isESeries(int n) {
+  return n == 6 || n == 12 || n == 24 || n == 48 || n == 96 || n == 192;
+}
+
+// Snaps a value to the nearest value of an E-series (nearest in ratio)
+static double snapToSeries(double value, int series) {
+  if (!isESeries(series) || !(value > 0) || !isfinite(value)) {
+    return value;
+  }
+  double decade = pow(10.0, floor(log10(value)));
+  double mantissa = value / decade;
+
+  // E48 and up are 10^(k/n) with three significant digits. The E192 value
+  // 9.20 is the only one that does not follow the rule
+  double best = 10.0;
+  auto consider = [&](double candidate) {
+    if (fabs(log(mantissa / candidate)) < fabs(log(mantissa / best))) {
+      best = candidate;
+    }
+  };
+  for (int k = 0; k < series; k++) {
+    double candidate;
+    if (series <= 24) {
+      candidate = E24_VALUES[k * (24 / series)];
+    } else if (series == 192 && k == 185) {
+      candidate = 9.20;
+    } else {
+      candidate = round(pow(10.0, (double)k / series) * 100) / 100;
+    }
+    consider(candidate);
+  }
+  return decade * best;
+}
+
+// Draws the relative deviation of a parameter
+static double drawDeviation(const ComponentTolerance &tolerance,
+                            mt19937_64 &rng) {
+  double t = tolerance.tolerance;
+  if (!(t > 0)) {
+    return 0;
+  }
+  if (tolerance.distribution == ComponentTolerance::Distribution::GAUSSIAN) {
+    // Units beyond the tolerance are rejected by the manufacturer
+    normal_distribution<double> normal(0, t / 3);
+    double deviation;
+    do {
+      deviation = normal(rng);
+    } while (fabs(deviation) > t);
+    return deviation;
+  }
+  return uniform_real_distribution<double>(-t, t)(rng);
+}
+
+/// @enum VariedParameter
+/// @brief Component parameters the Monte Carlo analysis can vary
+enum class VariedParameter { LUMPED, WIDTH, WIDTH2, GAP, PERMITTIVITY, HEIGHT };
+
+/// @struct Variation
+/// @brief Parameter of a component that changes between trials
+struct Variation {
+  int component;                        ///< Component index
+  VariedParameter parameter;            ///< Parameter
+  double nominal;                       ///< Nominal value, snapped to its series
+  const ComponentTolerance *tolerance;  ///< Spread
+  int shared;  ///< Index of the deviation shared by the trial (-1: its own)
+};
+
+// Deviations drawn once per trial: the substrate permittivity and height
+static const int SHARED_DEVIATIONS = 2;
+
+// Returns the parameter of a component
+static double &parameterOf(Component_SPAR &comp, VariedParameter parameter) {
+  MicrostripParams &ms = comp.params.microstrip;
+  switch (parameter) {
+  case VariedParameter::WIDTH:
+    return ms.W;
+  case VariedParameter::WIDTH2:
+    return ms.W2;
+  case VariedParameter::GAP:
+    return ms.S;
+  case VariedParameter::PERMITTIVITY:
+    return ms.er;
+  case VariedParameter::HEIGHT:
+    return ms.h;
+  default:
+    return comp.params.lumped.value;
+  }
+}
+
+// Lists the parameters that vary. Returns false if a tolerance is not valid
+static bool findVariations(vector<Component_SPAR> &components,
+                           const MonteCarloSettings &settings,
+                           vector<Variation> &variations) {
+  for (const auto &[key, tolerance] : settings.tolerances) {
+    if (!(tolerance.tolerance >= 0) || tolerance.tolerance >= 1 ||
+        (tolerance.series != 0 && !isESeries(tolerance.series))) {
+      cerr << "Error: Invalid tolerance of " << key << endl;
+      return false;
+    }
+  }
+
+  auto lookup = [&](const string &key) -> const ComponentTolerance * {
+    auto it = settings.tolerances.find(key);
+    return it == settings.tolerances.end() ? nullptr : &it->second;
+  };
+  for (int i = 0; i < (int)components.size(); i++) {
+    Component_SPAR &comp = components[i];
+    auto add = [&](VariedParameter parameter, const ComponentTolerance *tol,
+                   int shared = -1) {
+      if (!tol) {
+        return;
+      }
+      double &value = parameterOf(comp, parameter);
+      value = snapToSeries(value, tol->series);
+      variations.push_back({i, parameter, value, tol, shared});
+    };
+
+    const ComponentTolerance *own = lookup(comp.name);
+    switch (comp.type) {
+    case ComponentType_SPAR::RESISTOR:
+      add(VariedParameter::LUMPED, own ? own : lookup("R"));
+      break;
+    case ComponentType_SPAR::CAPACITOR:
+      add(VariedParameter::LUMPED, own ? own : lookup("C"));
+      break;
+    case ComponentType_SPAR::INDUCTOR:
+      add(VariedParameter::LUMPED, own ? own : lookup("L"));
+      break;
+
+    case ComponentType_SPAR::MICROSTRIP_LINE:
+    case ComponentType_SPAR::MICROSTRIP_OPEN:
+    case ComponentType_SPAR::MICROSTRIP_STEP:
+    case ComponentType_SPAR::MICROSTRIP_COUPLED_LINES:
+      add(VariedParameter::WIDTH, own ? own : lookup("W"));
+      if (comp.type == ComponentType_SPAR::MICROSTRIP_STEP) {
+        add(VariedParameter::WIDTH2, own ? own : lookup("W"));
+      }
+      if (comp.type == ComponentType_SPAR::MICROSTRIP_COUPLED_LINES) {
+        add(VariedParameter::GAP, lookup("S"));
+      }
+      [[fallthrough]];
+    case ComponentType_SPAR::MICROSTRIP_VIA:
+      add(VariedParameter::PERMITTIVITY, lookup("er"), 0);
+      add(VariedParameter::HEIGHT, lookup("h"), 1);
+      break;
+
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+// Sets the parameters of a trial. The draws only depend on the seed and the
+// trial number
+static void applyVariations(vector<Component_SPAR> &components,
+                            const vector<Variation> &variations,
+                            unsigned seed, int trial) {
+  seed_seq sequence{seed, (unsigned)trial};
+  mt19937_64 rng(sequence);
+
+  double shared[SHARED_DEVIATIONS];
+  bool drawn[SHARED_DEVIATIONS] = {};
+  for (const Variation &v : variations) {
+    double deviation;
+    if (v.shared >= 0) {
+      if (!drawn[v.shared]) {
+        shared[v.shared] = drawDeviation(*v.tolerance, rng);
+        drawn[v.shared] = true;
+      }
+      deviation = shared[v.shared];
+    } else {
+      deviation = drawDeviation(*v.tolerance, rng);
+    }
+    parameterOf(components[v.component], v.parameter) =
+        v.nominal * (1 + deviation);
+  }
+}
+
+// Value of a sorted sample at a percentile, interpolated between the two
+// nearest ranks
+static double percentileOf(const vector<float> &sorted, double percentile) {
+  if (sorted.empty()) {
+    return NAN;
+  }
+  double position = percentile / 100 * (sorted.size() - 1);
+  position = min(max(position, 0.0), (double)sorted.size() - 1);
+  size_t below = floor(position);
+  size_t above = min(below + 1, sorted.size() - 1);
+  double u = position - below;
+  return (1 - u) * sorted[below] + u * sorted[above];
+}
+
+bool SParameterCalculator::runMonteCarlo(const MonteCarloSettings &settings,
+                                         MonteCarloResult &result) {
+  result = MonteCarloResult();
+  cancelled = false;
+  const vector<double> freqs = sweepFrequencies;
+  int n_points = freqs.size();
+  int n_ports = ports.size();
+  int trials = settings.trials;
+  if (n_ports == 0 || n_points == 0 || trials <= 0) {
+    cerr << "Error: The Monte Carlo analysis needs ports, frequencies and "
+            "trials"
+         << endl;
+    return false;
+  }
+
+  // S-parameters with envelopes
+  vector<pair<int, int>> traces = settings.traces;
+  if (traces.empty()) {
+    for (int i = 1; i <= n_ports; i++) {
+      for (int j = 1; j <= n_ports; j++) {
+        traces.push_back({i, j});
+      }
+    }
+  }
+  auto validEntry = [&](int row, int col) {
+    return row >= 1 && row <= n_ports && col >= 1 && col <= n_ports;
+  };
+  for (const auto &[row, col] : traces) {
+    if (!validEntry(row, col)) {
+      cerr << "Error: The circuit has no S" << row << col << endl;
+      return false;
+    }
+  }
+
+  // Points of the sweep checked by each limit, with the value of the line
+  int n_limits = settings.limits.size();
+  vector<vector<pair<int, double>>> limitPoints(n_limits);
+  for (int l = 0; l < n_limits; l++) {
+    const MonteCarloLimit &limit = settings.limits[l];
+    if (!validEntry(limit.row, limit.col)) {
+      cerr << "Error: The circuit has no S" << limit.row << limit.col << endl;
+      return false;
+    }
+    for (int k = 0; k < n_points; k++) {
+      double f = freqs[k];
+      if (f < limit.fstart || f > limit.fstop) {
+        continue;
+      }
+      double span = limit.fstop - limit.fstart;
+      double u = span > 0 ? (f - limit.fstart) / span : 0;
+      limitPoints[l].push_back({k, limit.start + u * (limit.stop - limit.start)});
+    }
+  }
+
+  if (!plan.valid) {
+    try {
+      compileCircuit();
+    } catch (const exception &e) {
+      cerr << "Error: " << e.what() << endl;
+      return false;
+    }
+  }
+
+  // The subcircuits do not vary. Their port matrices are computed here, so
+  // the trials only read them
+  prepareSubcircuitSweep(freqs);
+
+  // Each thread runs whole trials on its own copy of the engine, which keeps
+  // the compiled plan and the symbolic analysis of the sparse solver. Only
+  // the values are updated between trials. The stored sweep and the
+  // incremental matrices are not needed by the copies
+  int threads = min(getNumThreads(), trials);
+  vector<SParameterCalculator> engines;
+  {
+    IncrementalBase savedBase = move(incremental);
+    SweepResult savedResult = move(sweepResult);
+    incremental = IncrementalBase();
+    sweepResult = SweepResult();
+    engines.assign(threads, *this);
+    incremental = move(savedBase);
+    sweepResult = move(savedResult);
+  }
+
+  vector<Variation> variations;
+  for (SParameterCalculator &engine : engines) {
+    engine.numThreads = 1;
+    engine.incrementalSweep = false;
+    engine.adaptiveSweep = false;
+    variations.clear();
+    if (!findVariations(engine.components, settings, variations)) {
+      return false;
+    }
+  }
+
+  // |S| (dB) of every trial, trial by trial. Unsolved points are NaN
+  vector<vector<float>> samples(traces.size(),
+                                vector<float>((size_t)trials * n_points));
+  vector<char> unsolved(trials, 0), violated((size_t)trials * n_limits, 0);
+  double Z0 = ports.at(0).impedance;
+
+  atomic<int> next(0);
+  auto worker = [&](SParameterCalculator &engine) {
+    vector<string> errors(n_points);
+    for (int trial = next++; trial < trials && !cancelRequested();
+         trial = next++) {
+      applyVariations(engine.components, variations, settings.seed, trial);
+      engine.updateCircuitValues();
+      SweepResult sweep(n_ports, Z0, freqs);
+      if (!engine.solveSweep(freqs, sweep, errors, false)) {
+        return;
+      }
+
+      for (int k = 0; k < n_points; k++) {
+        unsolved[trial] |= !sweep.isSolved(k);
+      }
+      for (size_t t = 0; t < traces.size(); t++) {
+        float *row = &samples[t][(size_t)trial * n_points];
+        int i = traces[t].first - 1, j = traces[t].second - 1;
+        for (int k = 0; k < n_points; k++) {
+          row[k] = sweep.isSolved(k) ? 20 * log10(abs(sweep.at(k, i, j)))
+                                     : NAN;
+        }
+      }
+      for (int l = 0; l < n_limits; l++) {
+        const MonteCarloLimit &limit = settings.limits[l];
+        for (const auto &[k, value] : limitPoints[l]) {
+          double dB = 20 * log10(abs(sweep.at(k, limit.row - 1, limit.col - 1)));
+          if (limit.upper ? !(dB <= value) : !(dB >= value)) {
+            violated[(size_t)trial * n_limits + l] = 1;
+            break;
+          }
+        }
+      }
+    }
+  };
+  if (threads <= 1) {
+    worker(engines[0]);
+  } else {
+    vector<thread> pool;
+    for (SParameterCalculator &engine : engines) {
+      pool.emplace_back(worker, ref(engine));
+    }
+    for (thread &t : pool) {
+      t.join();
+    }
+  }
+  if (cancelRequested()) {
+    cancelled = true;
+    return false;
+  }
+
+  // Yield
+  result.trials = trials;
+  result.violations.assign(n_limits, 0);
+  for (int trial = 0; trial < trials; trial++) {
+    bool pass = !unsolved[trial];
+    for (int l = 0; l < n_limits; l++) {
+      if (violated[(size_t)trial * n_limits + l]) {
+        result.violations[l]++;
+        pass = false;
+      }
+    }
+    result.passed += pass;
+    result.unsolved += unsolved[trial];
+  }
+
+  // Envelopes, over the trials solved at each point
+  result.frequency = freqs;
+  result.percentiles = settings.percentiles;
+  result.traces = traces;
+  int n_percentiles = settings.percentiles.size();
+  result.envelopes.assign(traces.size(),
+                          vector<double>((size_t)n_percentiles * n_points));
+  vector<float> column;
+  for (size_t t = 0; t < traces.size(); t++) {
+    for (int k = 0; k < n_points; k++) {
+      column.clear();
+      for (int trial = 0; trial < trials; trial++) {
+        float value = samples[t][(size_t)trial * n_points + k];
+        if (!isnan(value)) {
+          column.push_back(value);
+        }
+      }
+      sort(column.begin(), column.end());
+      for (int p = 0; p < n_percentiles; p++) {
+        result.envelopes[t][(size_t)p * n_points + k] =
+            percentileOf(column, settings.percentiles[p]);
+      }
+    }
+  }
+  return true;
+}
@@ -8,77 +8,49 @@
 
 #include "SParameterCalculator.h"
 
-void SParameterCalculator::exportTouchstone(const QString &filename,
-                                            const vector<vector<Complex>> &S) {
-  QFile file(filename);
-  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+// Writes a sweep to a Touchstone file in MA format. Returns false on error
+static bool writeTouchstone(const QString &filename, const SweepResult &sweep) {
+  FILE *out = fopen(QFile::encodeName(filename).constData(), "wb");
+  if (!out) {
     cerr << "Error: Cannot create output file " << filename.toStdString()
          << endl;
-    return;
+    return false;
   }
 
-  QTextStream out(&file);
-
-  // Write header
-  out << "! Touchstone file generated by SParameterCalculator\n";
-  out << "# GHz S MA R " << ports[0].impedance << "\n";
-
-  // Write S-parameters
-  double freqGHz = frequency / 1e9;
-  out << freqGHz;
-
-  for (size_t i = 0; i < S.size(); i++) {
-    for (size_t j = 0; j < S[i].size(); j++) {
-      double mag = abs(S[i][j]);
-      double phase = arg(S[i][j]) * 180.0 / M_PI;
-      out << " " << mag << " " << phase;
+  bool ok;
+  {
+    SweepWriter writer(out, SweepWriter::FileType::TOUCHSTONE,
+                       SweepWriter::DataFormat::MA);
+    writer.beginSweep(sweep.getNumPorts(), sweep.getZ0(), sweep.size());
+    for (size_t i = 0; i < sweep.size(); ++i) {
+      writer.addPoint(sweep.getFrequency()[i], sweep.matrix(i));
     }
+    ok = writer.flush();
   }
+  if (fclose(out) != 0 || !ok) {
+    cerr << "Error: Cannot write " << filename.toStdString() << endl;
+    return false;
+  }
+  return true;
+}
 
-  out << "\n";
-
-  file.close();
-  cout << "S-parameters exported to " << filename.toStdString() << endl;
+void SParameterCalculator::exportTouchstone(const QString &filename,
+                                            const vector<vector<Complex>> &S) {
+  int numPorts = S.size();
+  SweepResult point(numPorts, ports[0].impedance, {frequency});
+  for (int i = 0; i < numPorts; i++) {
+    copy(S[i].begin(), S[i].end(), point.matrix(0) + i * numPorts);
+  }
+  if (writeTouchstone(filename, point)) {
+    cout << "S-parameters exported to " << filename.toStdString() << endl;
+  }
 }
 
 void SParameterCalculator::exportSweepTouchstone(
     const QString &filename) const {
-  QFile file(filename);
-  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-    cerr << "Error: Cannot create output file " << filename.toStdString()
-         << endl;
-    return;
+  if (writeTouchstone(filename, sweepResult)) {
+    cout << "Frequency sweep exported to " << filename.toStdString() << endl;
   }
-
-  QTextStream out(&file);
-
-  // Write header
-  out << "! Touchstone file generated by SParameterCalculator\n";
-  out << "# GHz S MA R " << (ports.empty() ? 50.0 : ports[0].impedance) << "\n";
-
-  // Write S-parameters for each frequency
-  double step = (n_points == 1) ? 0 : (f_stop - f_start) / (n_points - 1);
-
-  for (int i = 0; i < n_points; ++i) {
-    double freq = f_start + i * step;
-    double freqGHz = freq / 1e9;
-    const auto &S = sweepResults[i];
-
-    out << freqGHz;
-
-    for (const auto &rowVec : S) {
-      for (const auto &value : rowVec) {
-        double mag = abs(value);
-        double phase = arg(value) * 180.0 / M_PI;
-        out << " " << mag << " " << phase;
-      }
-    }
-
-    out << "\n";
-  }
-
-  file.close();
-  cout << "Frequency sweep exported to " << filename.toStdString() << endl;
 }
 
 void SParameterCalculator::printSParameters(const vector<vector<Complex>> &S) {
@@ -100,12 +72,9 @@ void SParameterCalculator::printSParameters(const vector<vector<Complex>> &S) {
 }
 
 void SParameterCalculator::printSParameterSweep() const {
-  double step = (n_points == 1) ? 0 : (f_stop - f_start) / (n_points - 1);
-
-  for (int i = 0; i < n_points; ++i) {
-    double freq = f_start + i * step;
-    const auto &S = sweepResults[i];
-    int numPorts = S.size();
+  int numPorts = sweepResult.getNumPorts();
+  for (size_t k = 0; k < sweepResult.size(); ++k) {
+    double freq = sweepResult.getFrequency()[k];
 
     std::cout << "S-Parameters at frequency " << freq / 1e9 << " GHz (" << freq
               << " Hz):\n";
@@ -113,8 +82,9 @@ void SParameterCalculator::printSParameterSweep() const {
 
     for (int i = 0; i < numPorts; ++i) {
       for (int j = 0; j < numPorts; ++j) {
-        double mag = abs(S[i][j]);
-        double phase = arg(S[i][j]) * 180.0 / M_PI;
+        Complex s = sweepResult.at(k, i, j);
+        double mag = abs(s);
+        double phase = arg(s) * 180.0 / M_PI;
         double magDB = 20 * log10(mag);
         std::cout << "S(" << i + 1 << "," << j + 1 << "): " << mag << " ∠"
                   << phase << "° " << "(" << magDB << " dB)\n";
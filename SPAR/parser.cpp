@@ -6,8 +6,145 @@
 /// @license GPL-3.0-or-later
 
 #include "SParameterCalculator.h"
+#include "TouchstoneCache.h"
+
+#include <charconv>
+
+/// @enum NetlistKeyword
+/// @brief Element types of the netlist, given by the prefix of their names
+enum class NetlistKeyword {
+  RESISTOR,
+  CAPACITOR,
+  INDUCTOR,
+  IMPEDANCE,
+  TLIN,
+  OSTUB,
+  SSTUB,
+  MLIN,
+  MSCOUP,
+  MSTEP,
+  MSOPEN,
+  MSVIA,
+  CLIN,
+  COUPLER,
+  PORT,
+  SPAR,
+  SUBCIRCUIT,
+  UNKNOWN
+};
+
+// Keyword dispatch table. Complex impedances (Z...) are identified by the
+// first letter of the name only
+static const pair<string_view, NetlistKeyword> NETLIST_KEYWORDS[] = {
+    {"R", NetlistKeyword::RESISTOR},   {"C", NetlistKeyword::CAPACITOR},
+    {"L", NetlistKeyword::INDUCTOR},   {"TLIN", NetlistKeyword::TLIN},
+    {"OSTUB", NetlistKeyword::OSTUB},  {"SSTUB", NetlistKeyword::SSTUB},
+    {"MLIN", NetlistKeyword::MLIN},    {"MSCOUP", NetlistKeyword::MSCOUP},
+    {"MSTEP", NetlistKeyword::MSTEP},  {"MSOPEN", NetlistKeyword::MSOPEN},
+    {"MSVIA", NetlistKeyword::MSVIA},  {"CLIN", NetlistKeyword::CLIN},
+    {"COUPLER", NetlistKeyword::COUPLER}, {"P", NetlistKeyword::PORT},
+    {"SPAR", NetlistKeyword::SPAR},    {"X", NetlistKeyword::SUBCIRCUIT}};
+
+// Number of cached subcircuit definitions. Beyond that, the cache is
+// restarted
+static const size_t SUBCIRCUIT_CACHE_SIZE = 64;
+
+static bool isNetlistSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Splits a line into whitespace-separated tokens. The tokens point into the
+// line
+static void tokenize(string_view line, vector<string_view> &tokens) {
+  tokens.clear();
+  size_t pos = 0;
+  while (pos < line.size()) {
+    while (pos < line.size() && isNetlistSpace(line[pos])) {
+      pos++;
+    }
+    size_t start = pos;
+    while (pos < line.size() && !isNetlistSpace(line[pos])) {
+      pos++;
+    }
+    if (pos > start) {
+      tokens.push_back(line.substr(start, pos - start));
+    }
+  }
+}
+
+// Returns the line of text starting at pos and moves pos to the next line
+static string_view nextLine(string_view text, size_t &pos) {
+  size_t end = text.find('\n', pos);
+  if (end == string_view::npos) {
+    end = text.size();
+  }
+  string_view line = text.substr(pos, end - pos);
+  pos = end + 1;
+  return line;
+}
+
+// Case-insensitive comparison of a token with a directive (.SUBCKT, .ENDS)
+static bool isDirective(string_view token, string_view directive) {
+  if (token.size() != directive.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < token.size(); i++) {
+    char c = token[i];
+    if (c >= 'a' && c <= 'z') {
+      c -= 'a' - 'A';
+    }
+    if (c != directive[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Element type of a name: the alphabetic prefix when it is followed by a
+// number (R1 -> R), otherwise the whole name
+static NetlistKeyword getKeyword(string_view name) {
+  if (name[0] == 'Z' || name[0] == 'z') {
+    return NetlistKeyword::IMPEDANCE;
+  }
+
+  size_t prefix = 0;
+  while (prefix < name.size() &&
+         ((name[prefix] >= 'A' && name[prefix] <= 'Z') ||
+          (name[prefix] >= 'a' && name[prefix] <= 'z'))) {
+    prefix++;
+  }
+  string_view type = name;
+  if (prefix > 0 && prefix < name.size() && name[prefix] >= '0' &&
+      name[prefix] <= '9') {
+    type = name.substr(0, prefix);
+  }
+
+  for (const auto &keyword : NETLIST_KEYWORDS) {
+    if (type == keyword.first) {
+      return keyword.second;
+    }
+  }
+  return NetlistKeyword::UNKNOWN;
+}
+
+// Node number. It is 0 if the token is not an integer
+static bool parseNode(string_view token, int &node) {
+  node = 0;
+  if (token.size() > 1 && token[0] == '+') {
+    token.remove_prefix(1);
+  }
+  int value = 0;
+  auto result = from_chars(token.data(), token.data() + token.size(), value);
+  if (token.empty() || result.ec != errc() ||
+      result.ptr != token.data() + token.size()) {
+    return false;
+  }
+  node = value;
+  return true;
+}
 
 bool SParameterCalculator::parseNetlist() {
+  chrono::steady_clock::time_point start = startStage();
   if (currentNetlist.isEmpty()) {
     cerr << "Error: No netlist content provided" << endl;
     return false;
@@ -16,417 +153,517 @@ bool SParameterCalculator::parseNetlist() {
   // Clear existing circuit
   clear();
 
-  // Split netlist into lines
-  QStringList lines = currentNetlist.split('\n', Qt::SkipEmptyParts);
+  // The netlist is tokenized in place: the tokens are views of this buffer
+  QByteArray buffer = currentNetlist.toUtf8();
+  string_view netlist(buffer.constData(), buffer.size());
+  components.reserve(count(netlist.begin(), netlist.end(), '\n') + 1);
 
-  for (const QString &line : std::as_const(lines)) {
-    QString trimmedLine = line.trimmed();
+  // The subcircuits may be instantiated before their definition
+  parseSubcircuits(netlist);
+  parseNetlistLines(netlist);
 
-    // Skip comments and empty lines
-    if (trimmedLine.isEmpty() || trimmedLine.startsWith('*')) {
-      continue;
-    }
+  cout << "Parsed " << components.size()
+       << " components, numNodes = " << numNodes << endl;
+  lapStage(stageTimes.parse, start);
+  return true;
+}
 
-    QStringList parts =
-        trimmedLine.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+void SParameterCalculator::parseNetlistLines(string_view text) {
+  vector<string_view> tokens;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    string_view line = nextLine(text, pos);
+    tokenize(line, tokens);
 
-    if (parts.isEmpty()) {
+    // Skip comments and empty lines
+    if (tokens.empty() || tokens[0][0] == '*') {
       continue;
     }
 
-    QString name = parts[0];
-
-    QString type = name;
-    QRegularExpression re("^([A-Za-z]+)\\d+");
-    QRegularExpressionMatch match = re.match(name);
-    if (match.hasMatch()) {
-      type =
-          match.captured(1); // Match only the alphabetic prefix before digits
+    // Skip the subcircuit definitions (see parseSubcircuits())
+    if (isDirective(tokens[0], ".SUBCKT")) {
+      while (pos < text.size()) {
+        tokenize(nextLine(text, pos), tokens);
+        if (!tokens.empty() && isDirective(tokens[0], ".ENDS")) {
+          break;
+        }
+      }
+      continue;
     }
 
+    // Missing fields are read as empty tokens (zero)
+    auto token = [&](size_t i) {
+      return i < tokens.size() ? tokens[i] : string_view();
+    };
+    auto node = [&](size_t i) {
+      int n;
+      parseNode(token(i), n);
+      return n;
+    };
+    auto number = [&](size_t i) { return parseScaledToken(token(i)); };
+    auto length = [&](size_t i) { return parseScaledToken(token(i), true); };
+
+    string name(tokens[0]);
     QMap<QString, double> value;
     QMap<QString, Complex> zValue;
 
-    if (type == QString("R") && parts.size() >= 4) {
+    NetlistKeyword keyword = getKeyword(tokens[0]);
+    switch (keyword) {
+    case NetlistKeyword::RESISTOR:
       // Resistor: R1 node1 node2 value
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-      double R = parseScaledValue(parts[3]);
-      value["R"] = R;
-      addComponent(ComponentType_SPAR::RESISTOR, name.toStdString(),
-                   {node1, node2}, value);
-    } else if (type == QString("C") && parts.size() >= 4) {
+      if (tokens.size() >= 4) {
+        value["R"] = number(3);
+        addComponent(ComponentType_SPAR::RESISTOR, name, {node(1), node(2)},
+                     value);
+      }
+      break;
+
+    case NetlistKeyword::CAPACITOR:
       // Capacitor: C1 node1 node2 value
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-      double C = parseScaledValue(parts[3]);
-      value["C"] = C;
-      addComponent(ComponentType_SPAR::CAPACITOR, name.toStdString(),
-                   {node1, node2}, value);
-    } else if (type == QString("L") && parts.size() >= 4) {
+      if (tokens.size() >= 4) {
+        value["C"] = number(3);
+        addComponent(ComponentType_SPAR::CAPACITOR, name, {node(1), node(2)},
+                     value);
+      }
+      break;
+
+    case NetlistKeyword::INDUCTOR:
       // Inductor: L1 node1 node2 value
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-      double L = parseScaledValue(parts[3]);
-      value["L"] = L;
-      addComponent(ComponentType_SPAR::INDUCTOR, name.toStdString(),
-                   {node1, node2}, value);
-    } else if (name.startsWith("Z", Qt::CaseInsensitive)) {
-      if (parts.size() < 4) {
-        cerr << "Error: Invalid complex impedance definition: "
-             << line.toStdString() << endl;
-        continue;
+      if (tokens.size() >= 4) {
+        value["L"] = number(3);
+        addComponent(ComponentType_SPAR::INDUCTOR, name, {node(1), node(2)},
+                     value);
       }
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-      QString zStr = parts[3];
-
-      // Parse format "R±jX"
-      double realPart = 0.0, imagPart = 0.0;
-      QRegularExpression regex(
-          "^\\s*"
-          "([-+]?\\d*\\.?\\d+(?:[kKmM]?))" // Real part with optional suffix in
-                                           // the same group
-          "\\s*"
-          "(?:Ohm)?"
-          "\\s*"
-          "((?:[-+]\\s*j\\s*\\d*\\.?\\d+(?:[kKmM]?))?)" // Imaginary part with
-                                                        // suffix, everything in
-                                                        // one group
-          "\\s*"
-          "(?:Ohm)?"
-          "\\s*$");
-
-      QRegularExpressionMatch match = regex.match(zStr);
-      if (match.hasMatch()) {
-        realPart = parseScaledValue(match.captured(1));
-        if (match.captured(2).startsWith("+j") ||
-            match.captured(2).startsWith("-j")) {
-          QString imagStr = match.captured(2);
-          imagStr.remove('j');
-          imagPart = parseScaledValue(imagStr);
-        }
+      break;
+
+    case NetlistKeyword::IMPEDANCE: {
+      // Complex impedance: Z1 node1 node2 R±jX
+      if (tokens.size() < 4) {
+        cerr << "Error: Invalid complex impedance definition: " << line
+             << endl;
+        break;
       }
-      Complex z(realPart, imagPart);
+      Complex z(0, 0); // An invalid impedance is read as zero
+      parseImpedanceToken(tokens[3], z);
       zValue["Z"] = z;
-      addComponent(ComponentType_SPAR::COMPLEX_IMPEDANCE, name.toStdString(),
-                   {node1, node2}, zValue);
-    } else if (((type == QString("TLIN")) || (type == QString("OSTUB")) ||
-                (type == QString("SSTUB"))) &&
-               parts.size() >= 5) {
+      addComponent(ComponentType_SPAR::COMPLEX_IMPEDANCE, name,
+                   {node(1), node(2)}, zValue);
+      break;
+    }
+
+    case NetlistKeyword::TLIN:
+    case NetlistKeyword::OSTUB:
+    case NetlistKeyword::SSTUB: {
       // Transmission Line: TLIN node1 node2 impedance length
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-      double Z0 = parseScaledValue(parts[3]);
-      double Length = parseScaledValue(parts[4], QString("Length"));
-      value["Z0"] = Z0;
-      value["Length"] = Length; // Store the properly parsed length
-
-      if (node1 > numNodes) {
-        numNodes = node1;
+      if (tokens.size() < 5) {
+        break;
       }
-      if (node2 > numNodes) {
-        numNodes = node2;
+      value["Z0"] = number(3);
+      value["Length"] = length(4);
+
+      ComponentType_SPAR type = ComponentType_SPAR::TRANSMISSION_LINE;
+      if (keyword == NetlistKeyword::OSTUB) {
+        type = ComponentType_SPAR::OPEN_STUB;
+      } else if (keyword == NetlistKeyword::SSTUB) {
+        type = ComponentType_SPAR::SHORT_STUB;
       }
+      addComponent(type, name, {node(1), node(2)}, value);
+      break;
+    }
 
-      if (type == QString("TLIN")) {
-        addComponent(ComponentType_SPAR::TRANSMISSION_LINE, name.toStdString(),
-                     {node1, node2}, value);
-      } else {
-        if (type == QString("OSTUB")) {
-          addComponent(ComponentType_SPAR::OPEN_STUB, name.toStdString(),
-                       {node1, node2}, value);
-        } else {
-          addComponent(ComponentType_SPAR::SHORT_STUB, name.toStdString(),
-                       {node1, node2}, value);
-        }
-      }
-    } else if ((type == QString("MLIN"))) {
-      // Microstrip Transmission Line: MLIN node1 node2 length width er h cond
+    case NetlistKeyword::MLIN:
+      // Microstrip Transmission Line: MLIN node1 node2 width length er h cond
       // th tand
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-
-      double Width = parseScaledValue(parts[3], QString("Length"));
-      double Length = parseScaledValue(parts[4], QString("Length"));
-      double er = parseScaledValue(
-          parts[5]); // Dielectric permittivity of the substrate
-      double h = parseScaledValue(parts[6]);    // substrate height
-      double cond = parseScaledValue(parts[7]); // Metal conductivity
-      double th = parseScaledValue(parts[8]);   // Metal thickness
-      double tand = parseScaledValue(
-          parts[9]); // Dissipation factor of the substrate material
-
-      value["Width"] = Width;
-      value["Length"] = Length;
-      value["er"] = er;
-      value["h"] = h;
-      value["cond"] = cond;
-      value["th"] = th;
-      value["tand"] = tand;
-
-      addComponent(ComponentType_SPAR::MICROSTRIP_LINE, name.toStdString(),
-                   {node1, node2}, value);
-
-    } else if ((type == QString("MSCOUP"))) {
-      // Microstrip Coupled Transmission Lines: MCOUP node1 node2 node3 node4
+      value["Width"] = length(3);
+      value["Length"] = length(4);
+      value["er"] = number(5);   // Dielectric permittivity of the substrate
+      value["h"] = number(6);    // substrate height
+      value["cond"] = number(7); // Metal conductivity
+      value["th"] = number(8);   // Metal thickness
+      value["tand"] = number(9); // Dissipation factor of the substrate
+      addComponent(ComponentType_SPAR::MICROSTRIP_LINE, name,
+                   {node(1), node(2)}, value);
+      break;
+
+    case NetlistKeyword::MSCOUP:
+      // Microstrip Coupled Transmission Lines: MSCOUP node1 node2 node3 node4
       // width length gap er h cond th tand
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-      int node3 = parts[3].toInt();
-      int node4 = parts[4].toInt();
-
-      double W = parseScaledValue(parts[5], QString("Length"));
-      double L = parseScaledValue(parts[6], QString("Length"));
-      double S = parseScaledValue(parts[7], QString("Length"));
-      double er = parseScaledValue(
-          parts[8]); // Dielectric permittivity of the substrate
-      double h = parseScaledValue(parts[9]);     // substrate height
-      double cond = parseScaledValue(parts[10]); // Metal conductivity
-      double th = parseScaledValue(parts[11]);   // Metal thickness
-      double tand = parseScaledValue(
-          parts[12]); // Dissipation factor of the substrate material
-
-      value["W"] = W;
-      value["L"] = L;
-      value["S"] = S;
-      value["er"] = er;
-      value["h"] = h;
-      value["cond"] = cond;
-      value["th"] = th;
-      value["tand"] = tand;
-
-      addComponent(ComponentType_SPAR::MICROSTRIP_COUPLED_LINES,
-                   name.toStdString(), {node1, node2, node3, node4}, value);
-    } else if ((type == QString("MSTEP"))) {
-      // Microstrip Transmission Line step model: MSTEP node1 node2 length width
-      // er h cond th tand
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-
-      double W1 = parseScaledValue(parts[3], QString("Length"));
-      double W2 = parseScaledValue(parts[4], QString("Length"));
-      double er = parseScaledValue(
-          parts[5]); // Dielectric permittivity of the substrate
-      double h = parseScaledValue(parts[6]);    // substrate height
-      double cond = parseScaledValue(parts[7]); // Metal conductivity
-      double th = parseScaledValue(parts[8]);   // Metal thickness
-      double tand = parseScaledValue(
-          parts[9]); // Dissipation factor of the substrate material
-
-      value["W1"] = W1;
-      value["W2"] = W2;
-      value["er"] = er;
-      value["h"] = h;
-      value["cond"] = cond;
-      value["th"] = th;
-      value["tand"] = tand;
-
-      addComponent(ComponentType_SPAR::MICROSTRIP_STEP, name.toStdString(),
-                   {node1, node2}, value);
-
-    } else if ((type == QString("MSOPEN"))) {
-      // Microstrip Transmission Line step model: MSOPEN node1 node2 length
-      // width er h cond th tand
-      int node1 = parts[1].toInt();
-
-      double W = parseScaledValue(parts[2], QString("Length"));
-      double er = parseScaledValue(
-          parts[3]); // Dielectric permittivity of the substrate
-      double h = parseScaledValue(parts[4]);    // substrate height
-      double cond = parseScaledValue(parts[4]); // Metal conductivity
-      double th = parseScaledValue(parts[6]);   // Metal thickness
-      double tand = parseScaledValue(
-          parts[7]); // Dissipation factor of the substrate material
-
-      value["W"] = W;
-      value["er"] = er;
-      value["h"] = h;
-      value["cond"] = cond;
-      value["th"] = th;
-      value["tand"] = tand;
-
-      addComponent(ComponentType_SPAR::MICROSTRIP_OPEN, name.toStdString(),
-                   {node1}, value);
-
-    } else if ((type == QString("MSVIA"))) {
-      // Microstrip Transmission Line model: MSVIA node1 diameter er h cond th
-      // tand
-      int node1 = parts[1].toInt();
-      double D = parseScaledValue(parts[2], QString("Length")); // Via diameter
-      int N = parts[3].toInt(); // Number of vias in parallel
-      double er = parseScaledValue(
-          parts[4]); // Dielectric permittivity of the substrate
-      double h = parseScaledValue(parts[5]);    // substrate height
-      double cond = parseScaledValue(parts[6]); // Metal conductivity
-      double th = parseScaledValue(parts[7]);   // Metal thickness
-      double tand = parseScaledValue(
-          parts[8]); // Dissipation factor of the substrate material
-
-      value["D"] = D;
-      value["N"] = N;
-      value["er"] = er;
-      value["h"] = h;
-      value["cond"] = cond;
-      value["th"] = th;
-      value["tand"] = tand;
-
-      addComponent(ComponentType_SPAR::MICROSTRIP_VIA, name.toStdString(),
-                   {node1}, value);
-
-    } else if ((type == QString("CLIN")) && (parts.size() >= 7)) {
+      value["W"] = length(5);
+      value["L"] = length(6);
+      value["S"] = length(7);
+      value["er"] = number(8);    // Dielectric permittivity of the substrate
+      value["h"] = number(9);     // substrate height
+      value["cond"] = number(10); // Metal conductivity
+      value["th"] = number(11);   // Metal thickness
+      value["tand"] = number(12); // Dissipation factor of the substrate
+      addComponent(ComponentType_SPAR::MICROSTRIP_COUPLED_LINES, name,
+                   {node(1), node(2), node(3), node(4)}, value);
+      break;
+
+    case NetlistKeyword::MSTEP:
+      // Microstrip Transmission Line step model: MSTEP node1 node2 width1
+      // width2 er h cond th tand
+      value["W1"] = length(3);
+      value["W2"] = length(4);
+      value["er"] = number(5);   // Dielectric permittivity of the substrate
+      value["h"] = number(6);    // substrate height
+      value["cond"] = number(7); // Metal conductivity
+      value["th"] = number(8);   // Metal thickness
+      value["tand"] = number(9); // Dissipation factor of the substrate
+      addComponent(ComponentType_SPAR::MICROSTRIP_STEP, name,
+                   {node(1), node(2)}, value);
+      break;
+
+    case NetlistKeyword::MSOPEN:
+      // Microstrip open end: MSOPEN node1 width er h cond th tand
+      value["W"] = length(2);
+      value["er"] = number(3);   // Dielectric permittivity of the substrate
+      value["h"] = number(4);    // substrate height
+      value["cond"] = number(5); // Metal conductivity
+      value["th"] = number(6);   // Metal thickness
+      value["tand"] = number(7); // Dissipation factor of the substrate
+      addComponent(ComponentType_SPAR::MICROSTRIP_OPEN, name, {node(1)}, value);
+      break;
+
+    case NetlistKeyword::MSVIA:
+      // Microstrip via: MSVIA node1 diameter N er h cond th tand
+      value["D"] = length(2); // Via diameter
+      value["N"] = node(3);   // Number of vias in parallel
+      value["er"] = number(4); // Dielectric permittivity of the substrate
+      value["h"] = number(5);    // substrate height
+      value["cond"] = number(6); // Metal conductivity
+      value["th"] = number(7);   // Metal thickness
+      value["tand"] = number(8); // Dissipation factor of the substrate
+      addComponent(ComponentType_SPAR::MICROSTRIP_VIA, name, {node(1)}, value);
+      break;
+
+    case NetlistKeyword::CLIN:
       // Coupled Line: CLIN1 node1 node2 node3 node4 Z0e Z0o length
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-      int node3 = parts[3].toInt();
-      int node4 = parts[4].toInt();
-      double Z0e = parseScaledValue(parts[5]);
-      double Z0o = parseScaledValue(parts[6]);
-      double Length = parseScaledValue(parts[7], QString("Length"));
-
-      value["Z0e"] = Z0e;
-      value["Z0o"] = Z0o;
-      value["Length"] = Length; // Store the properly parsed length
-
-      // Rest remains the same...
-      for (int node : {node1, node2, node3, node4}) {
-        if (node > numNodes) {
-          numNodes = node;
-        }
+      if (tokens.size() >= 7) {
+        value["Z0e"] = number(5);
+        value["Z0o"] = number(6);
+        value["Length"] = length(7);
+        addComponent(ComponentType_SPAR::COUPLED_LINE, name,
+                     {node(1), node(2), node(3), node(4)}, value);
       }
-      addComponent(ComponentType_SPAR::COUPLED_LINE, name.toStdString(),
-                   {node1, node2, node3, node4}, value);
+      break;
 
-    } else if (type == QString("COUPLER") && parts.size() >= 7) {
+    case NetlistKeyword::COUPLER:
       // Ideal Coupler: COUPLER1 node1 node2 node3 node4 coupling_coefficient
       // phase_deg [Z0]
-      int node1 = parts[1].toInt();
-      int node2 = parts[2].toInt();
-      int node3 = parts[3].toInt();
-      int node4 = parts[4].toInt();
-      double coupling_coeff =
-          parseScaledValue(parts[5]); // Linear coupling coefficient k
-      double phase_deg = parseScaledValue(parts[6]); // Phase shift in degrees
-      double Z0 = 50.0;                              // Default impedance
-      if (parts.size() >= 8) {
-        Z0 = parseScaledValue(parts[7]);
+      if (tokens.size() >= 7) {
+        value["k"] = number(5);         // Linear coupling coefficient
+        value["phase_deg"] = number(6); // Phase shift in degrees
+        value["Z0"] = (tokens.size() >= 8) ? number(7) : 50.0;
+        addComponent(ComponentType_SPAR::IDEAL_COUPLER, name,
+                     {node(1), node(2), node(3), node(4)}, value);
       }
+      break;
 
-      value["k"] = coupling_coeff;    // Store as linear coefficient
-      value["phase_deg"] = phase_deg; // Store phase in degrees
-      value["Z0"] = Z0;
-
-      // Update numNodes
-      for (int node : {node1, node2, node3, node4}) {
-        if (node > numNodes) {
-          numNodes = node;
-        }
-      }
-      addComponent(ComponentType_SPAR::IDEAL_COUPLER, name.toStdString(),
-                   {node1, node2, node3, node4}, value);
-    } else if (type == QString("P") && parts.size() >= 2) {
+    case NetlistKeyword::PORT:
       // Port: P1 node [impedance]
-      int node = parts[1].toInt();
-      double impedance = 50.0; // Default impedance
-      if (parts.size() >= 3) {
-        impedance = parseScaledValue(parts[2]);
+      if (tokens.size() >= 2) {
+        int portNode = node(1);
+        double impedance = (tokens.size() >= 3) ? number(2) : 50.0;
+        // Update numNodes before adding the port
+        if (portNode > numNodes) {
+          numNodes = portNode;
+        }
+        addPort(portNode, impedance);
       }
-      // Update numNodes before adding the port
-      if (node > numNodes) {
-        numNodes = node;
+      break;
+
+    case NetlistKeyword::SPAR:
+      parseSParameterBlock(line, tokens);
+      break;
+
+    case NetlistKeyword::SUBCIRCUIT:
+      parseSubcircuitInstance(line, tokens);
+      break;
+
+    case NetlistKeyword::UNKNOWN:
+      break;
+    }
+  }
+}
+
+void SParameterCalculator::parseSubcircuits(string_view text) {
+  vector<string_view> tokens;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    string_view header = nextLine(text, pos);
+    tokenize(header, tokens);
+    if (tokens.empty() || !isDirective(tokens[0], ".SUBCKT")) {
+      continue;
+    }
+
+    // .SUBCKT name port1 ... portN
+    bool valid = tokens.size() >= 3;
+    string name = (tokens.size() >= 2) ? string(tokens[1]) : string();
+    vector<int> portNodes;
+    for (size_t k = 2; k < tokens.size(); k++) {
+      int node;
+      if (!parseNode(tokens[k], node) || node <= 0 ||
+          find(portNodes.begin(), portNodes.end(), node) != portNodes.end()) {
+        valid = false;
       }
-      addPort(node, impedance);
-    } else if (type == QString("SPAR")) {
-      if (parts.size() < 4) {
-        cerr << "Error: Invalid SPAR definition: " << line.toStdString()
-             << endl;
+      portNodes.push_back(node);
+    }
+    if (!valid) {
+      cerr << "Error: Invalid subcircuit definition: " << header << endl;
+    }
+
+    // The body ends at the first .ENDS
+    size_t bodyStart = pos, bodyEnd = pos;
+    bool closed = false;
+    while (pos < text.size()) {
+      size_t lineStart = pos;
+      tokenize(nextLine(text, pos), tokens);
+      if (tokens.empty()) {
         continue;
       }
+      if (isDirective(tokens[0], ".ENDS")) {
+        bodyEnd = lineStart;
+        closed = true;
+        break;
+      }
+      if (isDirective(tokens[0], ".SUBCKT")) {
+        cerr << "Error: Nested subcircuit definitions are not supported ("
+             << name << ")\n";
+        valid = false;
+      }
+    }
+    if (!closed) {
+      cerr << "Error: Missing .ENDS in subcircuit " << name << endl;
+      continue;
+    }
+    if (!valid) {
+      continue;
+    }
+    bool duplicated = any_of(
+        subcircuits.begin(), subcircuits.end(),
+        [&](const shared_ptr<Subcircuit> &sub) { return sub->name == name; });
+    if (duplicated) {
+      cerr << "Error: Subcircuit " << name << " is already defined\n";
+      continue;
+    }
 
-      // Extract nodes
-      QVector<int> nodes;
-      int idx = 1;
+    // The body is parsed by the same code as the circuit, into the definition
+    string_view body = text.substr(bodyStart, bodyEnd - bodyStart);
+    auto sub = make_shared<Subcircuit>();
+    vector<Port> bodyPorts;
+    int circuitNodes = numNodes;
+    numNodes = 0;
+    components.swap(sub->components);
+    ports.swap(bodyPorts);
+    parseNetlistLines(body);
+    components.swap(sub->components);
+    ports.swap(bodyPorts);
+    int bodyNodes = numNodes;
+    numNodes = circuitNodes;
+
+    if (!bodyPorts.empty()) {
+      cerr << "Warning: Ports are ignored in subcircuit " << name << endl;
+    }
 
-      // Parse exactly 2 nodes for both 1-port and 2-port devices
-      for (int i = 0; i < 2 && idx < parts.size(); i++, idx++) {
-        bool ok;
-        int node = parts[idx].toInt(&ok);
-        if (!ok) {
-          cerr << "Error: Invalid node in SPAR definition\n";
-          break;
-        }
-        nodes.push_back(node);
-        if (node > numNodes) {
-          numNodes = node;
-        }
+    // Local numbering: internal nodes first, then the ports in order
+    for (int node : portNodes) {
+      bodyNodes = max(bodyNodes, node);
+    }
+    vector<int> local(bodyNodes + 1, 0);
+    int numInternal = 0;
+    for (int node = 1; node <= bodyNodes; node++) {
+      if (find(portNodes.begin(), portNodes.end(), node) == portNodes.end()) {
+        local[node] = ++numInternal;
       }
+    }
+    for (size_t k = 0; k < portNodes.size(); k++) {
+      local[portNodes[k]] = numInternal + k + 1;
+    }
+    for (Component_SPAR &comp : sub->components) {
+      for (int &node : comp.nodes) {
+        node = local[node];
+      }
+    }
 
-      if (nodes.size() != 2) {
-        cerr << "Error: SPAR must have exactly 2 nodes\n";
-        continue;
+    sub->name = name;
+    sub->numNodes = bodyNodes;
+    sub->numPorts = portNodes.size();
+
+    // The definition is identified by its text, the ones of the subcircuits
+    // it instantiates and the Touchstone data it loaded. The cache returns
+    // new data once a file changes, and a cached definition keeps the old
+    // data alive, so its address is never reused for another file
+    sub->key = string(header) + "\n" + string(body);
+    for (const Component_SPAR &comp : sub->components) {
+      if (comp.type == ComponentType_SPAR::SUBCIRCUIT) {
+        sub->key += "\n" + comp.subcircuit->key;
+      } else if (comp.sTable) {
+        sub->key += "\n" + to_string((uintptr_t)comp.sTable.get());
+      }
+    }
+
+    // An unchanged definition keeps its port admittance matrices
+    auto cached = subcircuitCache.find(sub->key);
+    if (cached != subcircuitCache.end()) {
+      sub = cached->second;
+    } else {
+      if (subcircuitCache.size() >= SUBCIRCUIT_CACHE_SIZE) {
+        subcircuitCache.clear();
       }
+      subcircuitCache[sub->key] = sub;
+    }
+    subcircuits.push_back(sub);
+  }
+}
 
-      // Determine port count based on nodes: if one node is 0 (GND), it's
-      // 1-port
-      int numRFPorts = (nodes[0] == 0 || nodes[1] == 0) ? 1 : 2;
+void SParameterCalculator::parseSubcircuitInstance(
+    string_view line, const vector<string_view> &tokens) {
+  // X1 node1 ... nodeN name
+  if (tokens.size() < 3) {
+    cerr << "Error: Invalid subcircuit instance: " << line << endl;
+    return;
+  }
 
-      // Check if next part is a filename
-      if (idx < parts.size() && !parts[idx].startsWith("(")) {
-        QString filename = parts[idx];
+  string_view subName = tokens.back();
+  shared_ptr<const Subcircuit> sub;
+  for (const shared_ptr<Subcircuit> &definition : subcircuits) {
+    if (definition->name == subName) {
+      sub = definition;
+      break;
+    }
+  }
+  if (!sub) {
+    cerr << "Error: Unknown subcircuit " << subName << " in " << line << endl;
+    return;
+  }
 
-        // Load S-parameters from file
-        QMap<QString, QList<double>> touchstoneData =
-            readTouchstoneFile(filename);
+  vector<int> nodes;
+  for (size_t k = 1; k + 1 < tokens.size(); k++) {
+    int node;
+    if (!parseNode(tokens[k], node)) {
+      cerr << "Error: Invalid node in subcircuit instance: " << line << endl;
+      return;
+    }
+    nodes.push_back(node);
+  }
+  if ((int)nodes.size() != sub->numPorts) {
+    cerr << "Error: " << sub->name << " has " << sub->numPorts
+         << " ports, but " << tokens[0] << " has " << nodes.size()
+         << " nodes\n";
+    return;
+  }
 
-        if (touchstoneData.isEmpty()) {
-          cerr << "Error: Failed to load " << filename.toStdString() << endl;
-          continue;
-        }
+  for (int node : nodes) {
+    if (node > numNodes) {
+      numNodes = node;
+    }
+  }
+  components.emplace_back(ComponentType_SPAR::SUBCIRCUIT, string(tokens[0]),
+                          nodes, sub);
+}
 
-        // Use port count from file if available, otherwise use node-based
-        // detection
-        int filePortCount = touchstoneData.contains("n_ports")
-                                ? touchstoneData["n_ports"].first()
-                                : numRFPorts;
-
-        components.emplace_back(
-            ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK,
-            name.toStdString(),
-            std::vector<int>(nodes.constBegin(), nodes.constEnd()),
-            touchstoneData, filePortCount);
-
-        cout << "Loaded " << filePortCount << "-port S-parameter device from "
-             << filename.toStdString() << endl;
-      } else {
-        // Inline S-matrix definition
-        // Format: SPAR1 node1 node2 <S-matrix entries>
-        // 1-port: (S11_re,S11_im)
-        // 2-port: (S11_re,S11_im) (S12_re,S12_im); (S21_re,S21_im)
-        // (S22_re,S22_im)
-
-        QString matrixStr;
-        for (int k = idx; k < parts.size(); k++) {
-          matrixStr += parts[k] + " ";
-        }
+void SParameterCalculator::parseSParameterBlock(
+    string_view line, const vector<string_view> &tokens) {
+  // SPAR1 node1 node2 ... nodeN <file or S-matrix>
+  if (tokens.size() < 3) {
+    cerr << "Error: Invalid SPAR definition: " << line << endl;
+    return;
+  }
+  string name(tokens[0]);
+
+  // Extract nodes: every integer before the file name or the S-matrix
+  vector<int> nodes;
+  size_t idx = 1;
+  for (; idx < tokens.size(); idx++) {
+    int node;
+    if (!parseNode(tokens[idx], node)) {
+      break;
+    }
+    nodes.push_back(node);
+  }
+
+  if (nodes.empty() || idx == tokens.size()) {
+    cerr << "Error: Invalid SPAR definition: " << line << endl;
+    return;
+  }
+  for (int node : nodes) {
+    if (node > numNodes) {
+      numNodes = node;
+    }
+  }
 
-        vector<vector<Complex>> Smat =
-            parseInlineSMatrix(matrixStr, numRFPorts);
+  // Each node is a port referred to ground. With two nodes and one of
+  // them grounded, the device is a 1-port between the other node and
+  // ground
+  int numRFPorts = nodes.size();
+  if (nodes.size() == 2 && (nodes[0] == 0 || nodes[1] == 0)) {
+    numRFPorts = 1;
+  }
 
-        if ((int)Smat.size() == numRFPorts) {
-          components.emplace_back(
-              ComponentType_SPAR::SPAR_BLOCK, name.toStdString(),
-              std::vector<int>(nodes.constBegin(), nodes.constEnd()), Smat,
-              numRFPorts);
+  // Check if next part is a filename
+  if (tokens[idx][0] != '(') {
+    QString filename = QString::fromUtf8(tokens[idx].data(), tokens[idx].size());
 
-          cout << "Added " << numRFPorts << "-port inline S-parameter device"
-               << endl;
-        } else {
-          cerr << "Error: Failed to parse inline S-matrix\n";
-        }
-      }
+    // Load S-parameters from file. The parsed file is shared with the other
+    // netlists that use it and is only read again if it changes
+    shared_ptr<const TouchstoneModel> touchstone =
+        TouchstoneCache::load(filename);
+
+    if (!touchstone || touchstone->data.isEmpty()) {
+      cerr << "Error: Failed to load " << filename.toStdString() << endl;
+      return;
+    }
+
+    // Use port count from file if available, otherwise use node-based
+    // detection
+    int filePortCount =
+        touchstone->numPorts > 0 ? touchstone->numPorts : numRFPorts;
+
+    // The data keys (S<i><j>_re) are only unambiguous up to 9 ports
+    if (filePortCount < 1 || filePortCount > 9) {
+      cerr << "Error: " << filename.toStdString()
+           << ": only 1 to 9-port S-parameter files are supported\n";
+      return;
+    }
+
+    // A 1-port may also be connected between two nodes
+    bool nodesMatch = (filePortCount == 1)
+                          ? nodes.size() <= 2
+                          : (int)nodes.size() == filePortCount;
+    if (!nodesMatch) {
+      cerr << "Error: " << filename.toStdString() << " is a " << filePortCount
+           << "-port device, but " << name << " has " << nodes.size()
+           << " nodes\n";
+      return;
+    }
+
+    components.emplace_back(ComponentType_SPAR::FREQUENCY_DEPENDENT_SPAR_BLOCK,
+                            name, nodes, touchstone->data, touchstone->table,
+                            filePortCount);
+
+    cout << "Loaded " << filePortCount << "-port S-parameter device from "
+         << filename.toStdString() << endl;
+  } else {
+    // Inline S-matrix definition
+    // Format: SPAR1 node1 ... nodeN <S-matrix entries>
+    // 1-port: (S11_re,S11_im)
+    // 2-port: (S11_re,S11_im) (S12_re,S12_im); (S21_re,S21_im)
+    // (S22_re,S22_im)
+    // N-port: N rows of N entries separated by semicolons
+    size_t matrixStart = tokens[idx].data() - line.data();
+    string_view matrix = line.substr(matrixStart);
+
+    vector<vector<Complex>> Smat = parseInlineSMatrix(matrix, numRFPorts);
+
+    if ((int)Smat.size() == numRFPorts) {
+      components.emplace_back(ComponentType_SPAR::SPAR_BLOCK, name, nodes,
+                              Smat, numRFPorts);
+
+      cout << "Added " << numRFPorts << "-port inline S-parameter device"
+           << endl;
+    } else {
+      cerr << "Error: Failed to parse inline S-matrix\n";
     }
   }
-  cout << "Parsed " << components.size()
-       << " components, numNodes = " << numNodes << endl;
-  return true;
 }
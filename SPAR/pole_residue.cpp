@@ -0,0 +1,375 @@
+/// @file pole_residue.cpp
+/// @brief Pole-residue sweep of lumped RLC circuits
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "SParameterCalculator.h"
+
+// Largest number of unknowns (nodes plus inductors) reduced to pole-residue
+// form. The eigen decomposition grows as the cube of the size
+static const int POLE_RESIDUE_MAX_SIZE = 200;
+
+// The form is built when the sweep has at least this many points per unknown
+static const int POLE_RESIDUE_POINTS_PER_UNKNOWN = 2;
+
+// Largest difference with the nodal solution at the check frequencies
+static const double POLE_RESIDUE_TOLERANCE = 1e-9;
+
+// Eigenvalues of K^-1 * C below this fraction of the largest one are poles
+// at infinity (or so far above the band that they act as a constant)
+static const double POLE_RESIDUE_NULL_EIGENVALUE = 1e-6;
+
+void SParameterCalculator::analyzePoleResidue() {
+  PoleResiduePlan &model = plan.poles;
+  model = PoleResiduePlan();
+  if (!poleResidueSweep || ports.empty()) {
+    return;
+  }
+
+  int inductors = 0;
+  for (const auto &comp : components) {
+    bool lumped = comp.type == ComponentType_SPAR::RESISTOR ||
+                  comp.type == ComponentType_SPAR::CAPACITOR ||
+                  comp.type == ComponentType_SPAR::INDUCTOR;
+    double value = comp.params.lumped.value;
+    // Zero values are clamped by the nodal stamps, so they are left to them
+    if (!lumped || comp.nodes.size() != 2 || !(value > 0) || !isfinite(value)) {
+      return;
+    }
+    inductors += (comp.type == ComponentType_SPAR::INDUCTOR);
+  }
+  model.size = numNodes + inductors;
+  model.eligible = model.size <= POLE_RESIDUE_MAX_SIZE;
+}
+
+void SParameterCalculator::buildPoleResidue(const vector<double> &freqs) {
+  PoleResiduePlan &model = plan.poles;
+  int m = model.size;
+  int P = ports.size();
+  model.failed = true;
+
+  // G + sC, with the inductor currents after the node voltages and the port
+  // terminations in G. Column j of B excites port j
+  ComplexMatrix G(m, m), C(m, m), B(m, P);
+  auto stamp = [](ComplexMatrix &A, int n1, int n2, double value) {
+    if (n1 >= 0) {
+      A(n1, n1) += value;
+    }
+    if (n2 >= 0) {
+      A(n2, n2) += value;
+    }
+    if (n1 >= 0 && n2 >= 0) {
+      A(n1, n2) -= value;
+      A(n2, n1) -= value;
+    }
+  };
+  int current = numNodes;
+  for (const auto &comp : components) {
+    int n1 = comp.nodes[0] - 1, n2 = comp.nodes[1] - 1;
+    double value = comp.params.lumped.value;
+    switch (comp.type) {
+    case ComponentType_SPAR::RESISTOR:
+      stamp(G, n1, n2, 1.0 / value);
+      break;
+    case ComponentType_SPAR::CAPACITOR:
+      stamp(C, n1, n2, value);
+      break;
+    default:
+      // Inductor: its current leaves n1, and V1 - V2 - sL*I = 0
+      if (n1 >= 0) {
+        G(n1, current) += 1.0;
+        G(current, n1) += 1.0;
+      }
+      if (n2 >= 0) {
+        G(n2, current) -= 1.0;
+        G(current, n2) -= 1.0;
+      }
+      C(current, current) = -value;
+      current++;
+      break;
+    }
+  }
+  double gmin = 1e-12;
+  for (int i = 0; i < numNodes; i++) {
+    G(i, i) += gmin;
+  }
+  for (int p = 0; p < P; p++) {
+    int node = ports[p].node - 1;
+    G(node, node) += 1.0 / ports[p].impedance;
+    B(node, p) = 2.0 / ports[p].impedance;
+  }
+
+  // Real expansion point at the top of the band. The poles of a passive
+  // circuit are in the left half-plane, so K = G + s0*C is regular
+  double fmax = 0;
+  for (double f : freqs) {
+    fmax = max(fmax, fabs(f));
+  }
+  double s0 = 2 * M_PI * (fmax > 0 ? fmax : 1e9);
+
+  // x(s) = (I + (s - s0) M)^-1 K^-1 b with M = K^-1 C = Q T Q^H
+  ComplexMatrix &T = C, Q;
+  try {
+    ComplexMatrix K = G;
+    for (int i = 0; i < m; i++) {
+      for (int j = 0; j < m; j++) {
+        K(i, j) += s0 * C(i, j);
+      }
+    }
+    vector<int> pivots;
+    luFactorize(K, pivots);
+    luSolve(K, pivots, T);
+    luSolve(K, pivots, B);
+  } catch (const std::exception &) {
+    return;
+  }
+  if (!schurDecompose(T, Q)) {
+    return;
+  }
+
+  // Null eigenvalues to the end: T = [T11 T12; 0 T22], T22 nearly nilpotent
+  double largest = 0;
+  for (int k = 0; k < m; k++) {
+    largest = max(largest, abs(T(k, k)));
+  }
+  auto isNull = [&](int k) {
+    return abs(T(k, k)) <= POLE_RESIDUE_NULL_EIGENVALUE * largest;
+  };
+  for (bool swapped = true; swapped;) {
+    swapped = false;
+    for (int k = 0; k + 1 < m; k++) {
+      if (isNull(k) && !isNull(k + 1)) {
+        swapSchurDiagonal(T, Q, k);
+        swapped = true;
+      }
+    }
+  }
+  int r = 0;
+  while (r < m && !isNull(r)) {
+    r++;
+  }
+  int z = m - r;
+
+  // Decoupling T11 X - X T22 = -T12, so that T = W diag(T11, T22) W^-1 with
+  // W = [I X; 0 I]. Solved column by column, T11 and T22 are triangular
+  ComplexMatrix X(r, z);
+  vector<Complex> rhs(r);
+  for (int j = 0; j < z; j++) {
+    int J = r + j;
+    for (int i = 0; i < r; i++) {
+      Complex sum = -T(i, J);
+      for (int l = 0; l < j; l++) {
+        sum += X(i, l) * T(r + l, J);
+      }
+      rhs[i] = sum;
+    }
+    for (int i = r - 1; i >= 0; i--) {
+      Complex sum = rhs[i];
+      for (int l = i + 1; l < r; l++) {
+        sum -= T(i, l) * X(l, j);
+      }
+      X(i, j) = sum / (T(i, i) - T(J, J));
+    }
+  }
+
+  // Inputs W^-1 Q^H K^-1 b and port rows of Q W
+  ComplexMatrix in(m, P), out(P, m);
+  for (int k = 0; k < m; k++) {
+    for (int j = 0; j < P; j++) {
+      Complex sum = 0;
+      for (int i = 0; i < m; i++) {
+        sum += conj(Q(i, k)) * B(i, j);
+      }
+      in(k, j) = sum;
+    }
+  }
+  for (int i = 0; i < r; i++) {
+    for (int j = 0; j < P; j++) {
+      for (int l = 0; l < z; l++) {
+        in(i, j) -= X(i, l) * in(r + l, j);
+      }
+    }
+  }
+  for (int p = 0; p < P; p++) {
+    const Complex *q = Q.row(ports[p].node - 1);
+    for (int k = 0; k < m; k++) {
+      out(p, k) = q[k];
+    }
+    for (int l = 0; l < z; l++) {
+      for (int i = 0; i < r; i++) {
+        out(p, r + l) += q[i] * X(i, l);
+      }
+    }
+  }
+
+  // Eigenvectors of T11 (unit upper triangular matrix E), by back
+  // substitution. in = E^-1 in and out = out E over the first r rows/columns
+  const double eps = numeric_limits<double>::epsilon();
+  ComplexMatrix E(r, r);
+  for (int k = r - 1; k >= 0; k--) {
+    E(k, k) = 1.0;
+    for (int i = k - 1; i >= 0; i--) {
+      Complex sum = 0;
+      for (int j = i + 1; j <= k; j++) {
+        sum += T(i, j) * E(j, k);
+      }
+      Complex diag = T(i, i) - T(k, k);
+      if (abs(diag) < eps * largest) {
+        diag = eps * largest;
+      }
+      E(i, k) = -sum / diag;
+    }
+  }
+  for (int i = r - 1; i >= 0; i--) {
+    for (int j = 0; j < P; j++) {
+      for (int l = i + 1; l < r; l++) {
+        in(i, j) -= E(i, l) * in(l, j);
+      }
+    }
+  }
+  for (int p = 0; p < P; p++) {
+    for (int k = r - 1; k >= 0; k--) {
+      Complex sum = 0;
+      for (int i = 0; i <= k; i++) {
+        sum += out(p, i) * E(i, k);
+      }
+      out(p, k) = sum;
+    }
+  }
+
+  // 1 / (1 + (s - s0) lambda) = (1 / lambda) / (s - p), p = s0 - 1 / lambda
+  model.shift = s0;
+  model.poles.resize(r);
+  model.residues.assign(r * P * P, Complex(0, 0));
+  for (int k = 0; k < r; k++) {
+    Complex lambda = T(k, k);
+    model.poles[k] = s0 - 1.0 / lambda;
+    Complex *R = &model.residues[k * P * P];
+    for (int i = 0; i < P; i++) {
+      Complex v = out(i, k) / lambda;
+      for (int j = 0; j < P; j++) {
+        R[i * P + j] = v * in(k, j);
+      }
+    }
+  }
+
+  // (I + (s - s0) T22)^-1 = sum_q (s0 - s)^q T22^q. The terms negligible
+  // at twice the expansion point are dropped
+  model.polynomial.clear();
+  vector<Complex> w(z * P), next(z * P);
+  for (int l = 0; l < z; l++) {
+    for (int j = 0; j < P; j++) {
+      w[l * P + j] = in(r + l, j);
+    }
+  }
+  double scale = 1;
+  for (int q = 0; q <= z + 8; q++) {
+    vector<Complex> term(P * P);
+    double size = 0;
+    for (int i = 0; i < P; i++) {
+      for (int j = 0; j < P; j++) {
+        Complex sum = 0;
+        for (int l = 0; l < z; l++) {
+          sum += out(i, r + l) * w[l * P + j];
+        }
+        term[i * P + j] = sum;
+        size = max(size, abs(sum));
+      }
+    }
+    if (q > 0 && size * scale < POLE_RESIDUE_TOLERANCE * 1e-6) {
+      break;
+    }
+    model.polynomial.insert(model.polynomial.end(), term.begin(), term.end());
+    for (int l = 0; l < z; l++) {
+      for (int j = 0; j < P; j++) {
+        Complex sum = 0;
+        for (int k = l; k < z; k++) {
+          sum += T(r + l, r + k) * w[k * P + j];
+        }
+        next[l * P + j] = sum;
+      }
+    }
+    w.swap(next);
+    scale *= 2 * s0;
+  }
+  model.built = true;
+
+  // Check against the nodal solution inside the band
+  vector<vector<Complex>> reference = createMatrix(P, P);
+  vector<Complex> S(P * P);
+  int n = freqs.size();
+  for (int index : {n / 4, n / 2, (3 * n) / 4}) {
+    double freq = freqs[index];
+    if (freq <= 0) {
+      continue;
+    }
+    try {
+      solveSParameters(freq, solverContext, reference);
+    } catch (const std::exception &) {
+      continue;
+    }
+    bool ok = evaluatePoleResidue(freq, S.data());
+    for (int i = 0; ok && i < P; i++) {
+      for (int j = 0; ok && j < P; j++) {
+        ok = abs(S[i * P + j] - reference[i][j]) <= POLE_RESIDUE_TOLERANCE;
+      }
+    }
+    if (!ok) {
+      model = PoleResiduePlan();
+      model.failed = true;
+      return;
+    }
+  }
+  model.failed = false;
+}
+
+bool SParameterCalculator::evaluatePoleResidue(double freq, Complex *S) const {
+  const PoleResiduePlan &model = plan.poles;
+  int P = ports.size();
+  int entries = P * P;
+  Complex s(0, 2 * M_PI * freq);
+
+  // Polynomial part by Horner's rule in (s0 - s)
+  Complex sigma = model.shift - s;
+  int terms = model.polynomial.size() / entries;
+  fill(S, S + entries, Complex(0, 0));
+  for (int q = terms - 1; q >= 0; q--) {
+    const Complex *Eq = &model.polynomial[q * entries];
+    for (int e = 0; e < entries; e++) {
+      S[e] = S[e] * sigma + Eq[e];
+    }
+  }
+  for (int i = 0; i < P; i++) {
+    S[i * P + i] -= 1.0;
+  }
+
+  for (size_t k = 0; k < model.poles.size(); k++) {
+    Complex d = 1.0 / (s - model.poles[k]);
+    const Complex *R = &model.residues[k * entries];
+    for (int e = 0; e < entries; e++) {
+      S[e] += R[e] * d;
+    }
+  }
+  for (int e = 0; e < entries; e++) {
+    if (!isfinite(S[e].real()) || !isfinite(S[e].imag())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SParameterCalculator::usePoleResidue(const vector<double> &freqs) {
+  PoleResiduePlan &model = plan.poles;
+  if (!plan.valid || !model.eligible || model.failed) {
+    return false;
+  }
+  if (!model.built) {
+    if ((int)freqs.size() < POLE_RESIDUE_POINTS_PER_UNKNOWN * model.size) {
+      return false;
+    }
+    buildPoleResidue(freqs);
+  }
+  return model.built;
+}
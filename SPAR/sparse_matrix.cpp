@@ -0,0 +1,379 @@
+/// @file sparse_matrix.cpp
+/// @brief Implementation of the sparse nodal matrix and the sparse LU solver
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "NodalMatrix.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+
+// Partial pivoting threshold. The diagonal entry is kept as pivot if its
+// magnitude is at least this fraction of the largest candidate. This preserves
+// the fill-reducing ordering computed by the symbolic analysis
+static const double PIVOT_TOLERANCE = 0.1;
+
+// A pivot smaller than this fraction of the largest entry of its column in A
+// has lost most of its digits by cancellation, e.g. against the 1e12 S of a
+// 0 Ω element. The matrix is then factorized in the natural order
+static const double CANCELLATION_LIMIT = 1e-8;
+
+// Largest magnitude of the entries of a column of A
+static double columnScale(const SparseNodalMatrix &A, int col) {
+  const vector<int> &Ap = A.columnPointers();
+  const vector<Complex> &Ax = A.values();
+  double scale = 0;
+  for (int p = Ap[col]; p < Ap[col + 1]; p++) {
+    scale = max(scale, abs(Ax[p]));
+  }
+  return scale;
+}
+
+void SparseNodalMatrix::setPattern(int size, vector<pair<int, int>> entries) {
+  n = size;
+
+  // Sort by column, then by row
+  sort(entries.begin(), entries.end(),
+       [](const pair<int, int> &a, const pair<int, int> &b) {
+         return (a.second != b.second) ? a.second < b.second
+                                       : a.first < b.first;
+       });
+  entries.erase(unique(entries.begin(), entries.end()), entries.end());
+
+  colPtr.assign(n + 1, 0);
+  rowIndex.resize(entries.size());
+  for (size_t k = 0; k < entries.size(); k++) {
+    rowIndex[k] = entries[k].first;
+    colPtr[entries[k].second + 1]++;
+  }
+  for (int c = 0; c < n; c++) {
+    colPtr[c + 1] += colPtr[c];
+  }
+  val.assign(entries.size(), Complex(0, 0));
+}
+
+void SparseNodalMatrix::setZero() { fill(val.begin(), val.end(), Complex(0, 0)); }
+
+Complex &SparseNodalMatrix::at(int row, int col) {
+  auto first = rowIndex.begin() + colPtr[col];
+  auto last = rowIndex.begin() + colPtr[col + 1];
+  auto it = lower_bound(first, last, row);
+  if (it == last || *it != row) {
+    throw logic_error("Entry (" + to_string(row) + ", " + to_string(col) +
+                      ") is not in the sparsity pattern");
+  }
+  return val[it - rowIndex.begin()];
+}
+
+void SparseLU::analyze(const SparseNodalMatrix &A) {
+  n = A.size();
+  factorized = false;
+  naturalOrder = false;
+
+  const vector<int> &Ap = A.columnPointers();
+  const vector<int> &Ai = A.rowIndices();
+
+  // Adjacency of the graph of A+A^T (the nodal pattern is symmetric, but the
+  // symmetry is not assumed here)
+  vector<set<int>> adj(n);
+  for (int c = 0; c < n; c++) {
+    for (int p = Ap[c]; p < Ap[c + 1]; p++) {
+      int r = Ai[p];
+      if (r != c) {
+        adj[r].insert(c);
+        adj[c].insert(r);
+      }
+    }
+  }
+
+  // Minimum degree ordering. At each step, the node with the fewest
+  // neighbours is eliminated and its neighbours become a clique (fill-in).
+  // Ties are broken by node index, so the ordering is deterministic.
+  set<pair<int, int>> queue;
+  for (int i = 0; i < n; i++) {
+    queue.insert({(int)adj[i].size(), i});
+  }
+
+  colOrder.clear();
+  colOrder.reserve(n);
+  while (!queue.empty()) {
+    int v = queue.begin()->second;
+    queue.erase(queue.begin());
+    colOrder.push_back(v);
+
+    vector<int> neighbours(adj[v].begin(), adj[v].end());
+    for (int u : neighbours) {
+      queue.erase({(int)adj[u].size(), u});
+      adj[u].erase(v);
+    }
+    for (int u : neighbours) {
+      for (int w : neighbours) {
+        if (u != w) {
+          adj[u].insert(w);
+        }
+      }
+    }
+    for (int u : neighbours) {
+      queue.insert({(int)adj[u].size(), u});
+    }
+    adj[v].clear();
+  }
+
+  reach.resize(n);
+  stack.resize(n);
+  pstack.resize(n);
+}
+
+void SparseLU::factorize(const SparseNodalMatrix &A) {
+  if (A.size() != n) {
+    throw logic_error("SparseLU: the matrix does not match the analyzed pattern");
+  }
+  if (factorized && refactorize(A)) {
+    return;
+  }
+  if (factorizeWithPivoting(A)) {
+    return;
+  }
+
+  // The fill-reducing ordering combined entries of very different magnitude.
+  // In the natural order, with partial pivoting, the nodes are eliminated
+  // before the port equations, as in the dense solver
+  naturalOrder = true;
+  for (int k = 0; k < n; k++) {
+    colOrder[k] = k;
+  }
+  factorizeWithPivoting(A);
+}
+
+int SparseLU::computeReach(const SparseNodalMatrix &A, int col, int mark) {
+  const vector<int> &Ap = A.columnPointers();
+  const vector<int> &Ai = A.rowIndices();
+  int top = n;
+
+  // Depth-first search in the graph of L starting at each entry of A(:,col).
+  // The nodes are stored in reach[top..n-1] in topological order
+  for (int q = Ap[col]; q < Ap[col + 1]; q++) {
+    if (marks[Ai[q]] == mark) {
+      continue;
+    }
+    int head = 0;
+    stack[0] = Ai[q];
+    while (head >= 0) {
+      int j = stack[head];
+      int J = pivotOf[j];
+      if (marks[j] != mark) {
+        marks[j] = mark;
+        pstack[head] = (J < 0) ? 0 : Lp[J];
+      }
+      bool done = true;
+      int pEnd = (J < 0) ? 0 : Lp[J + 1];
+      for (int p = pstack[head]; p < pEnd; p++) {
+        int i = Li[p];
+        if (marks[i] == mark) {
+          continue;
+        }
+        pstack[head] = p;
+        stack[++head] = i;
+        done = false;
+        break;
+      }
+      if (done) {
+        head--;
+        reach[--top] = j;
+      }
+    }
+  }
+  return top;
+}
+
+bool SparseLU::factorizeWithPivoting(const SparseNodalMatrix &A) {
+  const vector<int> &Ap = A.columnPointers();
+  const vector<int> &Ai = A.rowIndices();
+  const vector<Complex> &Ax = A.values();
+
+  factorized = false;
+  Lp.assign(n + 1, 0);
+  Up.assign(n + 1, 0);
+  Li.clear();
+  Lx.clear();
+  Ui.clear();
+  Ux.clear();
+  pivotOf.assign(n, -1);
+  marks.assign(n, -1);
+  x.assign(n, Complex(0, 0));
+
+  // During the factorization, L is indexed by original rows
+  for (int k = 0; k < n; k++) {
+    Lp[k] = Li.size();
+    Up[k] = Ui.size();
+    int col = colOrder[k];
+
+    // Sparse triangular solve x = L \ A(:,col)
+    int top = computeReach(A, col, k);
+    for (int p = Ap[col]; p < Ap[col + 1]; p++) {
+      x[Ai[p]] = Ax[p];
+    }
+    for (int px = top; px < n; px++) {
+      int j = reach[px];
+      int J = pivotOf[j];
+      if (J < 0) {
+        continue;
+      }
+      Complex xj = x[j];
+      for (int p = Lp[J] + 1; p < Lp[J + 1]; p++) {
+        x[Li[p]] -= Lx[p] * xj;
+      }
+    }
+
+    // Select the pivot among the rows not pivoted yet
+    int ipiv = -1;
+    double maxMag = -1;
+    for (int px = top; px < n; px++) {
+      int i = reach[px];
+      if (pivotOf[i] < 0) {
+        double mag = abs(x[i]);
+        if (mag > maxMag) {
+          maxMag = mag;
+          ipiv = i;
+        }
+      } else {
+        Ui.push_back(pivotOf[i]);
+        Ux.push_back(x[i]);
+      }
+    }
+    if (ipiv < 0) {
+      throw runtime_error("Matrix is singular and cannot be inverted");
+    }
+    if (!naturalOrder && pivotOf[col] < 0 &&
+        abs(x[col]) >= PIVOT_TOLERANCE * maxMag) {
+      ipiv = col; // Keep the diagonal
+    }
+    if (!naturalOrder &&
+        abs(x[ipiv]) < CANCELLATION_LIMIT * columnScale(A, col)) {
+      return false;
+    }
+    if (maxMag < 1e-12) {
+      throw runtime_error("Matrix is singular and cannot be inverted");
+    }
+
+    Complex pivot = x[ipiv];
+    Ui.push_back(k);
+    Ux.push_back(pivot);
+    pivotOf[ipiv] = k;
+    Li.push_back(ipiv);
+    Lx.push_back(Complex(1, 0));
+    for (int px = top; px < n; px++) {
+      int i = reach[px];
+      if (pivotOf[i] < 0) {
+        Li.push_back(i);
+        Lx.push_back(x[i] / pivot);
+      }
+      x[i] = Complex(0, 0);
+    }
+  }
+  Lp[n] = Li.size();
+  Up[n] = Ui.size();
+
+  // Renumber the rows of L in pivot order
+  for (int &i : Li) {
+    i = pivotOf[i];
+  }
+  factorized = true;
+  return true;
+}
+
+bool SparseLU::refactorize(const SparseNodalMatrix &A) {
+  const vector<int> &Ap = A.columnPointers();
+  const vector<int> &Ai = A.rowIndices();
+  const vector<Complex> &Ax = A.values();
+
+  for (int k = 0; k < n; k++) {
+    int col = colOrder[k];
+
+    // Clear the pattern of column k and scatter A(:,col) in pivot order
+    for (int p = Up[k]; p < Up[k + 1]; p++) {
+      x[Ui[p]] = Complex(0, 0);
+    }
+    for (int p = Lp[k]; p < Lp[k + 1]; p++) {
+      x[Li[p]] = Complex(0, 0);
+    }
+    for (int p = Ap[col]; p < Ap[col + 1]; p++) {
+      x[pivotOf[Ai[p]]] = Ax[p];
+    }
+
+    // The off-diagonal entries of U are stored in topological order
+    for (int p = Up[k]; p < Up[k + 1] - 1; p++) {
+      int J = Ui[p];
+      Complex xj = x[J];
+      Ux[p] = xj;
+      for (int q = Lp[J] + 1; q < Lp[J + 1]; q++) {
+        x[Li[q]] -= Lx[q] * xj;
+      }
+    }
+
+    // Check that the pivot is still acceptable
+    Complex pivot = x[k];
+    double maxMag = 0;
+    for (int q = Lp[k] + 1; q < Lp[k + 1]; q++) {
+      maxMag = max(maxMag, abs(x[Li[q]]));
+    }
+    double pivotMag = abs(pivot);
+    if (pivotMag < 1e-12 || pivotMag < PIVOT_TOLERANCE * maxMag ||
+        (!naturalOrder &&
+         pivotMag < CANCELLATION_LIMIT * columnScale(A, col))) {
+      return false;
+    }
+
+    Ux[Up[k + 1] - 1] = pivot;
+    for (int q = Lp[k] + 1; q < Lp[k + 1]; q++) {
+      Lx[q] = x[Li[q]] / pivot;
+    }
+  }
+  return true;
+}
+
+void SparseLU::solve(ComplexMatrix &rhs) const {
+  if (n == 0) {
+    return;
+  }
+  int nrhs = rhs.cols();
+  work.resize(n);
+
+  for (int c = 0; c < nrhs; c++) {
+    // Row permutation
+    for (int i = 0; i < n; i++) {
+      work[pivotOf[i]] = rhs(i, c);
+    }
+
+    // Forward substitution (unit lower triangular)
+    for (int j = 0; j < n; j++) {
+      Complex xj = work[j];
+      if (xj == Complex(0, 0)) {
+        continue;
+      }
+      for (int p = Lp[j] + 1; p < Lp[j + 1]; p++) {
+        work[Li[p]] -= Lx[p] * xj;
+      }
+    }
+
+    // Back substitution
+    for (int j = n - 1; j >= 0; j--) {
+      work[j] /= Ux[Up[j + 1] - 1];
+      Complex xj = work[j];
+      if (xj == Complex(0, 0)) {
+        continue;
+      }
+      for (int p = Up[j]; p < Up[j + 1] - 1; p++) {
+        work[Ui[p]] -= Ux[p] * xj;
+      }
+    }
+
+    // Column permutation
+    for (int k = 0; k < n; k++) {
+      rhs(colOrder[k], c) = work[k];
+    }
+  }
+}
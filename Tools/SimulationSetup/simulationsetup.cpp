@@ -111,8 +111,31 @@ QWidget *SimulationSetup::createFrequencySweepTab() {
   frequencyLayout->addWidget(npointsLabel, 2, 0);
   frequencyLayout->addWidget(npointsSpinBox, 2, 1);
 
+  // Number of threads used to sweep the frequency grid. 0 = one per core
+  QLabel *threadsLabel = new QLabel("<b>Threads<\b>");
+  threadsSpinBox = new QSpinBox();
+  threadsSpinBox->setMinimum(0);
+  threadsSpinBox->setMaximum(QThread::idealThreadCount());
+  threadsSpinBox->setSpecialValueText("Auto");
+  threadsSpinBox->setValue(0);
+
+  frequencyLayout->addWidget(threadsLabel, 3, 0);
+  frequencyLayout->addWidget(threadsSpinBox, 3, 1);
+
+  // The simulation results are always cached in memory. They can also be
+  // kept on disk, so they are reused in later sessions
+  diskCacheCheckBox = new QCheckBox("Keep results on disk");
+  diskCacheCheckBox->setChecked(
+      QSettings().value("simulationDiskCache", false).toBool());
+  connect(diskCacheCheckBox, &QCheckBox::toggled, this, [this](bool enabled) {
+    QSettings().setValue("simulationDiskCache", enabled);
+    emit updateDiskCache(enabled);
+  });
+
+  frequencyLayout->addWidget(diskCacheCheckBox, 4, 0, 1, 3);
+
   // Add stretch to push everything to the top
-  frequencyLayout->setRowStretch(3, 1);
+  frequencyLayout->setRowStretch(5, 1);
 
   frequencyWidget->setLayout(frequencyLayout);
   return frequencyWidget;
@@ -12,6 +12,7 @@
 #include "../../Misc/general.h"
 #include "../../Schematic/infoclasses.h"
 #include <QButtonGroup>
+#include <QCheckBox>
 #include <QComboBox>
 #include <QDoubleSpinBox>
 #include <QGridLayout>
@@ -19,8 +20,10 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QRadioButton>
+#include <QSettings>
 #include <QSpinBox>
 #include <QTabWidget>
+#include <QThread>
 #include <QVBoxLayout>
 #include <QWidget>
 
@@ -31,7 +34,7 @@
 /// @class SimulationSetup
 /// @brief UI component to set the simulation settings
 /// The widget consists of two tabs:
-/// 1) Frequency Sweep – start/stop frequency and number of points.
+/// 1) Frequency Sweep – start/stop frequency, number of points and threads.
 /// 2) Substrate Properties – transmission‑line type, substrate geometry, etc
 class SimulationSetup : public QWidget {
     Q_OBJECT
@@ -64,6 +67,14 @@ class SimulationSetup : public QWidget {
     /// @brief Get the number of frequency points.
     /// @return Number of points.
     int getNpoints() { return npointsSpinBox->value(); }
+
+    /// @brief Get the number of threads used by the frequency sweep.
+    /// @return Number of threads (0 means one thread per CPU core).
+    int getNumThreads() { return threadsSpinBox->value(); }
+
+    /// @brief Check if the simulation results are kept on disk.
+    /// @return True if the on-disk result cache is enabled.
+    bool getDiskCache() { return diskCacheCheckBox->isChecked(); }
     /// }@
 
     /// @name Substrate properties methods
@@ -121,6 +132,8 @@ class SimulationSetup : public QWidget {
     QComboBox        *fstartScaleComboBox;
     QComboBox        *fstopScaleComboBox;
     QSpinBox         *npointsSpinBox;
+    QSpinBox         *threadsSpinBox;
+    QCheckBox        *diskCacheCheckBox;
     /// }@
 
     /// @name Substrate‑property widgets
@@ -161,6 +174,9 @@ class SimulationSetup : public QWidget {
 
     /// @brief Emitted specifically when substrate data changes
     void updateSubstrate();
+
+    /// @brief Emitted when the on-disk result cache is enabled or disabled
+    void updateDiskCache(bool enabled);
 };
 
 #endif // SIMULATIONSETUP_H
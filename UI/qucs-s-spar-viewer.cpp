@@ -10,6 +10,7 @@
 #endif
 
 #include "qucs-s-spar-viewer.h"
+#include "../SPAR/TouchstoneCache.h"
 
 #include <QApplication>
 #include <QClipboard>
@@ -1612,6 +1613,9 @@ void Qucs_S_SPAR_Viewer::setupFileWatcher() {
 }
 
 void Qucs_S_SPAR_Viewer::fileChanged(const QString &path) {
+  // Netlists that use the file must read it again
+  TouchstoneCache::invalidate(path);
+
   // Don't process the same file within a short time window
   static QMap<QString, QDateTime> lastProcessedTimes;
   static const int debounceTime = 500; // milliseconds
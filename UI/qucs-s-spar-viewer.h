@@ -23,6 +23,7 @@
 #include "../Tools/SimulationSetup/simulationsetup.h"
 
 #include "../SPAR/SParameterCalculator.h"
+#include "simulation_worker.h"
 
 #include "../Misc/general.h"
 
@@ -817,8 +818,8 @@ class Qucs_S_SPAR_Viewer : public QMainWindow {
     PowerCombiningTool* PowerCombTool;       ///< Power combining tool
     AttenuatorDesignTool* AttenuatorTool;    ///< Attenuator design tool
 
-    // S-parameter simulation class
-    SParameterCalculator SPAR_engine;
+    /// @brief Runs the S-parameter simulations off the GUI thread
+    SimulationWorker* simulationWorker;
 
     // Substrate
     MS_Substrate MS_Subs;
@@ -967,8 +968,14 @@ class Qucs_S_SPAR_Viewer : public QMainWindow {
     void updateSimulation(SchematicContent SI);
 
     /// @brief Force simulation update
+    /// \note The simulation is queued in the simulation worker. The traces are
+    /// updated by publishSimulationResults() when it finishes
     void updateSimulation();
 
+    /// @brief Moves the results of the last simulation into the datasets and
+    /// refreshes the traces
+    void publishSimulationResults();
+
     /// @brief Update substrate parameters
     void updateSubstrate();
 
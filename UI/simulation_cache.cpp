@@ -0,0 +1,224 @@
+/// @file simulation_cache.cpp
+/// @brief Cache of the simulation results of the tools (implementation)
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "simulation_cache.h"
+#include "simulation_worker.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// Size of the results kept in memory (KiB)
+static const qsizetype MEMORY_CACHE_LIMIT = 256 * 1024;
+
+// Size of the files kept on disk (bytes)
+static const qint64 DISK_CACHE_LIMIT = 512LL * 1024 * 1024;
+
+// Header of the files of the disk tier. The "SIM1" files held the traces of
+// getData() and are ignored
+static const quint32 DISK_CACHE_MAGIC = 0x53494d32; // "SIM2"
+
+// Cost of some results in the memory tier (KiB)
+static qsizetype cacheCost(const SweepResult &results) {
+  qsizetype ports = results.getNumPorts();
+  qsizetype bytes = results.size() * (sizeof(double) + sizeof(char) +
+                                      ports * ports * sizeof(Complex));
+  return bytes / 1024 + 1;
+}
+
+SimulationCache::SimulationCache() { memory.setMaxCost(MEMORY_CACHE_LIMIT); }
+
+QByteArray SimulationCache::key(const SimulationJob &job) {
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+
+  // The netlist, one element per line. Blank lines and repeated spaces do
+  // not change the circuit
+  const QStringList lines = job.netlist.split('\n');
+  for (const QString &text : lines) {
+    QString line = text.simplified();
+    if (line.isEmpty()) {
+      continue;
+    }
+    hash.addData((line + '\n').toUtf8());
+
+    // The results of the S-parameter blocks depend on the files they read
+    if (!line.startsWith("SPAR", Qt::CaseInsensitive)) {
+      continue;
+    }
+    const QStringList tokens = line.split(' ');
+    for (qsizetype i = 1; i < tokens.size(); i++) {
+      QFileInfo info(tokens[i]);
+      if (info.isFile()) {
+        QString state = QString("%1 %2 %3\n")
+                            .arg(info.canonicalFilePath())
+                            .arg(info.lastModified().toMSecsSinceEpoch())
+                            .arg(info.size());
+        hash.addData(state.toUtf8());
+      }
+    }
+  }
+
+  // The sweep. The number of threads does not change the results
+  QString sweep = QString("%1 %2 %3")
+                      .arg(job.fstart, 0, 'g', 17)
+                      .arg(job.fstop, 0, 'g', 17)
+                      .arg(job.npoints);
+  hash.addData(sweep.toUtf8());
+  return hash.result();
+}
+
+bool SimulationCache::findInMemory(const QByteArray &key,
+                                   QMap<QString, QList<double>> &data) {
+  QMutexLocker locker(&mutex);
+  if (const SweepResult *results = memory.object(key)) {
+    data = results->toDataMap();
+    return true;
+  }
+  return false;
+}
+
+bool SimulationCache::findOnDisk(const QByteArray &key,
+                                 QMap<QString, QList<double>> &data) {
+  bool readDisk;
+  {
+    QMutexLocker locker(&mutex);
+    readDisk = disk;
+  }
+  SweepResult results;
+  if (!readDisk || !readFromDisk(key, results)) {
+    return false;
+  }
+  data = results.toDataMap();
+  QMutexLocker locker(&mutex);
+  qsizetype cost = cacheCost(results);
+  memory.insert(key, new SweepResult(std::move(results)), cost);
+  return true;
+}
+
+void SimulationCache::insert(const QByteArray &key,
+                             const SweepResult &results) {
+  bool writeDisk;
+  {
+    QMutexLocker locker(&mutex);
+    memory.insert(key, new SweepResult(results), cacheCost(results));
+    writeDisk = disk;
+  }
+  if (writeDisk) {
+    writeToDisk(key, results);
+  }
+}
+
+void SimulationCache::setDiskCache(bool enabled) {
+  QMutexLocker locker(&mutex);
+  disk = enabled;
+}
+
+QString SimulationCache::diskCacheDirectory() {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/simulations";
+}
+
+QString SimulationCache::diskPath(const QByteArray &key) {
+  return diskCacheDirectory() + "/" + QString::fromLatin1(key.toHex()) +
+         ".sim";
+}
+
+bool SimulationCache::readFromDisk(const QByteArray &key,
+                                   SweepResult &results) {
+  QFile file(diskPath(key));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_6_0);
+  quint32 magic = 0;
+  QByteArray storedKey;
+  qint32 ports = 0;
+  double Z0 = 0;
+  QList<double> frequency;
+  in >> magic >> storedKey;
+  if (in.status() != QDataStream::Ok || magic != DISK_CACHE_MAGIC ||
+      storedKey != key) {
+    return false;
+  }
+  in >> ports >> Z0 >> frequency;
+  if (in.status() != QDataStream::Ok || ports <= 0) {
+    return false;
+  }
+
+  // Each point: solved flag, then the S-matrix by rows (real, imaginary)
+  SweepResult read(ports, Z0,
+                   vector<double>(frequency.begin(), frequency.end()));
+  for (size_t k = 0; k < read.size(); k++) {
+    bool solved = false;
+    in >> solved;
+    read.setSolved(k, solved);
+    Complex *S = read.matrix(k);
+    for (int e = 0; e < ports * ports; e++) {
+      double re = 0, im = 0;
+      in >> re >> im;
+      S[e] = Complex(re, im);
+    }
+  }
+  if (in.status() != QDataStream::Ok) {
+    return false;
+  }
+
+  // The modification time orders the files for the eviction
+  file.setFileTime(QDateTime::currentDateTime(),
+                   QFileDevice::FileModificationTime);
+  results = std::move(read);
+  return true;
+}
+
+void SimulationCache::writeToDisk(const QByteArray &key,
+                                  const SweepResult &results) {
+  QString directory = diskCacheDirectory();
+  if (!QDir().mkpath(directory)) {
+    return;
+  }
+
+  // The file is renamed into place once it is complete, so a reader never
+  // sees it half written
+  QSaveFile file(diskPath(key));
+  if (!file.open(QIODevice::WriteOnly)) {
+    return;
+  }
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_6_0);
+  const vector<double> &frequency = results.getFrequency();
+  int ports = results.getNumPorts();
+  out << DISK_CACHE_MAGIC << key << qint32(ports) << results.getZ0()
+      << QList<double>(frequency.begin(), frequency.end());
+  for (size_t k = 0; k < results.size(); k++) {
+    out << results.isSolved(k);
+    const Complex *S = results.matrix(k);
+    for (int e = 0; e < ports * ports; e++) {
+      out << S[e].real() << S[e].imag();
+    }
+  }
+  if (out.status() != QDataStream::Ok || !file.commit()) {
+    return;
+  }
+
+  // The most recently used files are kept
+  QFileInfoList files = QDir(directory).entryInfoList(
+      QStringList() << "*.sim", QDir::Files, QDir::Time);
+  qint64 total = 0;
+  for (const QFileInfo &info : std::as_const(files)) {
+    total += info.size();
+    if (total > DISK_CACHE_LIMIT) {
+      QFile::remove(info.absoluteFilePath());
+    }
+  }
+}
@@ -0,0 +1,93 @@
+/// @file simulation_cache.h
+/// @brief Cache of the simulation results of the tools
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#ifndef SIMULATION_CACHE_H
+#define SIMULATION_CACHE_H
+
+#include "../SPAR/SweepResult.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+struct SimulationJob;
+
+/// @class SimulationCache
+/// @brief Results of previous simulations, keyed by their contents
+///
+/// Switching tabs, toggling a tool mode or moving a setting back to a previous
+/// value requests a simulation that was already run. The key is a SHA-256
+/// hash of the netlist (one line per element, whitespace normalized), the
+/// frequency sweep and the state of the Touchstone files it references. The
+/// substrate is part of the netlist lines of the microstrip elements.
+///
+/// The results are kept in memory in a LRU cache bounded by size. Optionally,
+/// they are also written to the user cache directory, so they survive the
+/// session. The disk tier is bounded too: the least recently used files are
+/// removed first.
+///
+/// Both tiers store the complex S-matrices (SweepResult). The dB, angle, real
+/// and imaginary traces of the GUI datasets are derived on a hit.
+///
+/// All the methods are thread-safe.
+class SimulationCache {
+  public:
+    SimulationCache();
+
+    /// @brief Returns the key of a simulation
+    /// @param job Netlist and sweep settings
+    static QByteArray key(const SimulationJob &job);
+
+    /// @brief Looks up the results of a simulation in memory
+    /// @param key Key of the simulation
+    /// @param data Output. Results, in the format of
+    /// SParameterCalculator::getData()
+    /// @return False if the results are not in memory
+    bool findInMemory(const QByteArray &key,
+                      QMap<QString, QList<double>> &data);
+
+    /// @brief Looks up the results of a simulation on disk and moves them to
+    /// memory
+    /// \note It reads a file, so it is not meant for the GUI thread
+    /// @param key Key of the simulation
+    /// @param data Output. Results, in the format of
+    /// SParameterCalculator::getData()
+    /// @return False if the disk tier is disabled or has no results
+    bool findOnDisk(const QByteArray &key, QMap<QString, QList<double>> &data);
+
+    /// @brief Stores the results of a simulation
+    /// @param key Key of the simulation
+    /// @param results S-matrices of the sweep
+    void insert(const QByteArray &key, const SweepResult &results);
+
+    /// @brief Enables or disables the disk tier. The files already written
+    /// are kept
+    void setDiskCache(bool enabled);
+
+    /// @brief Returns the directory of the disk tier
+    static QString diskCacheDirectory();
+
+  private:
+    /// @brief Path of the file of a key in the disk tier
+    static QString diskPath(const QByteArray &key);
+
+    /// @brief Reads the results of a key from the disk tier
+    static bool readFromDisk(const QByteArray &key, SweepResult &results);
+
+    /// @brief Writes the results of a key to the disk tier and removes the
+    /// oldest files if it is full
+    static void writeToDisk(const QByteArray &key, const SweepResult &results);
+
+    QMutex mutex; ///< Protects the fields below
+    QCache<QByteArray, SweepResult> memory; ///< Cost in KiB
+    bool disk = false; ///< The disk tier is enabled
+};
+
+#endif // SIMULATION_CACHE_H
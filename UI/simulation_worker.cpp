@@ -0,0 +1,124 @@
+/// @file simulation_worker.cpp
+/// @brief Background thread running the S-parameter simulations of the tools
+/// (implementation)
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#include "simulation_worker.h"
+
+SimulationWorker::SimulationWorker(QObject *parent) : QThread(parent) {
+  engine.setCancelFlag(&cancel);
+}
+
+SimulationWorker::~SimulationWorker() {
+  {
+    QMutexLocker locker(&mutex);
+    stopping = true;
+    cancel = true;
+    wakeUp.wakeOne();
+  }
+  wait();
+}
+
+quint64 SimulationWorker::submit(SimulationJob job) {
+  job.key = SimulationCache::key(job);
+  QMap<QString, QList<double>> data;
+  if (cache.findInMemory(job.key, data)) {
+    {
+      QMutexLocker locker(&mutex);
+      job.generation = ++latest;
+      hasPending = false;
+      cancel = true; // The running sweep (if any) is stale now
+      backData.swap(data);
+      backName = job.name;
+      backGeneration = job.generation;
+      backReady = true;
+    }
+    emit resultsReady();
+    return job.generation;
+  }
+
+  QMutexLocker locker(&mutex);
+  job.generation = ++latest;
+  pending = job;
+  hasPending = true;
+  cancel = true; // The running sweep (if any) is stale now
+  wakeUp.wakeOne();
+
+  if (!isRunning()) {
+    start(QThread::LowPriority);
+  }
+  return job.generation;
+}
+
+bool SimulationWorker::takeResults(QString &name,
+                                   QMap<QString, QList<double>> &data) {
+  QMutexLocker locker(&mutex);
+  if (!backReady || backGeneration != latest) {
+    return false;
+  }
+  backReady = false;
+  name = backName;
+  data.swap(backData);
+  return true;
+}
+
+void SimulationWorker::clearModelCache() {
+  QMutexLocker locker(&mutex);
+  clearModels = true;
+}
+
+void SimulationWorker::run() {
+  while (true) {
+    SimulationJob job;
+    {
+      QMutexLocker locker(&mutex);
+      while (!hasPending && !stopping) {
+        wakeUp.wait(&mutex);
+      }
+      if (stopping) {
+        return;
+      }
+      job = pending;
+      hasPending = false;
+      cancel = false;
+      if (clearModels) {
+        engine.clearMicrostripModels(); // The engine is only used here
+        clearModels = false;
+      }
+    }
+
+    // The results of a previous session are read here rather than in
+    // submit(), so the GUI thread does not wait for the disk
+    QMap<QString, QList<double>> data;
+    if (!cache.findOnDisk(job.key, data)) {
+      engine.setNetlist(job.netlist);
+      engine.setFrequencySweep(job.fstart, job.fstop, job.npoints);
+      engine.setNumThreads(job.threads);
+      engine.calculateSParameterSweep();
+      if (engine.wasCancelled()) {
+        continue;
+      }
+      // The cache keeps the S-matrices. The GUI datasets take the traces
+      const SweepResult &results = engine.getSweepResult();
+      if (!results.empty()) {
+        cache.insert(job.key, results);
+      }
+      data = results.toDataMap();
+    }
+
+    {
+      QMutexLocker locker(&mutex);
+      if (job.generation != latest) {
+        continue; // A newer request arrived after the sweep finished
+      }
+      backData.swap(data);
+      backName = job.name;
+      backGeneration = job.generation;
+      backReady = true;
+    }
+    emit resultsReady();
+  }
+}
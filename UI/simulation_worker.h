@@ -0,0 +1,113 @@
+/// @file simulation_worker.h
+/// @brief Background thread running the S-parameter simulations of the tools
+/// @author Andrés Martínez Mera - andresmmera@protonmail.com
+/// @date Jan 3, 2026
+/// @copyright Copyright (C) 2026 Andrés Martínez Mera
+/// @license GPL-3.0-or-later
+
+#ifndef SIMULATION_WORKER_H
+#define SIMULATION_WORKER_H
+
+#include "../SPAR/SParameterCalculator.h"
+#include "simulation_cache.h"
+
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+
+/// @struct SimulationJob
+/// @brief Netlist and frequency sweep of a simulation request
+struct SimulationJob {
+  QString name;         ///< Dataset the results belong to
+  QString netlist;      ///< S-parameter netlist
+  double fstart = 0;    ///< Start frequency (Hz)
+  double fstop = 0;     ///< Stop frequency (Hz)
+  int npoints = 0;      ///< Number of frequency points
+  int threads = 0;      ///< Sweep threads (0: one per core)
+  quint64 generation = 0; ///< Request number (set by submit())
+  QByteArray key;         ///< Result cache key (set by submit())
+};
+
+/// @class SimulationWorker
+/// @brief Runs the simulations requested by the GUI in a worker thread
+///
+/// The tools request a new simulation on every spinbox change or keystroke.
+/// Only the last request matters, so:
+/// - A new request replaces the pending one (coalescing).
+/// - The running sweep is stopped as soon as a newer request arrives. Each
+///   request gets a generation number and only the results of the latest one
+///   are published.
+///
+/// The results are written to a back buffer and resultsReady() is emitted.
+/// The GUI thread swaps them out with takeResults().
+///
+/// The results are also kept in a SimulationCache. A request whose results
+/// are in memory is answered in submit(), without waking up the worker
+/// thread. The disk tier is looked up by the worker thread before simulating,
+/// so the GUI thread never waits for a file.
+class SimulationWorker : public QThread {
+    Q_OBJECT
+  public:
+    /// @brief Class constructor
+    /// @param parent Parent object
+    explicit SimulationWorker(QObject *parent = nullptr);
+
+    /// @brief Stops the running sweep and waits for the thread to finish
+    ~SimulationWorker();
+
+    /// @brief Queues a simulation. The running sweep, if any, is cancelled.
+    /// If the results are cached in memory, resultsReady() is emitted before
+    /// returning
+    /// @param job Netlist and sweep settings
+    /// @return Generation number assigned to the request
+    quint64 submit(SimulationJob job);
+
+    /// @brief Moves the last results into the caller's buffer
+    /// @param name Dataset name of the results
+    /// @param data Output. Its previous content goes to the back buffer
+    /// @return False if there are no new results or they are already stale
+    bool takeResults(QString &name, QMap<QString, QList<double>> &data);
+
+    /// @brief Discards the cached microstrip models before the next job
+    /// \note Called when the substrate changes
+    void clearModelCache();
+
+    /// @brief Enables or disables the on-disk tier of the result cache
+    void setDiskCache(bool enabled) { cache.setDiskCache(enabled); }
+
+  signals:
+    /// @brief Emitted from the worker thread when new results are available
+    void resultsReady();
+
+  protected:
+    /// @brief Worker loop
+    void run() override;
+
+  private:
+    QMutex mutex;          ///< Protects the fields below
+    QWaitCondition wakeUp; ///< Signals a new job or the shutdown
+    SimulationJob pending; ///< Last job submitted
+    bool hasPending = false; ///< pending has not been started yet
+    bool stopping = false; ///< The thread is being destroyed
+    bool clearModels = false; ///< See clearModelCache()
+
+    // Back buffer of the double-buffered results
+    QMap<QString, QList<double>> backData;
+    QString backName;
+    quint64 backGeneration = 0;
+    bool backReady = false;
+
+    std::atomic<quint64> latest{0}; ///< Generation of the newest request
+    std::atomic<bool> cancel{false}; ///< Stops the sweep in progress
+
+    /// @brief Engine used by the worker thread only. It is kept between jobs so
+    /// that value-only edits are re-simulated incrementally
+    SParameterCalculator engine;
+
+    SimulationCache cache; ///< Results of the previous requests
+};
+
+#endif // SIMULATION_WORKER_H
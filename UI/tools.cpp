@@ -97,6 +97,15 @@ void Qucs_S_SPAR_Viewer::setToolsDock() {
   // Set the layout container as the dock widget's content
   dockTools->setWidget(container);
 
+  // The simulations run in a worker thread, so typing in the netlist or
+  // changing a spinbox doesn't block the GUI
+  simulationWorker = new SimulationWorker(this);
+  connect(simulationWorker, &SimulationWorker::resultsReady, this,
+          &Qucs_S_SPAR_Viewer::publishSimulationResults);
+  simulationWorker->setDiskCache(SimulationSetupWidget->getDiskCache());
+  connect(SimulationSetupWidget, &SimulationSetup::updateDiskCache,
+          simulationWorker, &SimulationWorker::setDiskCache);
+
   // Connect with tools to update the simulated traces
   connect(
       FilterTool, &FilterDesignTool::updateSimulation, this,
@@ -139,33 +148,43 @@ void Qucs_S_SPAR_Viewer::updateSimulation() {
   qDebug() << "Netlist";
   qDebug() << netlist;
 
-  SPAR_engine.setNetlist(netlist);
   // The frequency sweep is taken directly from the SimulationSetup widget
-  double fstart = SimulationSetupWidget->getFstart();
-  double fstop = SimulationSetupWidget->getFstop();
-  int npoints = SimulationSetupWidget->getNpoints();
-
-  // Pass settings to the S-parameter engine
-  SPAR_engine.setFrequencySweep(fstart, fstop, npoints);
-  SPAR_engine.calculateSParameterSweep();
-  QMap<QString, QList<double>> data = SPAR_engine.getData();
+  SimulationJob job;
+  job.name = Circuit.Name;
+  job.netlist = netlist;
+  job.fstart = SimulationSetupWidget->getFstart();
+  job.fstop = SimulationSetupWidget->getFstop();
+  job.npoints = SimulationSetupWidget->getNpoints();
+  job.threads = SimulationSetupWidget->getNumThreads();
+
+  // Pass settings to the S-parameter engine. A simulation still running is
+  // cancelled
+  simulationWorker->submit(job);
 
   ///////////////////////////////////////////////////////////
   // Update the data on the Schematic Object. This is needed
   // to set the frequency sweep when exporting the schematic
   QString fstart_text = SimulationSetupWidget->getFstart_as_Text();
   QString fstop_text = SimulationSetupWidget->getFstop_as_Text();
-  Circuit.setFrequencySweep(fstart_text, fstop_text, npoints);
+  Circuit.setFrequencySweep(fstart_text, fstop_text, job.npoints);
   ///////////////////////////////////////////////////////////
 
-  if (data.isEmpty()) {
+  updateSchematicContent();
+}
+void Qucs_S_SPAR_Viewer::publishSimulationResults() {
+  // Only the results of the last request are taken. Older ones were cancelled
+  QString dataset_name;
+  QMap<QString, QList<double>> data;
+  if (!simulationWorker->takeResults(dataset_name, data)) {
     return;
   }
 
-  QString dataset_name = Circuit.Name;
+  if (data.isEmpty()) {
+    return;
+  }
 
-  // Update data
-  datasets[dataset_name] = data;
+  // Update data (the sweep is moved, not copied)
+  datasets[dataset_name].swap(data);
 
   // After simulation, once the data has been updated in the datasets structure,
   // it is needed to refresh the list of available traces. This is needed
@@ -248,8 +267,6 @@ void Qucs_S_SPAR_Viewer::updateSimulation() {
     }
   }
   updateAllPlots(dataset_name);
-
-  updateSchematicContent();
 }
 void Qucs_S_SPAR_Viewer::updateSubstrate() {
 
@@ -259,6 +276,9 @@ void Qucs_S_SPAR_Viewer::updateSubstrate() {
   // Update the substrate in all tools
   FilterTool->set_MS_Subs(MS_Subs);
 
+  // The microstrip models of the old substrate are no longer needed
+  simulationWorker->clearModelCache();
+
   if (Circuit.Type == QString("Filter")) {
     FilterTool->design();
   } else if (Circuit.Type == QString("Power Combiner")) {